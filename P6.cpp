@@ -1,6 +1,7 @@
 #include <iostream>
 #include <cstdlib>
 #include <cstring>
+#include <string>
 
 #include "err.hpp"
 #include "lilc_compiler.hpp"
@@ -8,19 +9,137 @@
 
 using namespace LILC;
 
-int 
+static void usage(){
+	std::cout << "Usage: lilcc [options] <infile> <outfile>\n"
+		<< "Options:\n"
+		<< "  -fno-mmap             read the input through an"
+		" ifstream instead of mapping it\n"
+		<< "  --scanner=flex|dfa    use the flex scanner (default)"
+		" or the hand-written one\n"
+		<< "  --emit-tokens=text    write the token stream to"
+		" <outfile>, one token per line\n"
+		<< "  --emit-tokens=bin     write the token stream to"
+		" <outfile> in binary; lilcc\n"
+		<< "                        accepts such a file as"
+		" <infile> in place of the source\n"
+		<< "  -fflat-ast            keep the AST in compact"
+		" arrays rather than as a tree\n"
+		<< "  -j N                  type check functions on up"
+		" to N threads\n"
+		<< "  -ffused-sema          resolve names and check types"
+		" in one pass over the\n"
+		<< "                        tree, on one thread (has"
+		" no effect with -fflat-ast)\n"
+		<< "  -O0, -O1, -O2         leave the generated code as"
+		" is (the default), or\n"
+		<< "                        allocate registers by linear"
+		" scan (-O1) or graph\n"
+		<< "                        coloring (-O2) and run the"
+		" peephole optimizer over it\n"
+		<< "  -fregalloc=none|linear-scan|coloring\n"
+		<< "                        keep values on the stack, or"
+		" in registers allocated\n"
+		<< "                        by linear scan or graph"
+		" coloring, whatever the -O level\n"
+		<< "  -fopt-report          print what the optimizer did"
+		" to stderr\n"
+		<< "  -ftime-report         print the time, peak RSS"
+		" growth and allocations of\n"
+		<< "                        each phase to stderr\n"
+		<< "  -ftime-report=json    the same, as JSON\n";
+}
+
+int
 main( const int argc, const char **argv )
 {
-	if (argc != 3){
-		std::cout << "Usage: lilcc <infile> <outfile>" 
-			<< std::endl;
+	LILC::LilC_Compiler compiler;
+	const char * files[2];
+	int numFiles = 0;
+	std::string emitTokens;
+	TimeReport * timeReport = nullptr;
+	bool timeReportJSON = false;
+	unsigned optLevel = 0;
+	RegAlloc regAlloc = RegAlloc::NONE;
+	bool regAllocSet = false;
+	for (int i = 1; i < argc; i++){
+		const char * arg = argv[i];
+		if (std::strcmp(arg, "-fno-mmap") == 0){
+			compiler.setMappedInput(false);
+		} else if (std::strcmp(arg, "-fflat-ast") == 0){
+			compiler.setFlatAST(true);
+		} else if (std::strcmp(arg, "-ffused-sema") == 0){
+			compiler.setFusedAnalysis(true);
+		} else if (std::strcmp(arg, "-O0") == 0){
+			optLevel = 0;
+		} else if (std::strcmp(arg, "-O1") == 0){
+			optLevel = 1;
+		} else if (std::strcmp(arg, "-O2") == 0){
+			optLevel = 2;
+		} else if (std::strcmp(arg, "-fregalloc=none") == 0){
+			regAlloc = RegAlloc::NONE;
+			regAllocSet = true;
+		} else if (std::strcmp(arg, "-fregalloc=linear-scan") == 0){
+			regAlloc = RegAlloc::LINEAR_SCAN;
+			regAllocSet = true;
+		} else if (std::strcmp(arg, "-fregalloc=coloring") == 0){
+			regAlloc = RegAlloc::COLORING;
+			regAllocSet = true;
+		} else if (std::strcmp(arg, "-fopt-report") == 0){
+			compiler.setOptReport(&std::cerr);
+		} else if (std::strcmp(arg, "-j") == 0){
+			int jobs = i + 1 < argc ? std::atoi(argv[++i]) : 0;
+			if (jobs < 1){
+				usage();
+				return 1;
+			}
+			compiler.setJobs(static_cast<unsigned>(jobs));
+		} else if (std::strcmp(arg, "--scanner=flex") == 0){
+			compiler.setScanner(ScannerKind::FLEX);
+		} else if (std::strcmp(arg, "--scanner=dfa") == 0){
+			compiler.setScanner(ScannerKind::DFA);
+		} else if (std::strcmp(arg, "-ftime-report") == 0
+			|| std::strcmp(arg, "-ftime-report=json") == 0)
+		{
+			delete timeReport;
+			timeReport = new TimeReport();
+			timeReportJSON = arg[13] == '=';
+		} else if (std::strncmp(arg, "--emit-tokens=", 14) == 0){
+			emitTokens = arg + 14;
+			if (emitTokens != "text" && emitTokens != "bin"){
+				usage();
+				return 1;
+			}
+		} else if (arg[0] == '-' || numFiles == 2){
+			usage();
+			return 1;
+		} else {
+			files[numFiles++] = arg;
+		}
+	}
+	if (numFiles != 2){
+		usage();
 		return 1;
 	}
 
-	LILC::LilC_Compiler compiler;
+	compiler.setTimeReport(timeReport);
+	compiler.setOptLevel(optLevel);
+	if (!regAllocSet && optLevel >= 1){
+		regAlloc = optLevel >= 2
+			? RegAlloc::COLORING : RegAlloc::LINEAR_SCAN;
+	}
+	compiler.setRegAlloc(regAlloc);
+
+	int status = 1;
 	try {
-		if (compiler.codeGen(argv[1], argv[2])){
-			return 0;
+		if (emitTokens == "text"){
+			compiler.scan(files[0], files[1]);
+			status = 0;
+		} else if (emitTokens == "bin"){
+			if (compiler.emitTokens(files[0], files[1])){
+				status = 0;
+			}
+		} else if (compiler.codeGen(files[0], files[1])){
+			status = 0;
 		}
 	} catch (LILC::ToDoError& err){
 		std::cerr << err.what() << std::endl;
@@ -30,5 +149,15 @@ main( const int argc, const char **argv )
 		std::cerr << "runtime error" << std::endl;
 		std::cerr << err.what() << std::endl;
 	}
-	return 1;
+
+	//Whatever phases ran, even if one of them failed
+	if (timeReport != nullptr){
+		if (timeReportJSON){
+			timeReport->printJSON(std::cerr);
+		} else {
+			timeReport->print(std::cerr);
+		}
+		delete timeReport;
+	}
+	return status;
 }
@@ -5,4 +5,6 @@
 
 namespace LILC {
 
+size_t ASTNode::nodesCreated = 0;
+
 } // End namespace LIL' C
@@ -3,11 +3,14 @@
 
 #include <ostream>
 #include <list>
+#include <utility>
+#include <vector>
 #include "err.hpp"
 #include "tokens.hpp"
 #include "symbol_table.hpp"
-
-enum BinOpKind { REL, LOG, MATH, EQ};
+#include "lilc_arena.hpp"
+#include "lilc_flat_ast.hpp"
+#include "lilc_types.hpp"
 
 namespace LILC{
 	class SymbolTable;
@@ -18,6 +21,25 @@ namespace LILC{
 
 namespace LILC {
 
+/*
+* Every node, and every list of child nodes, is allocated from the
+* compiler's AST arena (see LilC_Compiler::nodeArena) in parse
+* order and released all at once when the next parse starts or
+* the compiler is destroyed (or, when the compiler builds a
+* FlatAST, as soon as each top-level declaration is lowered).
+* Nothing in the tree is ever deleted, so nodes must not own
+* anything that needs a destructor.
+*
+* Child lists are arrays, so the passes walk them linearly rather
+* than chasing list links. The grammar builds them left-recursively
+* with push_back, moving them from one semantic value to the next,
+* and the list nodes take them over by value; the buffers outgrown
+* along the way are left in the arena, which costs at most as much
+* again as the final arrays.
+*/
+template <typename T>
+using ASTList = std::vector<T, ArenaAllocator<T>>;
+
 class DeclListNode;
 class StmtListNode;
 class FormalsListNode;
@@ -28,30 +50,52 @@ class FormalDeclNode;
 class TypeNode;
 class ExpNode;
 class IdNode;
+class CodeGen;
+struct MemLoc;
+
+/*
+* What the fused name and type analysis (semantic_analysis.cpp)
+* carries down the tree: the scopes that names resolve in, the
+* function whose body is being checked, and whether every name
+* so far has resolved. Type errors only count if they all have.
+*/
+struct SemanticState{
+	SymbolTable * symTab;
+	FuncSymbol * fnSym;
+	bool namesOk;
+	// Passes ok, the result of some name analysis, back
+	bool noteNames(bool ok){
+		namesOk = ok && namesOk;
+		return ok;
+	}
+};
 
 class ASTNode{
 public:
 	ASTNode(size_t lineIn, size_t colIn){
 		this->line = lineIn;
 		this->col = colIn;
+		nodesCreated++;
 	}
+	// Total nodes ever constructed, so the benchmarks can report
+	// per-node throughput. Defined in ast.cpp.
+	static size_t nodesCreated;
 	virtual void unparse(std::ostream& out, int indent) = 0;
 	virtual bool nameAnalysis(SymbolTable * symTab) = 0;
 	virtual bool typeAnalysis();
-	virtual bool codeGen();
+	// Emit this node's code (see lilc_codegen.hpp)
+	virtual void codeGen(CodeGen& gen);
+	// Append this node (and everything under it) to flat and
+	// return its index there; list nodes return their list's
+	// index in the extra array instead. See flat_lowering.cpp.
+	virtual FlatAST::Index lower(FlatAST& flat);
 	void doIndent(std::ostream& out, int indent){
 		for (int k = 0 ; k < indent; k++){ out << " "; }
 	}
 	virtual size_t getLine(){ return line; }
 	virtual size_t getCol(){ return col; }
-	virtual std::string getPosition() { 
-		std::string res = "";
-		res += std::to_string(getLine());
-		res += ":";
-		res += std::to_string(getCol());
-		//res += std::string(1, getCol());
-		return res;
-	}
+	// Where the node is, for diagnostics
+	SourcePos pos() const { return SourcePos(line, col); }
 protected:
 	size_t line;
 	size_t col;
@@ -64,10 +108,13 @@ public:
 	}
 	bool nameAnalysis(SymbolTable * symTab) override;
 	bool typeAnalysis() override;
-	virtual bool codeGen();
+	bool typeAnalysis(unsigned jobs);
+	// Both of the above in one walk; returns whether the types
+	// check, leaving whether the names did in state
+	bool semanticAnalysis(SemanticState& state);
+	void codeGen(CodeGen& gen) override;
 	
 	void unparse(std::ostream& out, int indent) override;
-	virtual ~ProgramNode(){ }
 private:
 	DeclListNode * myDeclList;
 };
@@ -83,24 +130,23 @@ public:
 	virtual std::string getTypeString() = 0;
 	virtual bool isVoid(){ return false; }
 	virtual bool isPrimitive(){ return true; }
-protected:
-	size_t line;
-	size_t col;
-	
 };
 
 
 class DeclListNode : public ASTNode{
 public:
-	DeclListNode(std::list<DeclNode *> * decls) : ASTNode(0,0){
-        	myDecls = decls;
-	}
+	DeclListNode(ASTList<DeclNode *> decls)
+	: ASTNode(0,0), myDecls(std::move(decls)) { }
 	FieldMap * fieldNameAnalysis(SymbolTable * symTab);
 	bool nameAnalysis(SymbolTable * symTab);
 	bool typeAnalysis();
+	bool typeAnalysis(unsigned jobs);
+	bool semanticAnalysis(SemanticState& state);
+	void codeGen(CodeGen& gen) override;
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 private:
-	std::list<DeclNode *> * myDecls;
+	ASTList<DeclNode *> myDecls;
 	bool fieldNameAnalysis(SymbolTable * symTab, FieldMap * m);
 };
 
@@ -113,7 +159,26 @@ public:
 		override = 0;
 	virtual bool nameAnalysis(SymbolTable * symTab) 
 		override = 0;
-	virtual std::string expTypeAnalysis() = 0;
+	// Type this expression, keeping the type on the node
+	const Type * expTypeAnalysis(){
+		myType = computeType();
+		return myType;
+	}
+	// Resolve the names in this expression, then do the same
+	const Type * semanticAnalysis(SemanticState& state){
+		myType = computeSemanticType(state);
+		return myType;
+	}
+	// The type that the last of the above found, so that later
+	// passes needn't work it out again. Null if neither has run,
+	// or if they never got to this expression: the arguments
+	// after a bad one in a call, or the left of a dot access
+	// (which is typed by its field).
+	const Type * getType(){ return myType; }
+	// Push this expression's value
+	virtual void codeGen(CodeGen& gen) override = 0;
+	// Where the variable or field this expression names lives
+	virtual MemLoc location();
 	virtual StructSymbol * dotNameAnalysis(
 		SymbolTable * symTab
 	) {
@@ -121,6 +186,12 @@ public:
 			"dotNameAnalysis on a non-struct "
 			"expression type"); 
 	}
+protected:
+	virtual const Type * computeType() = 0;
+	// By default, that of a leaf with no names to resolve
+	virtual const Type * computeSemanticType(SemanticState& state);
+private:
+	const Type * myType = nullptr;
 };
 
 class IdNode : public ExpNode{
@@ -130,14 +201,19 @@ public:
 		if (token->line == 0){
 			throw InternalError("bad token pos");
 		}
-		myStrVal = token->value();
+		myName = token->name();
 	}
 	void unparse(std::ostream& out, int indent) override;
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab) override;
 	StructSymbol * dotNameAnalysis(
 		SymbolTable * symTab) override;
-	std::string expTypeAnalysis() override;
-	virtual std::string getString() { return myStrVal; }
+	const Type * computeType() override;
+	const Type * computeSemanticType(SemanticState& state) override;
+	void codeGen(CodeGen& gen) override;
+	MemLoc location() override;
+	virtual const std::string& getString() { return myName.str(); }
+	Name getName() { return myName; }
 	virtual SymbolTableEntry * getSymbol() { return mySymbol; }
 	void setSymbol(SymbolTableEntry * symbolIn){
 		this->mySymbol = symbolIn;
@@ -145,7 +221,7 @@ public:
 
 private:
 	SymbolTableEntry * mySymbol;
-	std::string myStrVal;
+	Name myName;
 };
 
 class DeclNode : public ASTNode{
@@ -157,9 +233,13 @@ public:
 	virtual void unparse(std::ostream& out, int indent) = 0;
 	virtual bool nameAnalysis(SymbolTable * symTab) = 0;
 	virtual bool typeAnalysis();
+	virtual bool semanticAnalysis(SemanticState& state);
+	// Nothing, unless overridden: a struct takes no space of its
+	// own, and formals are laid out by the caller
+	void codeGen(CodeGen& gen) override;
 	virtual std::string getTypeString() = 0;
-	virtual std::string getName() { 
-		return myDeclaredID->getString(); 
+	virtual Name getName() { 
+		return myDeclaredID->getName(); 
 	}
 	virtual IdNode * getDeclaredID() { return myDeclaredID; }
 	virtual DeclKind getKind() = 0;
@@ -174,47 +254,52 @@ public:
 	virtual void unparse(std::ostream& out, int indent) = 0;
 	virtual bool nameAnalysis(SymbolTable * symTab) = 0;
 	virtual bool stmtTypeAnalysis(FuncSymbol * fnSym) = 0;
+	virtual bool semanticAnalysis(SemanticState& state) = 0;
+	virtual void codeGen(CodeGen& gen) override = 0;
 };
 
 class FormalsListNode : public ASTNode{
 public:
-	FormalsListNode(std::list<FormalDeclNode *> * formalsIn) 
-	: ASTNode(0, 0){
-		myFormals = formalsIn;
-	}
+	FormalsListNode(ASTList<FormalDeclNode *> formalsIn) 
+	: ASTNode(0, 0), myFormals(std::move(formalsIn)) { }
 	void unparse(std::ostream& out, int indent);
 	bool nameAnalysis(SymbolTable * symTab);
 	std::list<VarSymbol *> * getSymbols();
 	virtual std::string getTypeString();
+	FlatAST::Index lower(FlatAST& flat) override;
 
 private:
-	std::list<FormalDeclNode *> * myFormals;
+	ASTList<FormalDeclNode *> myFormals;
 };
 
 class ExpListNode : public ASTNode{
 public:
-	ExpListNode(std::list<ExpNode *> * exps) : ASTNode(0,0){
-		myExps = *exps;
-	}
+	ExpListNode(ASTList<ExpNode *> exps)
+	: ASTNode(0,0), myExps(std::move(exps)) { }
 	void unparse(std::ostream& out, int indent) override;
 	virtual bool nameAnalysis(SymbolTable * symTab) override;
-	std::list<ExpNode *> * getExps() { return &myExps; }
+	ASTList<ExpNode *> * getExps() { return &myExps; }
+	// Push each expression's value, in order
+	void codeGen(CodeGen& gen) override;
+	FlatAST::Index lower(FlatAST& flat) override;
 
 private:
-	std::list<ExpNode *> myExps;
+	ASTList<ExpNode *> myExps;
 };
 
 class StmtListNode : public ASTNode{
 public:
-	StmtListNode(std::list<StmtNode *> * stmtsIn) : ASTNode(0,0){
-		myStmts = stmtsIn;
-	}
+	StmtListNode(ASTList<StmtNode *> stmtsIn)
+	: ASTNode(0,0), myStmts(std::move(stmtsIn)) { }
 	void unparse(std::ostream& out, int indent) override;
 	bool nameAnalysis(SymbolTable * symTab) override;
 	bool stmtTypeAnalysis(FuncSymbol * fnSym);
+	bool semanticAnalysis(SemanticState& state);
+	void codeGen(CodeGen& gen) override;
+	FlatAST::Index lower(FlatAST& flat) override;
 
 private:
-	std::list<StmtNode *> * myStmts;
+	ASTList<StmtNode *> myStmts;
 };
 
 class FnBodyNode : public ASTNode{
@@ -226,6 +311,10 @@ public:
 	void unparse(std::ostream& out, int indent) override;
 	bool nameAnalysis(SymbolTable * symTab) override;
 	virtual bool fnTypeAnalysis(FuncSymbol * fnSym);
+	bool semanticAnalysis(SemanticState& state);
+	void codeGen(CodeGen& gen) override;
+	// A block record; see FlatAST
+	FlatAST::Index lower(FlatAST& flat) override;
 
 private:
 	DeclListNode * myDeclList;
@@ -248,8 +337,11 @@ public:
 		myBody = fnBody;
 	}
 	void unparse(std::ostream& out, int indent) override;
+	FlatAST::Index lower(FlatAST& flat) override;
 	virtual bool nameAnalysis(SymbolTable * symTab) override;
 	bool typeAnalysis() override;
+	bool semanticAnalysis(SemanticState& state) override;
+	void codeGen(CodeGen& gen) override;
 	virtual std::string getTypeString() override;
 	VarSymbol * makeRetSymbol(SymbolTable * symTab);
 	virtual DeclKind getKind() override { return DeclKind::FUNC; } 
@@ -260,6 +352,8 @@ private:
 	FormalsListNode * myFormals;
 	FnBodyNode * myBody;
 	std::list<std::string> * argTypeStrings();
+	FuncSymbol * declare(SymbolTable * symTab,
+		ScopeTable * outerScope);
 };
 
 class FormalDeclNode : public DeclNode{
@@ -269,6 +363,7 @@ public:
 		myType = type;
 	}
 	void unparse(std::ostream& out, int indent) override;
+	FlatAST::Index lower(FlatAST& flat) override;
 	virtual bool nameAnalysis(SymbolTable * symTab) override;
 	VarSymbol * getSymbol();
 	virtual std::string getTypeString() override;
@@ -289,6 +384,7 @@ public:
 		myDeclList = decls;
 	}
 	void unparse(std::ostream& out, int indent) override;
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab) override;
 	virtual std::string getTypeString() override;
 	virtual DeclKind getKind() override { 
@@ -305,6 +401,7 @@ class IntNode : public TypeNode{
 public:
 	IntNode(size_t lIn, size_t cIn) : TypeNode(lIn, cIn) { }
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab) { return true; }
 	std::string getTypeString() { return "int"; }
 };
@@ -313,6 +410,7 @@ class BoolNode : public TypeNode{
 public:
 	BoolNode(size_t lIn, size_t cIn) : TypeNode(lIn, cIn) { }
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab) { return true; }
 	std::string getTypeString() { return "bool"; }
 };
@@ -321,6 +419,7 @@ class VoidNode : public TypeNode{
 public:
 	VoidNode(size_t lIn, size_t cIn) : TypeNode(lIn, cIn){ } 
 	void unparse(std::ostream& out, int indent) override;
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab) 
 		override { return true; }
 	std::string getTypeString() override { return "void"; }
@@ -338,6 +437,7 @@ public:
 		myId = id;
 	}
 	void unparse(std::ostream& out, int indent) override;
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab) override;
 	std::string getTypeString() override;
 	virtual bool isPrimitive() override { return false; }
@@ -353,8 +453,10 @@ public:
 		myInt = token->value();
 	}
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab) { return true; }
-	std::string expTypeAnalysis() override;
+	const Type * computeType() override;
+	void codeGen(CodeGen& gen) override;
 	std::string getString() { return std::to_string(myInt); }
 private:
 	int myInt;
@@ -362,16 +464,22 @@ private:
 
 class StrLitNode : public ExpNode{
 public:
-	StrLitNode(StringLitToken * token)
+	// The token's text only lasts as long as the token arena,
+	// so the node keeps its own copy in the AST arena
+	StrLitNode(StringLitToken * token, Arena& arena)
 	: ExpNode(token->line, token->column){
-		myString = token->value();
+		TokenText text = token->text();
+		myString = TokenText{ arena.copy(text.data, text.size),
+			text.size };
 	}
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab) { return true; }
-	std::string expTypeAnalysis() override;
-	std::string getString() const { return myString; }
+	const Type * computeType() override;
+	void codeGen(CodeGen& gen) override;
+	std::string getString() const { return myString.str(); }
 private:
-	 std::string myString;
+	TokenText myString;
 };
 
 
@@ -379,8 +487,10 @@ class TrueNode : public ExpNode{
 public:
 	TrueNode(size_t lIn, size_t cIn): ExpNode(lIn, cIn){ }
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab) { return true; }
-	std::string expTypeAnalysis() override;
+	const Type * computeType() override;
+	void codeGen(CodeGen& gen) override;
 	std::string getString() const { return "true"; }
 };
 
@@ -388,8 +498,10 @@ class FalseNode : public ExpNode{
 public:
 	FalseNode(size_t lIn, size_t cIn): ExpNode(lIn, cIn){ }
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab) { return true; }
-	std::string expTypeAnalysis() override;
+	const Type * computeType() override;
+	void codeGen(CodeGen& gen) override;
 	std::string getString() const { return "false"; }
 };
 
@@ -401,10 +513,14 @@ public:
 		myId = id;
 	}
 	void unparse(std::ostream& out, int indent) override;
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab) override;
-	std::string expTypeAnalysis() override;
+	const Type * computeType() override;
+	const Type * computeSemanticType(SemanticState& state) override;
 	StructSymbol * dotNameAnalysis(SymbolTable * symTab)
 		override;
+	void codeGen(CodeGen& gen) override;
+	MemLoc location() override;
 	std::string getString();
 
 private:
@@ -422,8 +538,11 @@ public:
 		myExpRHS = expRHS;
 	}
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab);
-	std::string expTypeAnalysis() override;
+	const Type * computeType() override;
+	const Type * computeSemanticType(SemanticState& state) override;
+	void codeGen(CodeGen& gen) override;
 
 private:
 	ExpNode * myExpLHS;
@@ -438,12 +557,17 @@ public:
 		myExpList = expList;
 	}
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab);
-	std::string expTypeAnalysis() override;
+	const Type * computeType() override;
+	const Type * computeSemanticType(SemanticState& state) override;
+	void codeGen(CodeGen& gen) override;
 
 private:
 	IdNode * myId;
 	ExpListNode * myExpList;
+	const Type * callTypeAnalysis(SemanticState * state,
+		size_t& argsTyped);
 	SymbolTableEntry * mySymbol;
 };
 
@@ -457,17 +581,22 @@ public:
 	virtual bool nameAnalysis(SymbolTable * symTab){
 		return myExp->nameAnalysis(symTab);
 	}
-	virtual std::string expTypeAnalysis() = 0;
+	const Type * computeType() override;
+	const Type * computeSemanticType(SemanticState& state) override;
+	// The type of this operation on an operand of type operand
+	virtual const Type * opType(const Type * operand) = 0;
 protected:
 	ExpNode * myExp;
 };
 
 class UnaryMinusNode : public UnaryExpNode{
 public:
-	UnaryMinusNode(ExpNode * exp)
-	: UnaryExpNode(line, col, exp){ }
+	UnaryMinusNode(size_t lIn, size_t cIn, ExpNode * exp)
+	: UnaryExpNode(lIn, cIn, exp){ }
 	void unparse(std::ostream& out, int indent);
-	std::string expTypeAnalysis() override;
+	FlatAST::Index lower(FlatAST& flat) override;
+	const Type * opType(const Type * operand) override;
+	void codeGen(CodeGen& gen) override;
 };
 
 class NotNode : public UnaryExpNode{
@@ -475,7 +604,9 @@ public:
 	NotNode(size_t lIn, size_t cIn, ExpNode * exp)
 	: UnaryExpNode(lIn, cIn, exp){ }
 	void unparse(std::ostream& out, int indent);
-	std::string expTypeAnalysis() override;
+	FlatAST::Index lower(FlatAST& flat) override;
+	const Type * opType(const Type * operand) override;
+	void codeGen(CodeGen& gen) override;
 };
 
 class BinaryExpNode : public ExpNode{
@@ -495,12 +626,16 @@ public:
 		bool result1 = myExp1->nameAnalysis(symTab);
 		return myExp2->nameAnalysis(symTab) && result1;
 	}
-	std::string expTypeAnalysis() override;
+	const Type * computeType() override;
+	const Type * computeSemanticType(SemanticState& state) override;
+	// The type of this operation on operands of these types
+	virtual const Type * opType(const Type * type1,
+		const Type * type2);
+	void codeGen(CodeGen& gen) override;
+	FlatAST::Index lower(FlatAST& flat) override;
 	virtual BinOpKind binOpKind() = 0;
-	std::string expectedResType();
-	std::string reportOpErr(std::string);
-	bool acceptsOperandType(std::string opIn);
 	virtual std::string myOp() = 0;
+	virtual FlatAST::NodeKind flatKind() = 0;
 protected:
 	ExpNode * myExp1;
 	ExpNode * myExp2;
@@ -512,6 +647,8 @@ public:
 		ExpNode * exp1, ExpNode * exp2) 
 	: BinaryExpNode(lIn, cIn, exp1, exp2) { }
 	virtual std::string myOp(){ return "+"; } 
+	FlatAST::NodeKind flatKind() override
+		{ return FlatAST::NodeKind::PLUS; }
 	BinOpKind binOpKind() override
 		{ return BinOpKind::MATH; }
 };
@@ -522,6 +659,8 @@ public:
 		ExpNode * exp1, ExpNode * exp2)
 	: BinaryExpNode(lIn, cIn, exp1, exp2){ }
 	virtual std::string myOp(){ return "-"; } 
+	FlatAST::NodeKind flatKind() override
+		{ return FlatAST::NodeKind::MINUS; }
 	BinOpKind binOpKind() override
 		{ return BinOpKind::MATH; }
 };
@@ -530,8 +669,10 @@ class TimesNode : public BinaryExpNode{
 public:
 	TimesNode(size_t lIn, size_t cIn,
 		ExpNode * exp1, ExpNode * exp2)
-	: BinaryExpNode(line, col, exp1, exp2){ }
+	: BinaryExpNode(lIn, cIn, exp1, exp2){ }
 	virtual std::string myOp(){ return "*"; } 
+	FlatAST::NodeKind flatKind() override
+		{ return FlatAST::NodeKind::TIMES; }
 	BinOpKind binOpKind() override
 		{ return BinOpKind::MATH; }
 };
@@ -540,8 +681,10 @@ class DivideNode : public BinaryExpNode{
 public:
 	DivideNode(size_t lIn, size_t cIn,
 		ExpNode * exp1, ExpNode * exp2)
-	: BinaryExpNode(line, col, exp1, exp2){ }
+	: BinaryExpNode(lIn, cIn, exp1, exp2){ }
 	virtual std::string myOp(){ return "/"; } 
+	FlatAST::NodeKind flatKind() override
+		{ return FlatAST::NodeKind::DIVIDE; }
 	BinOpKind binOpKind() override 
 		{ return BinOpKind::MATH; }
 };
@@ -552,8 +695,12 @@ public:
 		ExpNode * exp1, ExpNode * exp2)
 	: BinaryExpNode(lIn, cIn, exp1, exp2){ }
 	virtual std::string myOp(){ return "&&"; } 
+	FlatAST::NodeKind flatKind() override
+		{ return FlatAST::NodeKind::AND; }
 	BinOpKind binOpKind() override 
 		{ return BinOpKind::LOG; }
+	// Short-circuits
+	void codeGen(CodeGen& gen) override;
 };
 
 class OrNode : public BinaryExpNode{
@@ -562,8 +709,12 @@ public:
 		ExpNode * exp1, ExpNode * exp2)
 	: BinaryExpNode(lIn, cIn, exp1, exp2){ }
 	virtual std::string myOp() override { return "||"; } 
+	FlatAST::NodeKind flatKind() override
+		{ return FlatAST::NodeKind::OR; }
 	BinOpKind binOpKind() override 
 		{ return BinOpKind::LOG; }
+	// Short-circuits
+	void codeGen(CodeGen& gen) override;
 };
 
 class EqualsNode : public BinaryExpNode{
@@ -572,8 +723,11 @@ public:
 		ExpNode * exp1, ExpNode * exp2)
 	: BinaryExpNode(lineIn, colIn, exp1, exp2){ }
 	virtual std::string myOp(){ return "=="; } 
+	FlatAST::NodeKind flatKind() override
+		{ return FlatAST::NodeKind::EQUALS; }
 	BinOpKind binOpKind() override ;
-	std::string expTypeAnalysis();
+	const Type * opType(const Type * type1,
+		const Type * type2) override;
 };
 
 class NotEqualsNode : public BinaryExpNode{
@@ -582,8 +736,11 @@ public:
 		ExpNode * exp1, ExpNode * exp2)
 	: BinaryExpNode(lineIn, colIn, exp1, exp2){ }
 	virtual std::string myOp() override { return "!="; } 
+	FlatAST::NodeKind flatKind() override
+		{ return FlatAST::NodeKind::NOT_EQUALS; }
 	BinOpKind binOpKind() override ;
-	std::string expTypeAnalysis();
+	const Type * opType(const Type * type1,
+		const Type * type2) override;
 };
 
 class LessNode : public BinaryExpNode{
@@ -592,6 +749,8 @@ public:
 		ExpNode * exp1, ExpNode * exp2)
 	: BinaryExpNode(lineIn, colIn, exp1, exp2){ }
 	virtual std::string myOp() override { return "<"; } 
+	FlatAST::NodeKind flatKind() override
+		{ return FlatAST::NodeKind::LESS; }
 	virtual BinOpKind binOpKind(){ return BinOpKind::REL; } 
 };
 
@@ -601,6 +760,8 @@ public:
 		ExpNode * exp1, ExpNode * exp2)
 	: BinaryExpNode(lineIn, colIn, exp1, exp2){ }
 	virtual std::string myOp() override { return ">"; } 
+	FlatAST::NodeKind flatKind() override
+		{ return FlatAST::NodeKind::GREATER; }
 	virtual BinOpKind binOpKind(){ return BinOpKind::REL; } 
 };
 
@@ -610,6 +771,8 @@ public:
 		ExpNode * exp1, ExpNode * exp2)
 	: BinaryExpNode(lineIn, colIn, exp1, exp2){ }
 	virtual std::string myOp() override { return "<="; } 
+	FlatAST::NodeKind flatKind() override
+		{ return FlatAST::NodeKind::LESS_EQ; }
 	virtual BinOpKind binOpKind(){ return BinOpKind::REL; } 
 };
 
@@ -617,8 +780,10 @@ class GreaterEqNode : public BinaryExpNode{
 public:
 	GreaterEqNode(size_t lineIn, size_t colIn, 
 		ExpNode * exp1, ExpNode * exp2)
-	: BinaryExpNode(line, col, exp1, exp2){ }
+	: BinaryExpNode(lineIn, colIn, exp1, exp2){ }
 	virtual std::string myOp() override { return ">="; } 
+	FlatAST::NodeKind flatKind() override
+		{ return FlatAST::NodeKind::GREATER_EQ; }
 	virtual BinOpKind binOpKind(){ return BinOpKind::REL; } 
 };
 
@@ -629,8 +794,11 @@ public:
 		myAssign = assignment;
 	}
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab) override;
 	bool stmtTypeAnalysis(FuncSymbol * fnSym) override;
+	bool semanticAnalysis(SemanticState& state) override;
+	void codeGen(CodeGen& gen) override;
 
 private:
 	AssignNode * myAssign;
@@ -646,8 +814,11 @@ public:
 		myExp = exp;
 	}
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab);
 	bool stmtTypeAnalysis(FuncSymbol * fnSym) override;
+	bool semanticAnalysis(SemanticState& state) override;
+	void codeGen(CodeGen& gen) override;
 
 private:
 	ExpNode * myExp;
@@ -660,8 +831,11 @@ public:
 		myExp = exp;
 	}
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab);
 	bool stmtTypeAnalysis(FuncSymbol * fnSym) override;
+	bool semanticAnalysis(SemanticState& state) override;
+	void codeGen(CodeGen& gen) override;
 
 private:
 	ExpNode * myExp;
@@ -674,8 +848,11 @@ public:
 		myExp = exp;
 	}
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab);
 	bool stmtTypeAnalysis(FuncSymbol * fnSym) override;
+	bool semanticAnalysis(SemanticState& state) override;
+	void codeGen(CodeGen& gen) override;
 private:
 	ExpNode * myExp;
 };
@@ -687,8 +864,11 @@ public:
 		myExp = exp;
 	}
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab);
 	bool stmtTypeAnalysis(FuncSymbol * fnSym) override;
+	bool semanticAnalysis(SemanticState& state) override;
+	void codeGen(CodeGen& gen) override;
 private:
 	ExpNode * myExp;
 };
@@ -703,8 +883,11 @@ public:
 		myStmts = stmts;
 	}
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab);
 	bool stmtTypeAnalysis(FuncSymbol * fnSym) override;
+	bool semanticAnalysis(SemanticState& state) override;
+	void codeGen(CodeGen& gen) override;
 private:
 	ExpNode * myExp;
 	DeclListNode * myDecls;
@@ -724,8 +907,11 @@ public:
 		myStmtsF = stmtsF;
 	}
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab);
 	bool stmtTypeAnalysis(FuncSymbol * fnSym) override;
+	bool semanticAnalysis(SemanticState& state) override;
+	void codeGen(CodeGen& gen) override;
 private:
 	ExpNode * myExp;
 	DeclListNode * myDeclsT;
@@ -744,8 +930,11 @@ public:
 		myStmts = stmts;
 	}
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab);
 	bool stmtTypeAnalysis(FuncSymbol * fnSym) override;
+	bool semanticAnalysis(SemanticState& state) override;
+	void codeGen(CodeGen& gen) override;
 private:
 	ExpNode * myExp;
 	DeclListNode * myDecls;
@@ -759,8 +948,11 @@ public:
 		myCallExp = callExp;
 	}
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab);
 	bool stmtTypeAnalysis(FuncSymbol * fnSym) override;
+	bool semanticAnalysis(SemanticState& state) override;
+	void codeGen(CodeGen& gen) override;
 
 private:
 	CallExpNode * myCallExp;
@@ -773,8 +965,11 @@ public:
 		myExp = exp;
 	}
 	void unparse(std::ostream& out, int indent);
+	FlatAST::Index lower(FlatAST& flat) override;
 	bool nameAnalysis(SymbolTable * symTab);
 	bool stmtTypeAnalysis(FuncSymbol * fnSym) override;
+	bool semanticAnalysis(SemanticState& state) override;
+	void codeGen(CodeGen& gen) override;
 
 private:
 	ExpNode * myExp;
@@ -788,7 +983,9 @@ public:
 		mySize = size;
 	}
 	bool nameAnalysis(SymbolTable * symTab) override;
+	void codeGen(CodeGen& gen) override;
 	void unparse(std::ostream& out, int indent) override;
+	FlatAST::Index lower(FlatAST& flat) override;
 	virtual std::string getTypeString() override;
 	virtual DeclKind getKind() override { return DeclKind::VAR; } 
 	static const int NOT_STRUCT = -1; //Use this value for mySize
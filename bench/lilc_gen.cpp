@@ -0,0 +1,491 @@
+// Generates a synthetic LilC program for benchmarking.
+//
+//   bench/lilc_gen [options] > corpus.lilc
+//
+//   -f N   functions (plus a main)                   default 200
+//   -s N   struct types, each with a global instance default 20
+//   -d N   if/while nesting depth                    default 3
+//   -e N   operators per expression                  default 6
+//   -i N   minimum identifier length                 default 8
+//   -t N   statements per block                      default 8
+//   -r N   random seed                               default 1
+//
+// The same options always give byte-identical output (the PRNG is
+// our own, not <random>'s distributions, whose output is up to the
+// standard library), so corpora can be regenerated rather than
+// checked in. Programs are meant to get through type analysis
+// cleanly: every identifier is declared before use, functions only
+// call ones defined earlier, and every expression is well typed.
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Params{
+	int functions = 200;
+	int structs = 20;
+	int depth = 3;
+	int exprSize = 6;
+	int idLength = 8;
+	int stmts = 8;
+	uint64_t seed = 1;
+};
+
+// splitmix64
+class Rng{
+public:
+	explicit Rng(uint64_t seed) : state(seed) { }
+	uint64_t next(){
+		uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		return z ^ (z >> 31);
+	}
+	size_t below(size_t n){ return static_cast<size_t>(next() % n); }
+	bool oneIn(size_t n){ return below(n) == 0; }
+private:
+	uint64_t state;
+};
+
+struct StructInfo{
+	std::string name;
+	std::vector<std::string> intFields;
+	std::vector<std::string> boolFields;
+	int inner = -1; // index of a nested struct type, if any
+	std::string innerField;
+};
+
+enum class Ty { INT, BOOL, VOID };
+
+struct FnInfo{
+	std::string name;
+	Ty ret;
+	std::vector<Ty> params;
+};
+
+class Generator{
+public:
+	explicit Generator(const Params& pIn) : p(pIn), rng(pIn.seed) { }
+
+	std::string run(){
+		for (int k = 0; k < p.structs; k++){ genStruct(k); }
+		genGlobals();
+		for (int k = 0; k < p.functions; k++){ genFunction(k); }
+		genMain();
+		return out;
+	}
+
+private:
+	// prefix + number, padded out to the requested length. The
+	// digits keep names unique and the prefixes keep them clear of
+	// keywords and of each other.
+	std::string ident(const char * prefix, size_t num){
+		std::string res = prefix + std::to_string(num);
+		if (res.size() < static_cast<size_t>(p.idLength)){
+			res += '_';
+			static const char FILL[] = "abcdefghijklmnopqrstuvwxyz";
+			for (size_t k = 0; res.size() < static_cast<size_t>(
+				p.idLength); k++)
+			{
+				res += FILL[(num + k) % 26];
+			}
+		}
+		return res;
+	}
+
+	void indent(){ out.append(static_cast<size_t>(level) * 4, ' '); }
+
+	static const char * typeName(Ty ty){
+		switch (ty){
+		case Ty::INT: return "int";
+		case Ty::BOOL: return "bool";
+		case Ty::VOID:
+		default: return "void";
+		}
+	}
+
+	void genStruct(int k){
+		StructInfo info;
+		info.name = ident("S", static_cast<size_t>(k));
+		out += "struct " + info.name + " {\n";
+		size_t field = 0;
+		size_t ints = 2 + rng.below(3);
+		for (size_t i = 0; i < ints; i++){
+			info.intFields.push_back(ident("f", field++));
+			out += "    int " + info.intFields.back() + ";\n";
+		}
+		size_t bools = 1 + rng.below(2);
+		for (size_t i = 0; i < bools; i++){
+			info.boolFields.push_back(ident("f", field++));
+			out += "    bool " + info.boolFields.back() + ";\n";
+		}
+		if (k > 0 && rng.oneIn(2)){
+			info.inner = static_cast<int>(rng.below(
+				static_cast<size_t>(k)));
+			info.innerField = ident("f", field++);
+			out += "    struct " + structs[static_cast<size_t>(
+				info.inner)].name + " " + info.innerField + ";\n";
+		}
+		out += "};\n\n";
+		structs.push_back(info);
+	}
+
+	void genGlobals(){
+		for (size_t k = 0; k < structs.size(); k++){
+			std::string name = ident("s", k);
+			out += "struct " + structs[k].name + " " + name + ";\n";
+			structGlobals.push_back(name);
+		}
+		size_t ints = 4 + static_cast<size_t>(p.functions) / 10;
+		for (size_t k = 0; k < ints; k++){
+			intGlobals.push_back(ident("g", globalCount++));
+			out += "int " + intGlobals.back() + ";\n";
+		}
+		size_t bools = 2 + static_cast<size_t>(p.functions) / 20;
+		for (size_t k = 0; k < bools; k++){
+			boolGlobals.push_back(ident("g", globalCount++));
+			out += "bool " + boolGlobals.back() + ";\n";
+		}
+		out += "\n";
+	}
+
+	void genFunction(int k){
+		FnInfo fn;
+		fn.name = ident("fn", static_cast<size_t>(k));
+		size_t r = rng.below(4);
+		fn.ret = r < 2 ? Ty::INT : (r == 2 ? Ty::BOOL : Ty::VOID);
+		size_t nParams = rng.below(4);
+		for (size_t i = 0; i < nParams; i++){
+			fn.params.push_back(rng.oneIn(3) ? Ty::BOOL : Ty::INT);
+		}
+
+		intLocals.clear();
+		boolLocals.clear();
+		localCount = 0;
+		out += std::string(typeName(fn.ret)) + " " + fn.name + "(";
+		for (size_t i = 0; i < fn.params.size(); i++){
+			std::string name = ident("p", i);
+			if (i > 0){ out += ", "; }
+			out += std::string(typeName(fn.params[i])) + " " + name;
+			local(fn.params[i]).push_back(name);
+		}
+		out += "){\n";
+		genBody(fn.ret, p.depth);
+		out += "}\n\n";
+		fns.push_back(fn);
+	}
+
+	void genMain(){
+		intLocals.clear();
+		boolLocals.clear();
+		localCount = 0;
+		out += "void main(){\n";
+		genBody(Ty::VOID, p.depth);
+		out += "}\n";
+	}
+
+	std::vector<std::string>& local(Ty ty){
+		return ty == Ty::BOOL ? boolLocals : intLocals;
+	}
+
+	// A function body: locals, then statements, then a return
+	void genBody(Ty ret, int depth){
+		level++;
+		size_t intCount = 1 + rng.below(3);
+		size_t boolCount = 1 + rng.below(2);
+		for (size_t i = 0; i < intCount; i++){ declLocal(Ty::INT); }
+		for (size_t i = 0; i < boolCount; i++){ declLocal(Ty::BOOL); }
+		genStmts(depth);
+		indent();
+		if (ret == Ty::VOID){
+			out += "return;\n";
+		} else {
+			out += "return ";
+			genExp(ret, p.exprSize);
+			out += ";\n";
+		}
+		level--;
+	}
+
+	void declLocal(Ty ty){
+		std::string name = ident("v", localCount++);
+		indent();
+		out += std::string(typeName(ty)) + " " + name + ";\n";
+		local(ty).push_back(name);
+	}
+
+	// A nested block, maybe with a local of its own
+	void genBlock(int depth){
+		level++;
+		size_t ints = intLocals.size();
+		size_t bools = boolLocals.size();
+		if (rng.oneIn(2)){
+			declLocal(rng.oneIn(2) ? Ty::INT : Ty::BOOL);
+		}
+		genStmts(depth);
+		intLocals.resize(ints);
+		boolLocals.resize(bools);
+		level--;
+	}
+
+	// p.stmts statements, one of which opens a nested block while
+	// there is depth left. Only one, so the size of a function
+	// grows linearly with the depth rather than exponentially.
+	void genStmts(int depth){
+		size_t compound = depth > 0 ? rng.below(
+			static_cast<size_t>(p.stmts)) : SIZE_MAX;
+		for (size_t i = 0; i < static_cast<size_t>(p.stmts); i++){
+			if (i == compound){
+				genCompound(depth - 1);
+			} else {
+				genSimple();
+			}
+		}
+	}
+
+	void genCompound(int depth){
+		indent();
+		size_t kind = rng.below(3);
+		out += kind == 2 ? "while (" : "if (";
+		genExp(Ty::BOOL, p.exprSize);
+		out += "){\n";
+		genBlock(depth);
+		indent();
+		out += "}";
+		if (kind == 1){
+			out += " else {\n";
+			genBlock(0);
+			indent();
+			out += "}";
+		}
+		out += "\n";
+	}
+
+	void genSimple(){
+		indent();
+		switch (rng.below(8)){
+		case 0:
+			out += "output << ";
+			genExp(rng.oneIn(4) ? Ty::BOOL : Ty::INT, p.exprSize);
+			out += ";\n";
+			return;
+		case 1:
+			out += "input >> ";
+			genLoc(Ty::INT);
+			out += ";\n";
+			return;
+		case 2:
+			genLoc(Ty::INT);
+			out += rng.oneIn(2) ? "++;\n" : "--;\n";
+			return;
+		case 3:
+			if (!fns.empty()){
+				genCall(fns[rng.below(fns.size())]);
+				out += ";\n";
+				return;
+			}
+			/* fall through */
+		case 4:
+			genLoc(Ty::BOOL);
+			out += " = ";
+			genExp(Ty::BOOL, p.exprSize);
+			out += ";\n";
+			return;
+		default:
+			genLoc(Ty::INT);
+			out += " = ";
+			genExp(Ty::INT, p.exprSize);
+			out += ";\n";
+			return;
+		}
+	}
+
+	// An assignable int or bool: a local, a global or a field
+	void genLoc(Ty ty){
+		std::vector<std::string>& locals = local(ty);
+		size_t pick = rng.below(4);
+		if (pick < 2 && !locals.empty()){
+			out += locals[rng.below(locals.size())];
+		} else if (pick == 2 && !structs.empty()){
+			genField(ty);
+		} else {
+			std::vector<std::string>& globals =
+				ty == Ty::BOOL ? boolGlobals : intGlobals;
+			out += globals[rng.below(globals.size())];
+		}
+	}
+
+	// s3.f0, or s7.f4.f1 through a nested struct
+	void genField(Ty ty){
+		size_t k = rng.below(structs.size());
+		out += structGlobals[k];
+		const StructInfo * info = &structs[k];
+		while (info->inner >= 0 && rng.oneIn(2)){
+			out += "." + info->innerField;
+			info = &structs[static_cast<size_t>(info->inner)];
+		}
+		const std::vector<std::string>& fields =
+			ty == Ty::BOOL ? info->boolFields : info->intFields;
+		out += "." + fields[rng.below(fields.size())];
+	}
+
+	void genCall(const FnInfo& fn){
+		out += fn.name + "(";
+		for (size_t i = 0; i < fn.params.size(); i++){
+			if (i > 0){ out += ", "; }
+			genExp(fn.params[i], 0);
+		}
+		out += ")";
+	}
+
+	void genLeaf(Ty ty){
+		size_t pick = rng.below(8);
+		if (pick < 3){
+			genLoc(ty);
+		} else if (pick < 5){
+			if (ty == Ty::INT){
+				out += std::to_string(rng.below(100000));
+			} else {
+				out += rng.oneIn(2) ? "true" : "false";
+			}
+		} else if (pick == 5 && !fns.empty()){
+			// Some earlier function returning ty, if any
+			size_t start = rng.below(fns.size());
+			for (size_t i = 0; i < fns.size(); i++){
+				const FnInfo& fn = fns[(start + i) % fns.size()];
+				if (fn.ret == ty){
+					genCall(fn);
+					return;
+				}
+			}
+			genLoc(ty);
+		} else {
+			genLoc(ty);
+		}
+	}
+
+	// An expression of type ty with size binary/unary operators.
+	// NOT binds tighter than anything and the comparisons don't
+	// associate, so operands of those get parentheses.
+	void genExp(Ty ty, int size){
+		if (size <= 0){
+			genLeaf(ty);
+			return;
+		}
+		int left = static_cast<int>(rng.below(
+			static_cast<size_t>(size)));
+		int right = size - 1 - left;
+		if (ty == Ty::INT){
+			static const char * const OPS[] =
+				{ " + ", " - ", " * ", " / " };
+			if (rng.oneIn(8)){
+				out += "-(";
+				genExp(Ty::INT, size - 1);
+				out += ")";
+				return;
+			}
+			bool paren = rng.oneIn(3);
+			if (paren){ out += "("; }
+			genExp(Ty::INT, left);
+			out += OPS[rng.below(4)];
+			genExp(Ty::INT, right);
+			if (paren){ out += ")"; }
+			return;
+		}
+
+		switch (rng.below(4)){
+		case 0:
+			{
+			static const char * const OPS[] =
+				{ " < ", " > ", " <= ", " >= ", " == ", " != " };
+			genExp(Ty::INT, left);
+			out += OPS[rng.below(6)];
+			genExp(Ty::INT, right);
+			return;
+			}
+		case 1:
+			out += "!(";
+			genExp(Ty::BOOL, size - 1);
+			out += ")";
+			return;
+		case 2:
+			out += "(";
+			genExp(Ty::BOOL, left);
+			out += rng.oneIn(2) ? ") == (" : ") != (";
+			genExp(Ty::BOOL, right);
+			out += ")";
+			return;
+		default:
+			{
+			bool paren = rng.oneIn(3);
+			if (paren){ out += "("; }
+			genExp(Ty::BOOL, left);
+			out += rng.oneIn(2) ? " && " : " || ";
+			genExp(Ty::BOOL, right);
+			if (paren){ out += ")"; }
+			return;
+			}
+		}
+	}
+
+	Params p;
+	Rng rng;
+	std::string out;
+	int level = 0;
+	std::vector<StructInfo> structs;
+	std::vector<std::string> structGlobals;
+	std::vector<std::string> intGlobals;
+	std::vector<std::string> boolGlobals;
+	size_t globalCount = 0;
+	std::vector<FnInfo> fns;
+	std::vector<std::string> intLocals;
+	std::vector<std::string> boolLocals;
+	size_t localCount = 0;
+};
+
+void usage(){
+	std::cerr << "Usage: lilc_gen [-f functions] [-s structs]"
+		" [-d depth] [-e exprsize] [-i idlength]\n"
+		"                [-t stmts] [-r seed]\n";
+}
+
+} // end anonymous namespace
+
+int main(int argc, char ** argv){
+	Params p;
+	for (int i = 1; i < argc; i++){
+		const char * arg = argv[i];
+		if (arg[0] != '-' || arg[1] == '\0' || arg[2] != '\0'
+			|| i + 1 == argc)
+		{
+			usage();
+			return 1;
+		}
+		long val = std::strtol(argv[++i], nullptr, 10);
+		if (val < 0){
+			usage();
+			return 1;
+		}
+		switch (arg[1]){
+		case 'f': p.functions = static_cast<int>(val); break;
+		case 's': p.structs = static_cast<int>(val); break;
+		case 'd': p.depth = static_cast<int>(val); break;
+		case 'e': p.exprSize = static_cast<int>(val); break;
+		case 'i': p.idLength = static_cast<int>(val); break;
+		case 't': p.stmts = static_cast<int>(val); break;
+		case 'r': p.seed = static_cast<uint64_t>(val); break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if (p.stmts < 1){ p.stmts = 1; }
+
+	std::string text = Generator(p).run();
+	std::cout.write(text.data(), static_cast<std::streamsize>(text.size()));
+	return 0;
+}
@@ -0,0 +1,258 @@
+// Times each phase of the compiler on one input.
+//
+//   make bench OPT=-O2
+//   bench/lilc_gen > corpus.lilc
+//   bench/phase_bench [--scanner=flex|dfa] [--flat-ast] [--jobs=N]
+//       [--fused-sema] [--regalloc=none|linear-scan|coloring]
+//       <file.lilc> [repetitions]
+//
+// Each run compiles the input to /dev/null on a fresh LilC_Compiler
+// with a TimeReport attached, as lilcc -ftime-report does, so every
+// phase is timed by its own PhaseTimer within the one run. Each
+// figure is that phase's best over the given number of runs, and
+// total is the best run's sum. scan drains the scanner without
+// formatting a dump, and unparse (which annotates identifiers with
+// their types, so needs name analysis first) is timed in runs of its
+// own, writing to /dev/null as codegen writes its assembly.
+// Throughput is reported against the size of the source and against
+// the number of AST nodes the parse builds, and the memory the
+// finished AST takes is given for comparison between the tree and
+// (with --flat-ast) the FlatAST. --jobs=N type checks on N threads,
+// as lilcc -j N does. --fused-sema runs name and type analysis as
+// the one pass lilcc -ffused-sema does, and reports them as a single
+// "sema" phase. --regalloc=A has codegen keep values in registers
+// allocated by A, as lilcc -fregalloc=A does, without the peephole
+// optimizer, and then reports how much A spilled and coalesced, so
+// the allocators can be compared on the same input.
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "err.hpp"
+#include "ast.hpp"
+#include "lilc_compiler.hpp"
+#include "lilc_scanner.hpp"
+#include "lilc_dfa_scanner.hpp"
+#include "lilc_source.hpp"
+#include "lilc_arena.hpp"
+#include "lilc_time_report.hpp"
+
+using namespace LILC;
+using Clock = std::chrono::steady_clock;
+
+static const char * const SINK = "/dev/null";
+
+static double seconds(Clock::time_point start){
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// The command line's settings, applied to each compiler it makes
+struct Options{
+	ScannerKind scanner = ScannerKind::FLEX;
+	bool flatAST = false;
+	unsigned jobs = 1;
+	bool fused = false;
+	RegAlloc regAlloc = RegAlloc::NONE;
+};
+
+static void configure(LilC_Compiler& compiler, const Options& opts){
+	compiler.setScanner(opts.scanner);
+	compiler.setFlatAST(opts.flatAST);
+	compiler.setJobs(opts.jobs);
+	compiler.setFusedAnalysis(opts.fused);
+	compiler.setRegAlloc(opts.regAlloc);
+}
+
+// The best wall time of each phase, by the name its PhaseTimer gives
+using PhaseTimes = std::map<std::string, double>;
+
+static void keepBest(PhaseTimes& times, const std::string& phase,
+	double secs)
+{
+	auto found = times.find(phase);
+	if (found == times.end() || secs < found->second){
+		times[phase] = secs;
+	}
+}
+
+/*
+* Runs body reps times, each on a fresh compiler reporting to its own
+* TimeReport, and keeps each phase's best time and the best "total"
+* (the sum of a run's phases). body returns false if a phase failed;
+* that is the last phase the run reported, and it is left out, so a
+* phase that failed or never ran has no time at all.
+*/
+static PhaseTimes best(int reps, const Options& opts,
+	const std::function<bool(LilC_Compiler&)>& body)
+{
+	PhaseTimes res;
+	for (int i = 0; i < reps; i++){
+		TimeReport times;
+		LilC_Compiler * compiler = new LilC_Compiler();
+		configure(*compiler, opts);
+		compiler->setTimeReport(&times);
+		bool ok = body(*compiler);
+		delete compiler;
+		std::vector<TimeReport::Phase> phases = times.getPhases();
+		if (!ok && !phases.empty()){ phases.pop_back(); }
+		if (phases.empty()){ continue; }
+		double total = 0;
+		for (const TimeReport::Phase& phase : phases){
+			keepBest(res, phase.name, phase.wallSecs);
+			total += phase.wallSecs;
+		}
+		keepBest(res, "total", total);
+	}
+	return res;
+}
+
+// NaN for a phase with no time
+static double timeOf(const PhaseTimes& times, const char * phase){
+	auto found = times.find(phase);
+	return found == times.end() ? NAN : found->second;
+}
+
+static double timeScan(const char * file, int reps, ScannerKind kind){
+	double res = 1e30;
+	Arena arena;
+	for (int i = 0; i < reps; i++){
+		arena.reset();
+		// Fresh, as each compiler's is
+		NameTable names;
+		auto start = Clock::now();
+		SourceFile src(file);
+		TokenSource * scanner;
+		if (kind == ScannerKind::DFA){
+			scanner = new LilC_DFAScanner(src.begin(), src.end(), arena,
+				names);
+		} else {
+			scanner = new LilC_Scanner(&src, arena, names);
+		}
+		Token * tok;
+		while (scanner->yylex(&tok) != LilC_Parser::token::END){ }
+		delete scanner;
+		double secs = seconds(start);
+		if (secs < res){ res = secs; }
+	}
+	return res;
+}
+
+// secs is NaN for a phase that couldn't run
+static void report(const char * phase, double secs,
+	double mb, double nodes)
+{
+	std::cout << std::left << std::setw(10) << phase << std::right;
+	if (std::isnan(secs)){
+		std::cout << std::setw(12) << "n/a" << "\n";
+		return;
+	}
+	std::cout << std::fixed << std::setprecision(3)
+		<< std::setw(12) << secs * 1e3 << " ms"
+		<< std::setprecision(1)
+		<< std::setw(12) << mb / secs << " MB/s"
+		<< std::setprecision(2)
+		<< std::setw(12) << nodes / secs / 1e6 << " Mnodes/s\n";
+}
+
+static int usage(){
+	std::cerr << "Usage: phase_bench [--scanner=flex|dfa] [--flat-ast]"
+		" [--jobs=N] [--fused-sema]\n"
+		"    [--regalloc=none|linear-scan|coloring] <file.lilc>"
+		" [repetitions]\n";
+	return 1;
+}
+
+int main(int argc, char ** argv){
+	Options opts;
+	int arg = 1;
+	for (; arg < argc && argv[arg][0] == '-'; arg++){
+		if (std::strcmp(argv[arg], "--scanner=dfa") == 0){
+			opts.scanner = ScannerKind::DFA;
+		} else if (std::strcmp(argv[arg], "--scanner=flex") == 0){
+			opts.scanner = ScannerKind::FLEX;
+		} else if (std::strcmp(argv[arg], "--flat-ast") == 0){
+			opts.flatAST = true;
+		} else if (std::strncmp(argv[arg], "--jobs=", 7) == 0){
+			int jobs = std::atoi(argv[arg] + 7);
+			if (jobs < 1){ return usage(); }
+			opts.jobs = static_cast<unsigned>(jobs);
+		} else if (std::strcmp(argv[arg], "--fused-sema") == 0){
+			opts.fused = true;
+		} else if (std::strcmp(argv[arg], "--regalloc=none") == 0){
+			opts.regAlloc = RegAlloc::NONE;
+		} else if (std::strcmp(argv[arg], "--regalloc=linear-scan") == 0){
+			opts.regAlloc = RegAlloc::LINEAR_SCAN;
+		} else if (std::strcmp(argv[arg], "--regalloc=coloring") == 0){
+			opts.regAlloc = RegAlloc::COLORING;
+		} else {
+			return usage();
+		}
+	}
+	if (arg >= argc){ return usage(); }
+	const char * file = argv[arg];
+	int reps = arg + 1 < argc ? std::atoi(argv[arg + 1]) : 5;
+	if (reps < 1){ reps = 1; }
+
+	SourceFile src(file);
+	if (!src.good()){
+		std::cerr << "Bad input file " << file << "\n";
+		return 1;
+	}
+	double mb = static_cast<double>(src.size()) / (1024.0 * 1024.0);
+
+	size_t nodesBefore = ASTNode::nodesCreated;
+	size_t astBytes;
+	{
+		LilC_Compiler compiler;
+		configure(compiler, opts);
+		if (!compiler.parse(file)){ return 1; }
+		astBytes = opts.flatAST ? compiler.getFlatAST().bytesUsed()
+			: compiler.nodeArena().bytesUsed();
+	}
+	double nodes = static_cast<double>(
+		ASTNode::nodesCreated - nodesBefore);
+
+	double scan = timeScan(file, reps, opts.scanner);
+	PhaseTimes times = best(reps, opts, [&](LilC_Compiler& c){
+		return c.codeGen(file, SINK);
+	});
+	PhaseTimes unparse = best(reps, opts, [&](LilC_Compiler& c){
+		if (!c.nameAnalysis(file)){ return false; }
+		c.unparse(SINK);
+		return true;
+	});
+
+	std::cout << file << ": " << src.size() << " bytes, "
+		<< static_cast<size_t>(nodes) << " AST nodes, "
+		<< (opts.scanner == ScannerKind::DFA ? "dfa" : "flex")
+		<< " scanner, " << opts.jobs << " type checking job(s), best of "
+		<< reps << "\n"
+		<< (opts.flatAST ? "flat" : "tree") << " AST: " << astBytes
+		<< " bytes, " << std::fixed << std::setprecision(1)
+		<< static_cast<double>(astBytes) / nodes << " per node\n";
+	report("scan", scan, mb, nodes);
+	report("parse", timeOf(times, "parse"), mb, nodes);
+	if (opts.fused && !opts.flatAST){
+		report("sema", timeOf(times, "semantic analysis"), mb, nodes);
+	} else {
+		report("name", timeOf(times, "name analysis"), mb, nodes);
+		report("type", timeOf(times, "type analysis"), mb, nodes);
+	}
+	report("unparse", timeOf(unparse, "unparse"), mb, nodes);
+	report("codegen", timeOf(times, "codegen"), mb, nodes);
+	report("total", timeOf(times, "total"), mb, nodes);
+	if (opts.regAlloc != RegAlloc::NONE){
+		LilC_Compiler compiler;
+		configure(compiler, opts);
+		compiler.setOptReport(&std::cout);
+		compiler.codeGen(file, SINK);
+	}
+	return 0;
+}
@@ -0,0 +1,91 @@
+// Compares the flex scanner against the hand-written DFA scanner.
+//
+//   make bench OPT=-O2
+//   bench/scan_bench <file.lilc> [repetitions]
+//
+// Each scanner drains the whole file (already mapped, so I/O is
+// out of the picture) the given number of times; the best run is
+// reported as MB/s and tokens/s, followed by how many times faster
+// the DFA scanner was. The two must produce the same number of
+// tokens, or the rates aren't comparable and this fails.
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+#include "lilc_scanner.hpp"
+#include "lilc_dfa_scanner.hpp"
+#include "lilc_source.hpp"
+#include "lilc_arena.hpp"
+
+using namespace LILC;
+using Clock = std::chrono::steady_clock;
+
+static size_t drain(TokenSource& scanner){
+	Token * tok;
+	size_t count = 0;
+	while (scanner.yylex(&tok) != LilC_Parser::token::END){
+		count++;
+	}
+	return count;
+}
+
+// Prints and returns the best time, and sets tokens to the count
+template <typename MakeScanner>
+static double run(const char * label, const SourceFile& src,
+	int reps, size_t& tokens, MakeScanner make)
+{
+	Arena arena;
+	double best = 1e30;
+	tokens = 0;
+	for (int i = 0; i < reps; i++){
+		arena.reset();
+		TokenSource * scanner = make(arena);
+		auto start = Clock::now();
+		tokens = drain(*scanner);
+		double secs = std::chrono::duration<double>(
+			Clock::now() - start).count();
+		delete scanner;
+		if (secs < best){ best = secs; }
+	}
+	double mb = static_cast<double>(src.size()) / (1024.0 * 1024.0);
+	std::cout << std::left << std::setw(6) << label
+		<< std::right << std::fixed << std::setprecision(1)
+		<< std::setw(10) << mb / best << " MB/s"
+		<< std::setw(14) << static_cast<double>(tokens) / best / 1e6
+		<< " Mtok/s" << std::setw(12) << tokens << " tokens\n";
+	return best;
+}
+
+int main(int argc, char ** argv){
+	if (argc < 2){
+		std::cerr << "Usage: scan_bench <file.lilc> [repetitions]\n";
+		return 1;
+	}
+	int reps = argc > 2 ? std::atoi(argv[2]) : 5;
+	SourceFile src(argv[1]);
+	if (!src.good()){
+		std::cerr << "Bad input file " << argv[1] << "\n";
+		return 1;
+	}
+
+	NameTable names;
+	size_t flexTokens, dfaTokens;
+	double flex = run("flex", src, reps, flexTokens,
+		[&](Arena& arena) -> TokenSource * {
+			return new LilC_Scanner(&src, arena, names);
+		});
+	double dfa = run("dfa", src, reps, dfaTokens,
+		[&](Arena& arena) -> TokenSource * {
+			return new LilC_DFAScanner(src.begin(), src.end(),
+				arena, names);
+		});
+	if (flexTokens != dfaTokens){
+		std::cerr << "The scanners disagree: flex found " << flexTokens
+			<< " tokens, dfa " << dfaTokens << "\n";
+		return 1;
+	}
+	std::cout << "dfa/flex" << std::setprecision(2) << std::setw(8)
+		<< flex / dfa << "x\n";
+	return 0;
+}
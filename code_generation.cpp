@@ -1,32 +1,232 @@
+#include <fstream>
+
 #include "err.hpp"
 #include "ast.hpp"
 #include "symbol_table.hpp"
 #include "lilc_compiler.hpp"
-#include "lilc_mips.hpp"
+#include "lilc_codegen.hpp"
 
 namespace LILC{
 
+using NodeKind = FlatAST::NodeKind;
+
 bool LilC_Compiler::codeGen(
 	const char * const inFile,
 	const char * const outFile
 ){
 	if (!this->typeAnalysis(inFile)){ return false; }
-	return this->astRoot->codeGen();
+	PhaseTimer timer(timeReport, "codegen");
+	std::ofstream out(outFile);
+	CodeGen gen(out);
+	gen.setRegAlloc(regAlloc);
+	gen.setOptLevel(optLevel);
+	gen.setOptReport(optReport);
+	if (useFlatAST){
+		this->flatAST.codeGen(gen);
+	} else {
+		this->astRoot->codeGen(gen);
+	}
+	return true;
 }
 
-bool ASTNode::codeGen(){
+void ASTNode::codeGen(CodeGen& gen){
 	throw LILC::InternalError(
 		__FILE__ ": "
 		"We should never see this, as it\n"
 		"is supposed to be overridden in any\n"
 		"subclass at which it is encountered");
-	return false;
 }
 
-bool ProgramNode::codeGen(){
-	throw LILC::ToDoError();
-	return false;
+void ProgramNode::codeGen(CodeGen& gen){
+	myDeclList->codeGen(gen);
+	gen.finish();
+}
+
+void DeclListNode::codeGen(CodeGen& gen){
+	for (DeclNode * decl : myDecls){
+		decl->codeGen(gen);
+	}
+}
+
+void DeclNode::codeGen(CodeGen& gen){
+}
+
+//Locals were given their slots in name analysis, so only
+// globals need anything
+void VarDeclNode::codeGen(CodeGen& gen){
+	SymbolTableEntry * sym = myDeclaredID->getSymbol();
+	VarSymbol * var = static_cast<VarSymbol *>(sym);
+	if (var->getStorage() == Storage::GLOBAL){
+		gen.genGlobal(getName(), var);
+	}
+}
+
+void FnDeclNode::codeGen(CodeGen& gen){
+	SymbolTableEntry * sym = myId->getSymbol();
+	if (sym->getKind() != Kind::FUNC){
+		throw InternalError("FnDeclNode has a "
+			"non-function kind id symbol");
+	}
+	gen.genFnEntry(myId->getName(), static_cast<FuncSymbol *>(sym));
+	myBody->codeGen(gen);
+	gen.genFnExit();
+}
+
+void FnBodyNode::codeGen(CodeGen& gen){
+	myStmtList->codeGen(gen);
+}
+
+void StmtListNode::codeGen(CodeGen& gen){
+	for (StmtNode * stmt : myStmts){
+		stmt->codeGen(gen);
+	}
+}
+
+void AssignStmtNode::codeGen(CodeGen& gen){
+	myAssign->codeGen(gen);
+	gen.genDiscard();
+}
+
+void PostIncStmtNode::codeGen(CodeGen& gen){
+	gen.genIncDec(myExp->location(), 1);
+}
+
+void PostDecStmtNode::codeGen(CodeGen& gen){
+	gen.genIncDec(myExp->location(), -1);
+}
+
+void ReadStmtNode::codeGen(CodeGen& gen){
+	gen.genRead(myExp->location());
+}
+
+void WriteStmtNode::codeGen(CodeGen& gen){
+	myExp->codeGen(gen);
+	gen.genWrite(myExp->getType());
+}
+
+void IfStmtNode::codeGen(CodeGen& gen){
+	Label done = gen.nextLabel();
+	myExp->codeGen(gen);
+	gen.genJumpIfFalse(done);
+	myStmts->codeGen(gen);
+	gen.genLabel(done);
+}
+
+void IfElseStmtNode::codeGen(CodeGen& gen){
+	Label elseLabel = gen.nextLabel();
+	Label done = gen.nextLabel();
+	myExp->codeGen(gen);
+	gen.genJumpIfFalse(elseLabel);
+	myStmtsT->codeGen(gen);
+	gen.genJump(done);
+	gen.genLabel(elseLabel);
+	myStmtsF->codeGen(gen);
+	gen.genLabel(done);
+}
+
+void WhileStmtNode::codeGen(CodeGen& gen){
+	Label top = gen.nextLabel();
+	Label done = gen.nextLabel();
+	gen.genLabel(top);
+	myExp->codeGen(gen);
+	gen.genJumpIfFalse(done);
+	myStmts->codeGen(gen);
+	gen.genJump(top);
+	gen.genLabel(done);
+}
+
+void CallStmtNode::codeGen(CodeGen& gen){
+	myCallExp->codeGen(gen);
+	gen.genDiscard();
+}
+
+void ReturnStmtNode::codeGen(CodeGen& gen){
+	if (myExp != nullptr){ myExp->codeGen(gen); }
+	gen.genReturn(myExp != nullptr);
 }
 
-} // End namespace LILC 
+MemLoc ExpNode::location(){
+	throw InternalError("location of an expression "
+		"that isn't a variable");
+}
+
+MemLoc IdNode::location(){
+	return CodeGen::locate(myName, static_cast<VarSymbol *>(mySymbol));
+}
+
+MemLoc DotAccessNode::location(){
+	return CodeGen::field(myExp->location(),
+		static_cast<VarSymbol *>(myId->getSymbol()));
+}
+
+void IdNode::codeGen(CodeGen& gen){
+	gen.genLoad(location());
+}
+
+void DotAccessNode::codeGen(CodeGen& gen){
+	gen.genLoad(location());
+}
+
+void IntLitNode::codeGen(CodeGen& gen){
+	gen.genIntLit(myInt);
+}
+
+void StrLitNode::codeGen(CodeGen& gen){
+	gen.genStrLit(myString);
+}
+
+void TrueNode::codeGen(CodeGen& gen){
+	gen.genBoolLit(true);
+}
+
+void FalseNode::codeGen(CodeGen& gen){
+	gen.genBoolLit(false);
+}
+
+void AssignNode::codeGen(CodeGen& gen){
+	myExpRHS->codeGen(gen);
+	gen.genStore(myExpLHS->location());
+}
+
+void ExpListNode::codeGen(CodeGen& gen){
+	for (ExpNode * exp : myExps){
+		exp->codeGen(gen);
+	}
+}
+
+void CallExpNode::codeGen(CodeGen& gen){
+	myExpList->codeGen(gen);
+	gen.genCall(myId->getName(), myExpList->getExps()->size());
+}
+
+void UnaryMinusNode::codeGen(CodeGen& gen){
+	myExp->codeGen(gen);
+	gen.genUnary(NodeKind::NEG);
+}
+
+void NotNode::codeGen(CodeGen& gen){
+	myExp->codeGen(gen);
+	gen.genUnary(NodeKind::NOT);
+}
+
+void BinaryExpNode::codeGen(CodeGen& gen){
+	myExp1->codeGen(gen);
+	myExp2->codeGen(gen);
+	gen.genBinary(flatKind());
+}
+
+void AndNode::codeGen(CodeGen& gen){
+	myExp1->codeGen(gen);
+	Label done = gen.genShortCircuit(NodeKind::AND);
+	myExp2->codeGen(gen);
+	gen.genShortCircuitEnd(done);
+}
+
+void OrNode::codeGen(CodeGen& gen){
+	myExp1->codeGen(gen);
+	Label done = gen.genShortCircuit(NodeKind::OR);
+	myExp2->codeGen(gen);
+	gen.genShortCircuitEnd(done);
+}
 
+} // End namespace LILC
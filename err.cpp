@@ -0,0 +1,74 @@
+#include "err.hpp"
+
+namespace LILC{
+
+// Indexed by ErrCode
+static const char * const MESSAGES[] = {
+	"Multiply declared identifiers",
+	"Undeclared identifier",
+	"Undefined type",
+	"Non-function declared void",
+	"Dot-access of non-struct type",
+	"Invalid struct field name",
+	"Attempt to write a function",
+	"Attempt to write a struct variable",
+	"Attempt to write a struct name",
+	"Attempt to write void",
+	"Attempt to read a function",
+	"Attempt to read a struct variable",
+	"Attempt to read a struct name",
+	"Arithmetic operator applied to non-numeric operand",
+	"Relational operator applied to non-numeric operand",
+	"Logical operator applied to non-bool operand",
+	"Attempt to call a non-function",
+	"Function call with wrong number of args",
+	"Type of actual does not match type of formal",
+	"Missing return value",
+	"Bad return value",
+	"Return with a value in a void function",
+	"Type mismatch",
+	"Equality operator applied to void functions",
+	"Equality operator applied to functions",
+	"Equality operator applied to struct variables",
+	"Equality operator applied to struct names",
+	"Non-bool expression used as an if condition",
+	"Function assignment",
+	"Struct name assignment",
+	"Struct variable assignment",
+};
+
+static_assert(sizeof(MESSAGES) / sizeof(MESSAGES[0])
+	== static_cast<size_t>(ErrCode::ASSIGN_STRUCT_VAR) + 1,
+	"every ErrCode needs a message");
+
+void SourcePos::appendTo(std::string& out) const {
+	if (packed == 0){
+		out += "0,0";
+		return;
+	}
+	out += std::to_string(line());
+	out += ':';
+	out += std::to_string(col());
+}
+
+void Diagnostics::append(Diagnostics& other){
+	records.insert(records.end(),
+		other.records.begin(), other.records.end());
+	other.records.clear();
+}
+
+void Diagnostics::flush(std::ostream& out){
+	if (records.empty()){ return; }
+	std::string text;
+	for (const Record& record : records){
+		record.pos.appendTo(text);
+		text += " ***ERROR*** ";
+		text += MESSAGES[static_cast<size_t>(record.code)];
+		text += '\n';
+	}
+	records.clear();
+	out.write(text.data(), static_cast<std::streamsize>(text.size()));
+	out.flush();
+}
+
+} // End namespace LILC
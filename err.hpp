@@ -1,44 +1,170 @@
 #ifndef LILC_ERROR_REPORTING_HH
 #define LILC_ERROR_REPORTING_HH
 
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <string>
+#include <vector>
 
 namespace LILC{
 
+/*
+* A line and column packed into one word. Diagnostics keep these
+* rather than "line:col" strings, so nothing is formatted unless
+* the diagnostic is printed.
+*/
+class SourcePos{
+public:
+	// Nowhere in the source; printed as 0,0
+	SourcePos() : packed(0) { }
+	SourcePos(size_t line, size_t col)
+	: packed(static_cast<uint64_t>(line) << 32
+		| static_cast<uint32_t>(col)) { }
+	size_t line() const { return static_cast<size_t>(packed >> 32); }
+	size_t col() const {
+		return static_cast<size_t>(packed & UINT32_MAX);
+	}
+	void appendTo(std::string& out) const;
+	std::string str() const {
+		std::string res;
+		appendTo(res);
+		return res;
+	}
+private:
+	uint64_t packed;
+};
+
+// Everything the semantic passes report, in err.cpp's table
+enum class ErrCode : uint8_t {
+	MULTI_DECL, UNDECLARED_ID, UNDEF_TYPE, BAD_VOID,
+	BAD_DOT_LHS, BAD_DOT_RHS,
+	WRITE_FUNCTION, WRITE_STRUCT_VAR, WRITE_STRUCT_NAME, WRITE_VOID,
+	READ_FUNCTION, READ_STRUCT_VAR, READ_STRUCT_NAME,
+	BAD_MATH, BAD_RELATIONAL, BAD_LOGICAL,
+	CALL_NON_FUNC, BAD_NUM_ARGS, ARG_MISMATCH,
+	MISSING_RETURN_VALUE, BAD_RETURN_VALUE, RETURN_FROM_VOID,
+	TYPE_MISMATCH, VOID_EQ, FUN_EQ, STRUCT_VAR_EQ, STRUCT_NAME_EQ,
+	BAD_IF_COND,
+	ASSIGN_FUNCTION, ASSIGN_STRUCT_NAME, ASSIGN_STRUCT_VAR
+};
+
+/*
+* Diagnostics held back as (position, code) records, to be
+* printed in the order they were reported with a single write.
+* The compiler collects each phase's in one of these (see
+* DiagnosticScope), and parallelChecks gives each of its checks
+* one, appending them in index order when all are done.
+*/
+class Diagnostics{
+public:
+	void report(SourcePos pos, ErrCode code){
+		records.push_back(Record{pos, code});
+	}
+	bool empty() const { return records.empty(); }
+	size_t size() const { return records.size(); }
+	// Moves other's records to the end of these
+	void append(Diagnostics& other);
+	// Print and forget everything reported so far
+	void flush(std::ostream& out);
+
+	// Where this thread's reports go, or null if they should be
+	// printed to std::cerr straight away
+	static Diagnostics *& current(){
+		static thread_local Diagnostics * threadCurrent = nullptr;
+		return threadCurrent;
+	}
+private:
+	struct Record{
+		SourcePos pos;
+		ErrCode code;
+	};
+	std::vector<Record> records;
+};
+
+/*
+* Collects this thread's diagnostics for as long as it lives,
+* then prints them to out.
+*/
+class DiagnosticScope{
+public:
+	explicit DiagnosticScope(std::ostream& outIn)
+	: out(outIn), outer(Diagnostics::current()) {
+		Diagnostics::current() = &diagnostics;
+	}
+	~DiagnosticScope(){
+		Diagnostics::current() = outer;
+		diagnostics.flush(out);
+	}
+	DiagnosticScope(const DiagnosticScope&) = delete;
+	DiagnosticScope& operator=(const DiagnosticScope&) = delete;
+private:
+	Diagnostics diagnostics;
+	std::ostream& out;
+	Diagnostics * outer;
+};
+
 class Err{
 	public:
-	static void report(std::string pos, std::string msg){ 
-		std::cerr << pos 
+	static void report(SourcePos pos, ErrCode code){
+		Diagnostics * diagnostics = Diagnostics::current();
+		if (diagnostics != nullptr){
+			diagnostics->report(pos, code);
+			return;
+		}
+		Diagnostics single;
+		single.report(pos, code);
+		single.flush(std::cerr);
+	}
+
+	// The scanners' messages, which have no code and are printed
+	// at once, among whatever the parser prints
+	static void report(SourcePos pos, const std::string& msg){ 
+		scanReports()++;
+		std::cerr << pos.str() 
 			<< " ***ERROR*** " << msg << std::endl;
 	}
 
-	static bool multiDecl(std::string pos){
-		report(pos, "Multiply declared identifiers");
+	static void warn(SourcePos pos, const std::string& msg){ 
+		scanReports()++;
+		std::cerr << pos.str() 
+			<< " ***WARNING*** " << msg << std::endl;
+	}
+
+	// How many of those this thread has printed, so that a caller
+	// can tell whether a scan was clean
+	static size_t& scanReports(){
+		static thread_local size_t count = 0;
+		return count;
+	}
+
+	static bool multiDecl(SourcePos pos){
+		report(pos, ErrCode::MULTI_DECL);
 		return false;
 	}
 
-	static bool undeclaredID(std::string pos){
-		report(pos, "Undeclared identifier");
+	static bool undeclaredID(SourcePos pos){
+		report(pos, ErrCode::UNDECLARED_ID);
 		return false;
 	}
 
-	static bool undefType(std::string pos){
-		report(pos, "Undefined type");
+	static bool undefType(SourcePos pos){
+		report(pos, ErrCode::UNDEF_TYPE);
 		return false;
 	}
 
-	static bool badVoid(std::string pos){
-		report(pos, "Non-function declared void");
+	static bool badVoid(SourcePos pos){
+		report(pos, ErrCode::BAD_VOID);
 		return false;
 	}
 
-	static bool badDotLHS(std::string pos){
-		report(pos, "Dot-access of non-struct type");
+	static bool badDotLHS(SourcePos pos){
+		report(pos, ErrCode::BAD_DOT_LHS);
 		return false;
 	}
 
-	static bool badDotRHS(std::string pos){
-		report(pos, "Invalid struct field name");
+	static bool badDotRHS(SourcePos pos){
+		report(pos, ErrCode::BAD_DOT_RHS);
 		return false;
 	}
 
@@ -46,129 +172,103 @@ class Err{
 
 class TypeErr{
 public:
-	static std::string writeFunction(std::string pos){
-		Err::report(pos, "Attempt to write a function");
-		return "ERROR";
+	// Where this thread's type errors go: wherever Err's reports
+	// do, unless they have been set apart, as the fused semantic
+	// analysis does until it knows there were no name errors
+	static Diagnostics *& sink(){
+		static thread_local Diagnostics * threadSink = nullptr;
+		return threadSink;
+	}
+
+	static bool report(SourcePos pos, ErrCode code){
+		Diagnostics * s = sink();
+		if (s != nullptr){ s->report(pos, code); }
+		else { Err::report(pos, code); }
+		return false;
+	}
+
+	static bool writeFunction(SourcePos pos){
+		return report(pos, ErrCode::WRITE_FUNCTION);
 	}
-	static std::string writeStructVar(std::string pos){
-		Err::report(pos, "Attempt to write a struct"
-			" variable");
-		return "ERROR";
+	static bool writeStructVar(SourcePos pos){
+		return report(pos, ErrCode::WRITE_STRUCT_VAR);
 	}
-	static std::string writeStructName(std::string pos){
-		Err::report(pos, "Attempt to write a struct"
-			" name");
-		return "ERROR";
+	static bool writeStructName(SourcePos pos){
+		return report(pos, ErrCode::WRITE_STRUCT_NAME);
 	}
-	static std::string readFunction(std::string pos){
-		Err::report(pos, "Attempt to read a function");
-		return "ERROR";
+	static bool readFunction(SourcePos pos){
+		return report(pos, ErrCode::READ_FUNCTION);
 	}
-	static std::string readStructVar(std::string pos){
-		Err::report(pos, "Attempt to read a struct"
-			" variable");
-		return "ERROR";
+	static bool readStructVar(SourcePos pos){
+		return report(pos, ErrCode::READ_STRUCT_VAR);
 	}
-	static std::string readStructName(std::string pos){
-		Err::report(pos, "Attempt to read a struct"
-			" name");
-		return "ERROR";
+	static bool readStructName(SourcePos pos){
+		return report(pos, ErrCode::READ_STRUCT_NAME);
 	}
-	static std::string writeVoid(std::string pos){
-		Err::report(pos, "Attempt to write void");
-		return "ERROR";
+	static bool writeVoid(SourcePos pos){
+		return report(pos, ErrCode::WRITE_VOID);
 	}
-	static std::string badMath(std::string pos){
-		Err::report(pos, "Arithmetic operator applied"
-			" to non-numeric operand");
-		return "ERROR";
+	static bool badMath(SourcePos pos){
+		return report(pos, ErrCode::BAD_MATH);
 	}
-	static std::string badRelational(std::string pos){
-		Err::report(pos, "Relational operator applied"
-			" to non-numeric operand");
-		return "ERROR";
+	static bool badRelational(SourcePos pos){
+		return report(pos, ErrCode::BAD_RELATIONAL);
 	}
-	static std::string badLogical(std::string pos){
-		Err::report(pos, "Logical operator applied"
-			" to non-bool operand");
-		return "ERROR";
+	static bool badLogical(SourcePos pos){
+		return report(pos, ErrCode::BAD_LOGICAL);
 	}
-	static std::string callNonFunc(std::string pos){
-		Err::report(pos, "Attempt to call a"
-			" non-function");
-		return "ERROR";
+	static bool callNonFunc(SourcePos pos){
+		return report(pos, ErrCode::CALL_NON_FUNC);
 	}
-	static std::string badNumArgs(std::string pos){
-		Err::report(pos, "Function call with"
-			" wrong number of args");
-		return "ERROR";
+	static bool badNumArgs(SourcePos pos){
+		return report(pos, ErrCode::BAD_NUM_ARGS);
 	}
-	static std::string argMismatch(std::string pos){
-		Err::report(pos, "Type of actual does"
-			" not match type of formal");
-		return "ERROR";
+	static bool argMismatch(SourcePos pos){
+		return report(pos, ErrCode::ARG_MISMATCH);
 	}
-	static std::string missingReturnValue(std::string pos){
-		Err::report(pos, "Missing return value");
-		return "ERROR";
+	static bool missingReturnValue(SourcePos pos){
+		return report(pos, ErrCode::MISSING_RETURN_VALUE);
 	}
-	static std::string badReturnValue(std::string pos){
-		Err::report(pos, "Bad return value");
-		return "ERROR";
+	static bool badReturnValue(SourcePos pos){
+		return report(pos, ErrCode::BAD_RETURN_VALUE);
 	}
-	static std::string returnFromVoid(std::string pos){
-		Err::report(pos, "Return with a value in a"
-			" void function");
-		return "ERROR";
+	static bool returnFromVoid(SourcePos pos){
+		return report(pos, ErrCode::RETURN_FROM_VOID);
 	}
-	static std::string typeMismatch(std::string pos){
-		Err::report(pos, "Type mismatch");
-		return "ERROR";
+	static bool typeMismatch(SourcePos pos){
+		return report(pos, ErrCode::TYPE_MISMATCH);
 	}
 
-	static std::string voidEq(std::string pos){
-		Err::report(pos, "Equality operator applied"
-			" to void functions");
-		return "ERROR";
+	static bool voidEq(SourcePos pos){
+		return report(pos, ErrCode::VOID_EQ);
 	}
 
-	static std::string funEq(std::string pos){
-		Err::report(pos, "Equality operator applied"
-			" to functions");
-		return "ERROR";
+	static bool funEq(SourcePos pos){
+		return report(pos, ErrCode::FUN_EQ);
 	}
 
-	static std::string structVarEq(std::string pos){
-		Err::report(pos, "Equality operator applied"
-			" to struct variables");
-		return "ERROR";
+	static bool structVarEq(SourcePos pos){
+		return report(pos, ErrCode::STRUCT_VAR_EQ);
 	}
 
-	static std::string structNameEq(std::string pos){
-		Err::report(pos, "Equality operator applied"
-			" to struct names");
-		return "ERROR";
+	static bool structNameEq(SourcePos pos){
+		return report(pos, ErrCode::STRUCT_NAME_EQ);
 	}
 
-	static std::string badIfCond(std::string pos){
-		Err::report(pos, "Non-bool expression used"
-			" as an if condition");
-		return "ERROR";
+	static bool badIfCond(SourcePos pos){
+		return report(pos, ErrCode::BAD_IF_COND);
 	}
 
-	static std::string assignFunction(std::string pos){
-		Err::report(pos, "Function assignment");
-		return "ERROR";
+	static bool assignFunction(SourcePos pos){
+		return report(pos, ErrCode::ASSIGN_FUNCTION);
 	}
 
-	static std::string assignStructName(std::string pos){
-		Err::report(pos, "Struct name assignment");
-		return "ERROR";
+	static bool assignStructName(SourcePos pos){
+		return report(pos, ErrCode::ASSIGN_STRUCT_NAME);
 	}
 
-	static std::string assignStructVar(std::string pos){
-		Err::report(pos, "Struct variable assignment");
-		return "ERROR";
+	static bool assignStructVar(SourcePos pos){
+		return report(pos, ErrCode::ASSIGN_STRUCT_VAR);
 	}
 };
 
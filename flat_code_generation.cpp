@@ -0,0 +1,188 @@
+#include "err.hpp"
+#include "lilc_flat_ast.hpp"
+#include "lilc_codegen.hpp"
+#include "symbol_table.hpp"
+
+namespace LILC{
+
+using Index = FlatAST::Index;
+using NodeKind = FlatAST::NodeKind;
+
+static void expCodeGen(FlatAST& ast, Index exp, CodeGen& gen);
+
+// As ExpNode::location, for an ID or a DOT
+static MemLoc location(FlatAST& ast, Index exp){
+	if (ast.kind(exp) == NodeKind::DOT){
+		Index field = ast.rhs(exp);
+		return CodeGen::field(location(ast, ast.lhs(exp)),
+			static_cast<VarSymbol *>(ast.getSymbol(field)));
+	}
+	if (ast.kind(exp) != NodeKind::ID){
+		throw InternalError("location of an expression "
+			"that isn't a variable");
+	}
+	return CodeGen::locate(ast.getName(exp),
+		static_cast<VarSymbol *>(ast.getSymbol(exp)));
+}
+
+static void expCodeGen(FlatAST& ast, Index exp, CodeGen& gen){
+	NodeKind kind = ast.kind(exp);
+	switch (kind){
+		case NodeKind::ID:
+		case NodeKind::DOT:
+			gen.genLoad(location(ast, exp));
+			return;
+		case NodeKind::INT_LIT:
+			gen.genIntLit(ast.getInt(exp));
+			return;
+		case NodeKind::STR_LIT:
+			gen.genStrLit(ast.getText(exp));
+			return;
+		case NodeKind::TRUE_LIT:
+			gen.genBoolLit(true);
+			return;
+		case NodeKind::FALSE_LIT:
+			gen.genBoolLit(false);
+			return;
+		case NodeKind::ASSIGN:
+			expCodeGen(ast, ast.rhs(exp), gen);
+			gen.genStore(location(ast, ast.lhs(exp)));
+			return;
+		case NodeKind::CALL:
+		{
+			FlatAST::List args = ast.list(ast.rhs(exp));
+			for (Index arg : args){
+				expCodeGen(ast, arg, gen);
+			}
+			gen.genCall(ast.getName(ast.lhs(exp)), args.size());
+			return;
+		}
+		case NodeKind::NEG:
+		case NodeKind::NOT:
+			expCodeGen(ast, ast.lhs(exp), gen);
+			gen.genUnary(kind);
+			return;
+		case NodeKind::AND:
+		case NodeKind::OR:
+		{
+			expCodeGen(ast, ast.lhs(exp), gen);
+			Label done = gen.genShortCircuit(kind);
+			expCodeGen(ast, ast.rhs(exp), gen);
+			gen.genShortCircuitEnd(done);
+			return;
+		}
+		default:
+			expCodeGen(ast, ast.lhs(exp), gen);
+			expCodeGen(ast, ast.rhs(exp), gen);
+			gen.genBinary(kind);
+			return;
+	}
+}
+
+static void stmtListCodeGen(FlatAST& ast, Index list, CodeGen& gen);
+
+static void stmtCodeGen(FlatAST& ast, Index stmt, CodeGen& gen){
+	Index exp = ast.lhs(stmt);
+	switch (ast.kind(stmt)){
+		case NodeKind::ASSIGN_STMT:
+		case NodeKind::CALL_STMT:
+			expCodeGen(ast, exp, gen);
+			gen.genDiscard();
+			return;
+		case NodeKind::POST_INC:
+			gen.genIncDec(location(ast, exp), 1);
+			return;
+		case NodeKind::POST_DEC:
+			gen.genIncDec(location(ast, exp), -1);
+			return;
+		case NodeKind::READ:
+			gen.genRead(location(ast, exp));
+			return;
+		case NodeKind::WRITE:
+			expCodeGen(ast, exp, gen);
+			gen.genWrite(ast.getType(exp));
+			return;
+		case NodeKind::IF:
+		{
+			Label done = gen.nextLabel();
+			expCodeGen(ast, exp, gen);
+			gen.genJumpIfFalse(done);
+			stmtListCodeGen(ast, ast.blockStmts(ast.thenBlock(stmt)), gen);
+			gen.genLabel(done);
+			return;
+		}
+		case NodeKind::IF_ELSE:
+		{
+			Label elseLabel = gen.nextLabel();
+			Label done = gen.nextLabel();
+			expCodeGen(ast, exp, gen);
+			gen.genJumpIfFalse(elseLabel);
+			stmtListCodeGen(ast, ast.blockStmts(ast.thenBlock(stmt)), gen);
+			gen.genJump(done);
+			gen.genLabel(elseLabel);
+			stmtListCodeGen(ast, ast.blockStmts(ast.elseBlock(stmt)), gen);
+			gen.genLabel(done);
+			return;
+		}
+		case NodeKind::WHILE:
+		{
+			Label top = gen.nextLabel();
+			Label done = gen.nextLabel();
+			gen.genLabel(top);
+			expCodeGen(ast, exp, gen);
+			gen.genJumpIfFalse(done);
+			stmtListCodeGen(ast, ast.blockStmts(ast.thenBlock(stmt)), gen);
+			gen.genJump(top);
+			gen.genLabel(done);
+			return;
+		}
+		case NodeKind::RETURN:
+			if (exp != FlatAST::NONE){ expCodeGen(ast, exp, gen); }
+			gen.genReturn(exp != FlatAST::NONE);
+			return;
+		default:
+			throw InternalError("codeGen of a non-statement");
+	}
+}
+
+static void stmtListCodeGen(FlatAST& ast, Index list, CodeGen& gen){
+	for (Index stmt : ast.list(list)){
+		stmtCodeGen(ast, stmt, gen);
+	}
+}
+
+static void declCodeGen(FlatAST& ast, Index decl, CodeGen& gen){
+	switch (ast.kind(decl)){
+		case NodeKind::VAR_DECL:
+		{
+			Index id = ast.rhs(decl);
+			VarSymbol * var = static_cast<VarSymbol *>(ast.getSymbol(id));
+			if (var->getStorage() == Storage::GLOBAL){
+				gen.genGlobal(ast.getName(id), var);
+			}
+			return;
+		}
+		case NodeKind::FN_DECL:
+		{
+			Index id = ast.lhs(decl);
+			gen.genFnEntry(ast.getName(id),
+				static_cast<FuncSymbol *>(ast.getSymbol(id)));
+			stmtListCodeGen(ast, ast.blockStmts(ast.fnBody(decl)), gen);
+			gen.genFnExit();
+			return;
+		}
+		case NodeKind::STRUCT_DECL:
+			return;
+		default:
+			throw InternalError("codeGen of a non-declaration");
+	}
+}
+
+void FlatAST::codeGen(CodeGen& gen){
+	for (Index decl : globals){
+		declCodeGen(*this, decl, gen);
+	}
+	gen.finish();
+}
+
+} // End namespace LILC
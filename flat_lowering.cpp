@@ -0,0 +1,215 @@
+#include "err.hpp"
+#include "ast.hpp"
+#include "lilc_flat_ast.hpp"
+
+namespace LILC{
+
+using NodeKind = FlatAST::NodeKind;
+
+FlatAST::Index ASTNode::lower(FlatAST& flat){
+	throw LILC::InternalError(
+		"We should never see this, as it\n"
+		"is supposed to be overridden in any\n"
+		"subclass at which it is encountered");
+}
+
+/*
+* Lists are laid out before their items are lowered, so that
+* the list's words are contiguous in extra whatever the items
+* add there themselves.
+*/
+template <typename T>
+static FlatAST::Index lowerList(FlatAST& flat, const ASTList<T>& items){
+	FlatAST::Index list = flat.reserveList(items.size());
+	size_t k = 0;
+	for (T item : items){
+		flat.setListItem(list, k++, item->lower(flat));
+	}
+	return list;
+}
+
+static FlatAST::Index lowerBlock(FlatAST& flat,
+	DeclListNode * decls, StmtListNode * stmts)
+{
+	FlatAST::Index block = flat.reserve(2);
+	flat.setExtra(block, decls->lower(flat));
+	flat.setExtra(block + 1, stmts->lower(flat));
+	return block;
+}
+
+FlatAST::Index DeclListNode::lower(FlatAST& flat){
+	return lowerList(flat, myDecls);
+}
+
+FlatAST::Index FormalsListNode::lower(FlatAST& flat){
+	return lowerList(flat, myFormals);
+}
+
+FlatAST::Index StmtListNode::lower(FlatAST& flat){
+	return lowerList(flat, myStmts);
+}
+
+FlatAST::Index ExpListNode::lower(FlatAST& flat){
+	return lowerList(flat, myExps);
+}
+
+FlatAST::Index FnBodyNode::lower(FlatAST& flat){
+	return lowerBlock(flat, myDeclList, myStmtList);
+}
+
+FlatAST::Index VarDeclNode::lower(FlatAST& flat){
+	FlatAST::Index type = myType->lower(flat);
+	FlatAST::Index id = myDeclaredID->lower(flat);
+	return flat.add(NodeKind::VAR_DECL, line, col, type, id);
+}
+
+FlatAST::Index FormalDeclNode::lower(FlatAST& flat){
+	FlatAST::Index type = myType->lower(flat);
+	FlatAST::Index id = myDeclaredID->lower(flat);
+	return flat.add(NodeKind::FORMAL_DECL, line, col, type, id);
+}
+
+FlatAST::Index FnDeclNode::lower(FlatAST& flat){
+	FlatAST::Index id = myId->lower(flat);
+	FlatAST::Index parts = flat.reserve(3);
+	flat.setExtra(parts, myRetType->lower(flat));
+	flat.setExtra(parts + 1, myFormals->lower(flat));
+	flat.setExtra(parts + 2, myBody->lower(flat));
+	return flat.add(NodeKind::FN_DECL, line, col, id, parts);
+}
+
+FlatAST::Index StructDeclNode::lower(FlatAST& flat){
+	FlatAST::Index id = myDeclaredID->lower(flat);
+	FlatAST::Index fields = myDeclList->lower(flat);
+	return flat.add(NodeKind::STRUCT_DECL, line, col, id, fields);
+}
+
+FlatAST::Index IntNode::lower(FlatAST& flat){
+	return flat.add(NodeKind::INT_TYPE, line, col);
+}
+
+FlatAST::Index BoolNode::lower(FlatAST& flat){
+	return flat.add(NodeKind::BOOL_TYPE, line, col);
+}
+
+FlatAST::Index VoidNode::lower(FlatAST& flat){
+	return flat.add(NodeKind::VOID_TYPE, line, col);
+}
+
+FlatAST::Index StructNode::lower(FlatAST& flat){
+	FlatAST::Index id = myId->lower(flat);
+	return flat.add(NodeKind::STRUCT_TYPE, line, col, id);
+}
+
+FlatAST::Index AssignStmtNode::lower(FlatAST& flat){
+	FlatAST::Index assign = myAssign->lower(flat);
+	return flat.add(NodeKind::ASSIGN_STMT, line, col, assign);
+}
+
+FlatAST::Index PostIncStmtNode::lower(FlatAST& flat){
+	FlatAST::Index exp = myExp->lower(flat);
+	return flat.add(NodeKind::POST_INC, line, col, exp);
+}
+
+FlatAST::Index PostDecStmtNode::lower(FlatAST& flat){
+	FlatAST::Index exp = myExp->lower(flat);
+	return flat.add(NodeKind::POST_DEC, line, col, exp);
+}
+
+FlatAST::Index ReadStmtNode::lower(FlatAST& flat){
+	FlatAST::Index exp = myExp->lower(flat);
+	return flat.add(NodeKind::READ, line, col, exp);
+}
+
+FlatAST::Index WriteStmtNode::lower(FlatAST& flat){
+	FlatAST::Index exp = myExp->lower(flat);
+	return flat.add(NodeKind::WRITE, line, col, exp);
+}
+
+FlatAST::Index IfStmtNode::lower(FlatAST& flat){
+	FlatAST::Index cond = myExp->lower(flat);
+	FlatAST::Index block = lowerBlock(flat, myDecls, myStmts);
+	return flat.add(NodeKind::IF, line, col, cond, block);
+}
+
+FlatAST::Index IfElseStmtNode::lower(FlatAST& flat){
+	FlatAST::Index cond = myExp->lower(flat);
+	FlatAST::Index blocks = flat.reserve(2);
+	flat.setExtra(blocks, lowerBlock(flat, myDeclsT, myStmtsT));
+	flat.setExtra(blocks + 1, lowerBlock(flat, myDeclsF, myStmtsF));
+	return flat.add(NodeKind::IF_ELSE, line, col, cond, blocks);
+}
+
+FlatAST::Index WhileStmtNode::lower(FlatAST& flat){
+	FlatAST::Index cond = myExp->lower(flat);
+	FlatAST::Index block = lowerBlock(flat, myDecls, myStmts);
+	return flat.add(NodeKind::WHILE, line, col, cond, block);
+}
+
+FlatAST::Index CallStmtNode::lower(FlatAST& flat){
+	FlatAST::Index call = myCallExp->lower(flat);
+	return flat.add(NodeKind::CALL_STMT, line, col, call);
+}
+
+FlatAST::Index ReturnStmtNode::lower(FlatAST& flat){
+	FlatAST::Index exp = FlatAST::NONE;
+	if (myExp != nullptr){ exp = myExp->lower(flat); }
+	return flat.add(NodeKind::RETURN, line, col, exp);
+}
+
+FlatAST::Index IdNode::lower(FlatAST& flat){
+	return flat.addId(myName, line, col);
+}
+
+FlatAST::Index IntLitNode::lower(FlatAST& flat){
+	return flat.add(NodeKind::INT_LIT, line, col,
+		static_cast<uint32_t>(myInt));
+}
+
+FlatAST::Index StrLitNode::lower(FlatAST& flat){
+	return flat.addStrLit(myString, line, col);
+}
+
+FlatAST::Index TrueNode::lower(FlatAST& flat){
+	return flat.add(NodeKind::TRUE_LIT, line, col);
+}
+
+FlatAST::Index FalseNode::lower(FlatAST& flat){
+	return flat.add(NodeKind::FALSE_LIT, line, col);
+}
+
+FlatAST::Index DotAccessNode::lower(FlatAST& flat){
+	FlatAST::Index exp = myExp->lower(flat);
+	FlatAST::Index id = myId->lower(flat);
+	return flat.add(NodeKind::DOT, line, col, exp, id);
+}
+
+FlatAST::Index AssignNode::lower(FlatAST& flat){
+	FlatAST::Index lhs = myExpLHS->lower(flat);
+	FlatAST::Index rhs = myExpRHS->lower(flat);
+	return flat.add(NodeKind::ASSIGN, line, col, lhs, rhs);
+}
+
+FlatAST::Index CallExpNode::lower(FlatAST& flat){
+	FlatAST::Index id = myId->lower(flat);
+	FlatAST::Index args = myExpList->lower(flat);
+	return flat.add(NodeKind::CALL, line, col, id, args);
+}
+
+FlatAST::Index UnaryMinusNode::lower(FlatAST& flat){
+	FlatAST::Index exp = myExp->lower(flat);
+	return flat.add(NodeKind::NEG, line, col, exp);
+}
+
+FlatAST::Index NotNode::lower(FlatAST& flat){
+	FlatAST::Index exp = myExp->lower(flat);
+	return flat.add(NodeKind::NOT, line, col, exp);
+}
+
+FlatAST::Index BinaryExpNode::lower(FlatAST& flat){
+	FlatAST::Index exp1 = myExp1->lower(flat);
+	FlatAST::Index exp2 = myExp2->lower(flat);
+	return flat.add(flatKind(), line, col, exp1, exp2);
+}
+
+} // End namespace LILC
@@ -0,0 +1,329 @@
+#include "err.hpp"
+#include "lilc_flat_ast.hpp"
+#include "symbol_table.hpp"
+
+namespace LILC{
+
+using Index = FlatAST::Index;
+using NodeKind = FlatAST::NodeKind;
+
+static bool declNameAnalysis(FlatAST& ast, Index decl,
+	SymbolTable * symTab);
+static bool stmtNameAnalysis(FlatAST& ast, Index stmt,
+	SymbolTable * symTab);
+static bool expNameAnalysis(FlatAST& ast, Index exp,
+	SymbolTable * symTab);
+
+static bool blockNameAnalysis(FlatAST& ast, Index block,
+	SymbolTable * symTab)
+{
+	bool result = true;
+	for (Index decl : ast.list(ast.blockDecls(block))){
+		result = declNameAnalysis(ast, decl, symTab) && result;
+	}
+	for (Index stmt : ast.list(ast.blockStmts(block))){
+		result = stmtNameAnalysis(ast, stmt, symTab) && result;
+	}
+	return result;
+}
+
+static bool varDeclNameAnalysis(FlatAST& ast, Index decl,
+	SymbolTable * symTab)
+{
+	Index type = ast.lhs(decl);
+	Name name = ast.getName(ast.rhs(decl));
+	SourcePos ePos = ast.pos(decl);
+
+	if (ast.kind(type) == NodeKind::VOID_TYPE){
+		return Err::badVoid(ePos);
+	}
+	if (symTab->collides(name)){ return Err::multiDecl(ePos); }
+
+	VarSymbol * vSym = VarSymbol::produce(symTab,
+		ast.getTypeString(type));
+	if (vSym == nullptr){ return Err::undefType(ePos); }
+	symTab->place(vSym);
+	ast.setSymbol(ast.rhs(decl), vSym);
+	return symTab->add(name, vSym);
+}
+
+// Formals are bound through their id, for the FuncSymbol to find
+static bool formalNameAnalysis(FlatAST& ast, Index formal,
+	SymbolTable * symTab)
+{
+	Index type = ast.lhs(formal);
+	Index id = ast.rhs(formal);
+	Name name = ast.getName(id);
+	SourcePos ePos = ast.pos(id);
+
+	if (ast.kind(type) == NodeKind::VOID_TYPE){
+		return Err::badVoid(ePos);
+	}
+	if (symTab->collides(name)){ return Err::multiDecl(ePos); }
+
+	VarSymbol * vSym = VarSymbol::produce(symTab,
+		ast.getTypeString(type));
+	ast.setSymbol(id, vSym);
+
+	if (vSym == nullptr){ return Err::undefType(ePos); }
+	return symTab->add(name, vSym);
+}
+
+static bool fnDeclNameAnalysis(FlatAST& ast, Index decl,
+	SymbolTable * symTab)
+{
+	//As for FnDeclNode: the function goes in the enclosing
+	// scope, its formals in the scope of its body
+	ScopeTable * outerScope = symTab->currentScope();
+	symTab->enterScope();
+	symTab->beginFrame();
+
+	Index id = ast.lhs(decl);
+	Index formals = ast.fnFormals(decl);
+	bool unique = true;
+	Name name = ast.getName(id);
+	if (symTab->collides(name)){
+		Err::multiDecl(ast.pos(decl));
+		unique = false;
+	}
+
+	bool argsValid = true;
+	for (Index formal : ast.list(formals)){
+		argsValid = formalNameAnalysis(ast, formal, symTab)
+			&& argsValid;
+	}
+
+	FuncSymbol * entry = nullptr;
+	if (unique && argsValid){
+		VarSymbol * retSymbol = VarSymbol::produce(symTab,
+			ast.getTypeString(ast.fnRetType(decl)));
+		std::list<VarSymbol *> * argsSymbols =
+			new std::list<VarSymbol *>();
+		for (Index formal : ast.list(formals)){
+			argsSymbols->push_back(static_cast<VarSymbol *>(
+				ast.getSymbol(ast.rhs(formal))));
+		}
+
+		entry = new FuncSymbol(argsSymbols, retSymbol,
+			symTab->getTypes());
+		outerScope->add(name, entry);
+		ast.setSymbol(id, entry);
+	}
+
+	bool ok = blockNameAnalysis(ast, ast.fnBody(decl), symTab)
+		&& entry != nullptr;
+	if (entry != nullptr){ entry->setLocalsSize(symTab->endFrame()); }
+	symTab->exitScope();
+	return ok;
+}
+
+/*
+* The fields of a struct, as for DeclListNode::fieldNameAnalysis.
+* Stops (having reported why) at the first bad field.
+*/
+static bool fieldNameAnalysis(FlatAST& ast, Index fields,
+	SymbolTable * symTab, FieldMap * fieldMap)
+{
+	int offset = 0;
+	for (Index decl : ast.list(fields)){
+		SourcePos ePos = ast.pos(decl);
+		Name fName = ast.getName(ast.rhs(decl));
+		std::string fTypeStr = ast.getTypeString(ast.lhs(decl));
+		if (fTypeStr == "void"){
+			return Err::badVoid(ePos);
+		}
+		VarSymbol * fSym = VarSymbol::produce(symTab, fTypeStr);
+		if (fSym == nullptr){
+			return Err::undefType(ePos);
+		}
+		if (fieldMap->find(fName) != fieldMap->end()){
+			return Err::multiDecl(ePos);
+		}
+		fSym->place(Storage::FIELD, offset);
+		offset += fSym->getSize();
+		(*fieldMap)[fName] = fSym;
+	}
+	return true;
+}
+
+static bool structDeclNameAnalysis(FlatAST& ast, Index decl,
+	SymbolTable * symTab)
+{
+	Name typeName = ast.getName(ast.lhs(decl));
+
+	FieldMap * fieldMap = new FieldMap();
+	if (!fieldNameAnalysis(ast, ast.rhs(decl), symTab, fieldMap)){
+		delete fieldMap;
+		return false;
+	}
+
+	StructSymbol * mySym = new StructSymbol(typeName, fieldMap,
+		symTab->getTypes());
+	if (!symTab->add(typeName, mySym)){
+		return Err::multiDecl(ast.pos(decl));
+	}
+	return true;
+}
+
+static bool declNameAnalysis(FlatAST& ast, Index decl,
+	SymbolTable * symTab)
+{
+	switch (ast.kind(decl)){
+		case NodeKind::VAR_DECL:
+			return varDeclNameAnalysis(ast, decl, symTab);
+		case NodeKind::FN_DECL:
+			return fnDeclNameAnalysis(ast, decl, symTab);
+		case NodeKind::STRUCT_DECL:
+			return structDeclNameAnalysis(ast, decl, symTab);
+		default:
+			throw InternalError("nameAnalysis of a non-declaration");
+	}
+}
+
+static bool stmtNameAnalysis(FlatAST& ast, Index stmt,
+	SymbolTable * symTab)
+{
+	switch (ast.kind(stmt)){
+		case NodeKind::ASSIGN_STMT:
+		case NodeKind::POST_INC:
+		case NodeKind::POST_DEC:
+		case NodeKind::READ:
+		case NodeKind::WRITE:
+		case NodeKind::CALL_STMT:
+			return expNameAnalysis(ast, ast.lhs(stmt), symTab);
+		case NodeKind::IF:
+		case NodeKind::WHILE:
+		{
+			bool result = expNameAnalysis(ast, ast.lhs(stmt), symTab);
+			symTab->enterScope();
+			result = blockNameAnalysis(ast, ast.thenBlock(stmt), symTab)
+				&& result;
+			symTab->exitScope();
+			return result;
+		}
+		case NodeKind::IF_ELSE:
+		{
+			//Both branches share one scope, as in IfElseStmtNode
+			bool result = expNameAnalysis(ast, ast.lhs(stmt), symTab);
+			symTab->enterScope();
+			result = blockNameAnalysis(ast, ast.thenBlock(stmt), symTab)
+				&& result;
+			result = blockNameAnalysis(ast, ast.elseBlock(stmt), symTab)
+				&& result;
+			symTab->exitScope();
+			return result;
+		}
+		case NodeKind::RETURN:
+			if (ast.lhs(stmt) == FlatAST::NONE){ return true; }
+			return expNameAnalysis(ast, ast.lhs(stmt), symTab);
+		default:
+			throw InternalError("nameAnalysis of a non-statement");
+	}
+}
+
+/*
+* The struct that the left-hand side of a dot access has as its
+* type, or null (having reported why) if it has none.
+*/
+static StructSymbol * dotNameAnalysis(FlatAST& ast, Index exp,
+	SymbolTable * symTab)
+{
+	if (ast.kind(exp) == NodeKind::ID){
+		if (!expNameAnalysis(ast, exp, symTab)){ return nullptr; }
+		StructSymbol * fieldType =
+			ast.getSymbol(exp)->getCompositeType();
+		if (fieldType == nullptr){
+			Err::badDotLHS(ast.pos(exp));
+		}
+		return fieldType;
+	}
+	if (ast.kind(exp) != NodeKind::DOT){
+		throw runtime_error("INTERNAL: Attempted "
+			"dotNameAnalysis on a non-struct "
+			"expression type");
+	}
+
+	StructSymbol * baseStruct = dotNameAnalysis(ast, ast.lhs(exp), symTab);
+	if (baseStruct == nullptr) { return nullptr; }
+
+	Index id = ast.rhs(exp);
+	VarSymbol * fieldSymbol = baseStruct->getField(ast.getName(id));
+	if (fieldSymbol == nullptr){
+		Err::badDotRHS(ast.pos(id));
+		return nullptr;
+	}
+	StructSymbol * fieldType = fieldSymbol->getCompositeType();
+	if (fieldType == nullptr){
+		Err::badDotLHS(ast.pos(id));
+		return nullptr;
+	}
+	ast.setSymbol(id, fieldSymbol);
+	return fieldType;
+}
+
+static bool expNameAnalysis(FlatAST& ast, Index exp,
+	SymbolTable * symTab)
+{
+	switch (ast.kind(exp)){
+		case NodeKind::ID:
+		{
+			SymbolTableEntry * sym = symTab->lookup(ast.getName(exp));
+			ast.setSymbol(exp, sym);
+			if (sym == nullptr){
+				return Err::undeclaredID(ast.pos(exp));
+			}
+			return true;
+		}
+		case NodeKind::INT_LIT:
+		case NodeKind::STR_LIT:
+		case NodeKind::TRUE_LIT:
+		case NodeKind::FALSE_LIT:
+			return true;
+		case NodeKind::DOT:
+		{
+			StructSymbol * baseSymbol =
+				dotNameAnalysis(ast, ast.lhs(exp), symTab);
+			if (baseSymbol == nullptr){ return false; }
+
+			Index id = ast.rhs(exp);
+			VarSymbol * fieldSymbol =
+				baseSymbol->getField(ast.getName(id));
+			if (fieldSymbol == nullptr) {
+				return Err::badDotRHS(ast.pos(id));
+			}
+			ast.setSymbol(id, fieldSymbol);
+			return true;
+		}
+		case NodeKind::CALL:
+		{
+			bool result = expNameAnalysis(ast, ast.lhs(exp), symTab);
+			for (Index arg : ast.list(ast.rhs(exp))){
+				result = expNameAnalysis(ast, arg, symTab) && result;
+			}
+			return result;
+		}
+		case NodeKind::NEG:
+		case NodeKind::NOT:
+			return expNameAnalysis(ast, ast.lhs(exp), symTab);
+		default:
+		{
+			//Assignments and binary operators
+			bool result1 = expNameAnalysis(ast, ast.lhs(exp), symTab);
+			return expNameAnalysis(ast, ast.rhs(exp), symTab) && result1;
+		}
+	}
+}
+
+bool FlatAST::nameAnalysis(SymbolTable * symTab){
+	symTab->enterScope();
+	bool valid = true;
+	for (Index decl : globals){
+		valid = declNameAnalysis(*this, decl, symTab) && valid;
+	}
+	SymbolTableEntry * temp = symTab->lookup("main");
+	valid = (temp != nullptr) && valid;
+	symTab->exitScope();
+	return valid;
+}
+
+} // End namespace LILC
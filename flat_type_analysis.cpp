@@ -0,0 +1,225 @@
+#include "err.hpp"
+#include "lilc_flat_ast.hpp"
+#include "lilc_types.hpp"
+#include "symbol_table.hpp"
+#include "lilc_parallel.hpp"
+
+namespace LILC{
+
+using Index = FlatAST::Index;
+using NodeKind = FlatAST::NodeKind;
+
+static const Type * computeType(FlatAST& ast, Index exp);
+
+// As ExpNode::expTypeAnalysis, keeping the type for later passes
+static const Type * expTypeAnalysis(FlatAST& ast, Index exp){
+	const Type * type = computeType(ast, exp);
+	ast.setType(exp, type);
+	return type;
+}
+
+static BinOpKind binOpKind(NodeKind kind){
+	switch (kind){
+		case NodeKind::PLUS:
+		case NodeKind::MINUS:
+		case NodeKind::TIMES:
+		case NodeKind::DIVIDE:
+			return BinOpKind::MATH;
+		case NodeKind::AND:
+		case NodeKind::OR:
+			return BinOpKind::LOG;
+		case NodeKind::LESS:
+		case NodeKind::GREATER:
+		case NodeKind::LESS_EQ:
+		case NodeKind::GREATER_EQ:
+			return BinOpKind::REL;
+		default:
+			throw InternalError("Unknown binary operation kind");
+	}
+}
+
+static bool stmtTypeAnalysis(FlatAST& ast, Index stmt,
+	FuncSymbol * fnSym);
+
+static bool stmtListTypeAnalysis(FlatAST& ast, Index list,
+	FuncSymbol * fnSym)
+{
+	bool result = true;
+	for (Index stmt : ast.list(list)){
+		result = stmtTypeAnalysis(ast, stmt, fnSym) && result;
+	}
+	return result;
+}
+
+static bool stmtTypeAnalysis(FlatAST& ast, Index stmt,
+	FuncSymbol * fnSym)
+{
+	Index exp = ast.lhs(stmt);
+	switch (ast.kind(stmt)){
+		case NodeKind::ASSIGN_STMT:
+		case NodeKind::CALL_STMT:
+			return !expTypeAnalysis(ast, exp)->isError();
+		case NodeKind::POST_INC:
+		case NodeKind::POST_DEC:
+			return LilC_Types::checkIncDec(
+				expTypeAnalysis(ast, exp), ast.pos(stmt));
+		case NodeKind::READ:
+			return LilC_Types::checkRead(
+				expTypeAnalysis(ast, exp), ast.pos(exp));
+		case NodeKind::WRITE:
+			return LilC_Types::checkWrite(
+				expTypeAnalysis(ast, exp), ast.pos(exp));
+		case NodeKind::IF:
+		case NodeKind::WHILE:
+		{
+			bool result = LilC_Types::checkCond(
+				expTypeAnalysis(ast, exp), ast.pos(stmt));
+			Index block = ast.thenBlock(stmt);
+			return stmtListTypeAnalysis(ast, ast.blockStmts(block),
+				fnSym) && result;
+		}
+		case NodeKind::IF_ELSE:
+		{
+			bool result = LilC_Types::checkCond(
+				expTypeAnalysis(ast, exp), ast.pos(stmt));
+			Index thenBlock = ast.thenBlock(stmt);
+			Index elseBlock = ast.elseBlock(stmt);
+			result = stmtListTypeAnalysis(ast,
+				ast.blockStmts(thenBlock), fnSym) && result;
+			result = stmtListTypeAnalysis(ast,
+				ast.blockStmts(elseBlock), fnSym) && result;
+			return result;
+		}
+		case NodeKind::RETURN:
+		{
+			const Type * retType = fnSym->getRetSymbol()->getType();
+			if (exp == FlatAST::NONE){
+				return LilC_Types::checkReturn(retType);
+			}
+			return LilC_Types::checkReturn(retType,
+				expTypeAnalysis(ast, exp), ast.pos(exp));
+		}
+		default:
+			throw InternalError("typeAnalysis of a non-statement");
+	}
+}
+
+static const Type * callTypeAnalysis(FlatAST& ast, Index call){
+	Index id = ast.lhs(call);
+	SourcePos errPos = ast.pos(id);
+	SymbolTableEntry * rawSym = ast.getSymbol(id);
+	if (rawSym->getKind() != Kind::FUNC){
+		TypeErr::callNonFunc(errPos);
+		return Type::error();
+	}
+	FuncSymbol * fnSym = static_cast<FuncSymbol *>(rawSym);
+	const Type * retType = fnSym->getRetSymbol()->getType();
+
+	std::list<VarSymbol *> * formals = fnSym->getFormalSymbols();
+	FlatAST::List args = ast.list(ast.rhs(call));
+	if (args.size() != formals->size()){
+		TypeErr::badNumArgs(errPos);
+		return Type::error();
+	}
+	//Walk both formal and actual simultaneously
+	auto formalItr = formals->begin();
+	for (Index arg : args){
+		const Type * actualType = expTypeAnalysis(ast, arg);
+		const Type * formalType = (*formalItr)->getType();
+		if (actualType->isError()){
+			return actualType;
+		}
+		if (formalType->isError()){
+			return formalType;
+		}
+		if (!LilC_Types::checkArg(actualType, formalType,
+			ast.pos(arg)))
+		{
+			retType = Type::error();
+		}
+		formalItr++;
+	}
+	return retType;
+}
+
+static const Type * computeType(FlatAST& ast, Index exp){
+	NodeKind kind = ast.kind(exp);
+	switch (kind){
+		case NodeKind::ID:
+		{
+			SymbolTableEntry * mySym = ast.getSymbol(exp);
+			if (mySym == nullptr){
+				throw InternalError("Id without a symbol");
+			}
+			return mySym->getType();
+		}
+		case NodeKind::INT_LIT:
+			return Type::intType();
+		case NodeKind::STR_LIT:
+			return Type::stringType();
+		case NodeKind::TRUE_LIT:
+		case NodeKind::FALSE_LIT:
+			return Type::boolType();
+		case NodeKind::DOT:
+			return ast.getSymbol(ast.rhs(exp))->getType();
+		case NodeKind::CALL:
+			return callTypeAnalysis(ast, exp);
+		case NodeKind::NEG:
+			return LilC_Types::unaryType(BinOpKind::MATH,
+				expTypeAnalysis(ast, ast.lhs(exp)),
+				ast.pos(ast.lhs(exp)));
+		case NodeKind::NOT:
+			return LilC_Types::unaryType(BinOpKind::LOG,
+				expTypeAnalysis(ast, ast.lhs(exp)),
+				ast.pos(ast.lhs(exp)));
+		default:
+			break;
+	}
+
+	//Assignments and binary operators
+	Index exp1 = ast.lhs(exp);
+	Index exp2 = ast.rhs(exp);
+	const Type * type1 = expTypeAnalysis(ast, exp1);
+	const Type * type2 = expTypeAnalysis(ast, exp2);
+	switch (kind){
+		case NodeKind::ASSIGN:
+			return LilC_Types::assignType(type1, type2,
+				ast.pos(exp1));
+		case NodeKind::EQUALS:
+			return LilC_Types::equalityType(type1, type2,
+				ast.pos(exp1));
+		case NodeKind::NOT_EQUALS:
+			return LilC_Types::equalityType(type1, type2,
+				ast.pos(exp));
+		default:
+			return LilC_Types::binaryType(binOpKind(kind),
+				type1, type2,
+				ast.pos(exp1), ast.pos(exp2));
+	}
+}
+
+/*
+* Only function bodies can have type errors, as for
+* DeclListNode::typeAnalysis; the declarations in them can't.
+*/
+static bool declTypeAnalysis(FlatAST& ast, Index decl){
+	if (ast.kind(decl) != NodeKind::FN_DECL){ return true; }
+	SymbolTableEntry * idEntry = ast.getSymbol(ast.lhs(decl));
+	if (idEntry->getKind() != Kind::FUNC){
+		throw InternalError("FnDeclNode has a "
+			"non-function kind id symbol");
+	}
+	FuncSymbol * fnSymbol = static_cast<FuncSymbol *>(idEntry);
+	return stmtListTypeAnalysis(ast,
+		ast.blockStmts(ast.fnBody(decl)), fnSymbol);
+}
+
+bool FlatAST::typeAnalysis(unsigned jobs){
+	//Sized up front, since the threads fill in their own parts
+	types.assign(kinds.size(), nullptr);
+	return parallelChecks(globals.size(), jobs, [this](size_t i){
+		return declTypeAnalysis(*this, globals[i]);
+	});
+}
+
+} // End namespace LILC
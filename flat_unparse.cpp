@@ -0,0 +1,235 @@
+#include "err.hpp"
+#include "lilc_flat_ast.hpp"
+#include "symbol_table.hpp"
+
+namespace LILC{
+
+using Index = FlatAST::Index;
+using NodeKind = FlatAST::NodeKind;
+
+static void doIndent(std::ostream& out, int indent){
+	for (int k = 0 ; k < indent; k++){ out << " "; }
+}
+
+static const char * opSpelling(NodeKind kind){
+	switch (kind){
+		case NodeKind::PLUS: return "+";
+		case NodeKind::MINUS: return "-";
+		case NodeKind::TIMES: return "*";
+		case NodeKind::DIVIDE: return "/";
+		case NodeKind::AND: return "&&";
+		case NodeKind::OR: return "||";
+		case NodeKind::EQUALS: return "==";
+		case NodeKind::NOT_EQUALS: return "!=";
+		case NodeKind::LESS: return "<";
+		case NodeKind::GREATER: return ">";
+		case NodeKind::LESS_EQ: return "<=";
+		case NodeKind::GREATER_EQ: return ">=";
+		default:
+			throw InternalError("unparse of an unknown expression");
+	}
+}
+
+static void typeUnparse(const FlatAST& ast, Index type,
+	std::ostream& out)
+{
+	if (ast.kind(type) == NodeKind::STRUCT_TYPE){
+		out << "struct ";
+	}
+	out << ast.getTypeString(type);
+}
+
+// Expressions are always unparsed at indent 0
+static void expUnparse(const FlatAST& ast, Index exp, std::ostream& out){
+	NodeKind kind = ast.kind(exp);
+	switch (kind){
+		case NodeKind::ID:
+		{
+			out << ast.getName(exp).str();
+			SymbolTableEntry * sym = ast.getSymbol(exp);
+			if (sym == nullptr){
+				throw std::runtime_error("IdNode has no symbol");
+			}
+			out << "(" << sym->getTypeString() << ")";
+			return;
+		}
+		case NodeKind::INT_LIT:
+			out << ast.getInt(exp);
+			return;
+		case NodeKind::STR_LIT:
+		{
+			TokenText text = ast.getText(exp);
+			out.write(text.data, static_cast<std::streamsize>(text.size));
+			return;
+		}
+		case NodeKind::TRUE_LIT:
+			out << "true";
+			return;
+		case NodeKind::FALSE_LIT:
+			out << "false";
+			return;
+		case NodeKind::DOT:
+			expUnparse(ast, ast.lhs(exp), out);
+			out << ".";
+			expUnparse(ast, ast.rhs(exp), out);
+			return;
+		case NodeKind::ASSIGN:
+			expUnparse(ast, ast.lhs(exp), out);
+			out << " = ";
+			expUnparse(ast, ast.rhs(exp), out);
+			return;
+		case NodeKind::CALL:
+		{
+			expUnparse(ast, ast.lhs(exp), out);
+			out << "(";
+			bool first = true;
+			for (Index arg : ast.list(ast.rhs(exp))){
+				if (first) { first = false; }
+				else { out << ","; }
+				expUnparse(ast, arg, out);
+			}
+			out << ")";
+			return;
+		}
+		case NodeKind::NEG:
+		case NodeKind::NOT:
+			out << "(" << (kind == NodeKind::NEG ? "-" : "!");
+			expUnparse(ast, ast.lhs(exp), out);
+			out << ")";
+			return;
+		default:
+			out << "(";
+			expUnparse(ast, ast.lhs(exp), out);
+			out << opSpelling(kind);
+			expUnparse(ast, ast.rhs(exp), out);
+			out << ")";
+			return;
+	}
+}
+
+static void declUnparse(const FlatAST& ast, Index decl,
+	std::ostream& out, int indent);
+static void stmtUnparse(const FlatAST& ast, Index stmt,
+	std::ostream& out, int indent);
+
+static void blockUnparse(const FlatAST& ast, Index block,
+	std::ostream& out, int indent)
+{
+	for (Index decl : ast.list(ast.blockDecls(block))){
+		declUnparse(ast, decl, out, indent);
+	}
+	for (Index stmt : ast.list(ast.blockStmts(block))){
+		stmtUnparse(ast, stmt, out, indent);
+	}
+}
+
+static void declUnparse(const FlatAST& ast, Index decl,
+	std::ostream& out, int indent)
+{
+	doIndent(out, indent);
+	switch (ast.kind(decl)){
+		case NodeKind::VAR_DECL:
+			typeUnparse(ast, ast.lhs(decl), out);
+			out << " " << ast.getName(ast.rhs(decl)).str() << ";\n";
+			return;
+		case NodeKind::FN_DECL:
+		{
+			typeUnparse(ast, ast.fnRetType(decl), out);
+			out << " " << ast.getName(ast.lhs(decl)).str() << "(";
+			bool first = true;
+			for (Index formal : ast.list(ast.fnFormals(decl))){
+				if (first){ first = false; }
+				else { out << ", "; }
+				typeUnparse(ast, ast.lhs(formal), out);
+				out << " " << ast.getName(ast.rhs(formal)).str();
+			}
+			out << ")";
+			out << "\n{\n";
+			blockUnparse(ast, ast.fnBody(decl), out, 4);
+			out << "}\n";
+			return;
+		}
+		case NodeKind::STRUCT_DECL:
+			out << "struct " << ast.getName(ast.lhs(decl)).str();
+			out << "\n{\n";
+			for (Index field : ast.list(ast.rhs(decl))){
+				declUnparse(ast, field, out, indent + 4);
+			}
+			out << "};\n";
+			return;
+		default:
+			throw InternalError("unparse of an unknown declaration");
+	}
+}
+
+static void stmtUnparse(const FlatAST& ast, Index stmt,
+	std::ostream& out, int indent)
+{
+	Index exp = ast.lhs(stmt);
+	doIndent(out, indent);
+	switch (ast.kind(stmt)){
+		case NodeKind::ASSIGN_STMT:
+		case NodeKind::CALL_STMT:
+			expUnparse(ast, exp, out);
+			out << ";\n";
+			return;
+		case NodeKind::POST_INC:
+			expUnparse(ast, exp, out);
+			out << "++;\n";
+			return;
+		case NodeKind::POST_DEC:
+			expUnparse(ast, exp, out);
+			out << "--;\n";
+			return;
+		case NodeKind::READ:
+			out << "output >> ";
+			expUnparse(ast, exp, out);
+			out << ";\n";
+			return;
+		case NodeKind::WRITE:
+			out << "input << ";
+			expUnparse(ast, exp, out);
+			out << ";\n";
+			return;
+		case NodeKind::IF:
+		case NodeKind::IF_ELSE:
+			out << "if(";
+			expUnparse(ast, exp, out);
+			out << ") {\n";
+			blockUnparse(ast, ast.thenBlock(stmt), out, indent + 4);
+			doIndent(out, indent);
+			out << "}\n";
+			if (ast.kind(stmt) == NodeKind::IF){ return; }
+			doIndent(out, indent);
+			out << "else {\n";
+			blockUnparse(ast, ast.elseBlock(stmt), out, indent + 4);
+			doIndent(out, indent);
+			out << "}\n";
+			return;
+		case NodeKind::WHILE:
+			out << "while(";
+			expUnparse(ast, exp, out);
+			out << ") {\n";
+			blockUnparse(ast, ast.thenBlock(stmt), out, indent + 4);
+			doIndent(out, indent);
+			out << "}\n";
+			return;
+		case NodeKind::RETURN:
+			out << "return ";
+			if (exp != FlatAST::NONE){
+				expUnparse(ast, exp, out);
+			}
+			out << ";\n";
+			return;
+		default:
+			throw InternalError("unparse of an unknown statement");
+	}
+}
+
+void FlatAST::unparse(std::ostream& out, int indent){
+	for (Index decl : globals){
+		declUnparse(*this, decl, out, indent);
+	}
+}
+
+} // End namespace LILC
@@ -1,19 +1,20 @@
 %skeleton "lalr1.cc"
-%require  "3.0"
+%require  "3.6"
 %debug
 %defines
 %define api.namespace {LILC}
-%define parser_class_name {LilC_Parser}
+%define api.parser.class {LilC_Parser}
 %output "lilc_parser.cc"
+/* The token aliases below double as the spelling used by
+ * LilC_Compiler::scan, which reads them back out of yytname */
 %token-table
 
 %code requires{
-   #include <list>
    #include "tokens.hpp"
    #include "ast.hpp"
    namespace LILC {
       class LilC_Compiler;
-      class LilC_Scanner;
+      class TokenSource;
    }
 
 // The following definitions is missing when %locations isn't used
@@ -27,7 +28,7 @@
 
 }
 
-%parse-param { LilC_Scanner  &scanner  }
+%parse-param { TokenSource   &scanner  }
 %parse-param { LilC_Compiler &compiler }
 
 %code{
@@ -38,112 +39,125 @@
    /* include for interoperation between scanner/parser */
    #include "lilc_compiler.hpp"
 
-#undef yylex
-#define yylex scanner.yylex
+namespace LILC{
+   /*
+   * Pull the next token from scanner and store it in lval with
+   * the type declared for its tag below; the variant insists on
+   * the exact type, so the three tokens with payloads get theirs.
+   */
+   static int nextToken(TokenSource& scanner,
+      LilC_Parser::value_type * lval)
+   {
+      using TokenTag = LilC_Parser::token;
+      Token * tok = nullptr;
+      int tag = scanner.yylex(&tok);
+      switch (tag){
+      case TokenTag::END:
+         break;
+      case TokenTag::ID:
+         lval->emplace<IDToken *>(static_cast<IDToken *>(tok));
+         break;
+      case TokenTag::INTLITERAL:
+         lval->emplace<IntLitToken *>(static_cast<IntLitToken *>(tok));
+         break;
+      case TokenTag::STRINGLITERAL:
+         lval->emplace<StringLitToken *>(
+            static_cast<StringLitToken *>(tok));
+         break;
+      default:
+         lval->emplace<Token *>(tok);
+         break;
+      }
+      return tag;
+   }
 }
 
-/*%define api.value.type variant*/
-%union {
-
-LILC::IntLitToken * intTokenValue;
-LILC::StringLitToken * strTokenValue;
-LILC::IDToken * idTokenValue;
-LILC::Token * tokenValue;
-LILC::ASTNode * astNode;
-LILC::ProgramNode * programNode;
-std::list<DeclNode *> * declList;
-std::list<FormalDeclNode * > * formalsList;
-LILC::DeclNode * declNode;
-LILC::FnDeclNode * fnDecl;
-LILC::FormalDeclNode * formalDecl;
-LILC::StructDeclNode * structDeclNode;
-LILC::FormalsListNode * formals;
-LILC::FnBodyNode * fnBody;
-std::list<StmtNode *> * stmtList;
-std::list<ExpNode *> * expList;
-LILC::TypeNode * typeNode;
-LILC::StmtNode * stmtNode;
-LILC::ExpNode * exp;
-LILC::IdNode * idNode;
-LILC::AssignNode * assignNode;
-LILC::CallExpNode * callNode;
-
-	/*LILC::Token * token;*/
+#undef yylex
+#define yylex(lval) LILC::nextToken(scanner, lval)
 }
 
+/*
+* Semantic values are a variant: AST nodes are arena pointers, and
+* child lists are ASTList values that are moved from one reduction
+* to the next (and finally into their list node) rather than
+* copied or heap-allocated. Tokens are pointers into the scanner's
+* token arena.
+*/
+%define api.value.type variant
+
 %define parse.assert
 
 %token                  END    0     "end of file"
 %token                  NEWLINE "newline"
-%token <tokenValue>     CHAR
-%token <tokenValue>     BOOL
-%token <tokenValue>     INT
-%token <tokenValue>     VOID
-%token <tokenValue>     TRUE
-%token <tokenValue>     FALSE
-%token <tokenValue>     STRUCT
-%token <tokenValue>     INPUT
-%token <tokenValue>     OUTPUT
-%token <tokenValue>     IF
-%token <tokenValue>     ELSE
-%token <tokenValue>     WHILE
-%token <tokenValue>     RETURN
-%token <idTokenValue>   ID
-%token <intTokenValue>  INTLITERAL
-%token <strTokenValue>  STRINGLITERAL
-%token <tokenValue>     LCURLY
-%token <tokenValue>     RCURLY
-%token <tokenValue>     LPAREN
-%token <tokenValue>     RPAREN
-%token <tokenValue>     SEMICOLON
-%token <tokenValue>     COMMA
-%token <tokenValue>     DOT
-%token <tokenValue>     WRITE
-%token <tokenValue>     READ
-%token <tokenValue>     PLUSPLUS
-%token <tokenValue>     MINUSMINUS
-%token <tokenValue>     PLUS
-%token <tokenValue>     MINUS
-%token <tokenValue>     TIMES
-%token <tokenValue>     DIVIDE
-%token <tokenValue>     NOT
-%token <tokenValue>     AND
-%token <tokenValue>     OR
-%token <tokenValue>     EQUALS
-%token <tokenValue>     NOTEQUALS
-%token <tokenValue>     LESS
-%token <tokenValue>     GREATER
-%token <tokenValue>     LESSEQ
-%token <tokenValue>     GREATEREQ
-%token <tokenValue>     ASSIGN
+%token <Token *>        CHAR
+%token <Token *>        BOOL        "bool"
+%token <Token *>        INT         "int"
+%token <Token *>        VOID        "void"
+%token <Token *>        TRUE        "true"
+%token <Token *>        FALSE       "false"
+%token <Token *>        STRUCT      "struct"
+%token <Token *>        INPUT       "input"
+%token <Token *>        OUTPUT      "output"
+%token <Token *>        IF          "if"
+%token <Token *>        ELSE        "else"
+%token <Token *>        WHILE       "while"
+%token <Token *>        RETURN      "return"
+%token <IDToken *>      ID
+%token <IntLitToken *>  INTLITERAL
+%token <StringLitToken *> STRINGLITERAL
+%token <Token *>        LCURLY      "{"
+%token <Token *>        RCURLY      "}"
+%token <Token *>        LPAREN      "("
+%token <Token *>        RPAREN      ")"
+%token <Token *>        SEMICOLON   ";"
+%token <Token *>        COMMA       ","
+%token <Token *>        DOT         "."
+%token <Token *>        WRITE       "<<"
+%token <Token *>        READ        ">>"
+%token <Token *>        PLUSPLUS    "++"
+%token <Token *>        MINUSMINUS  "--"
+%token <Token *>        PLUS        "+"
+%token <Token *>        MINUS       "-"
+%token <Token *>        TIMES       "*"
+%token <Token *>        DIVIDE      "/"
+%token <Token *>        NOT         "!"
+%token <Token *>        AND         "&&"
+%token <Token *>        OR          "||"
+%token <Token *>        EQUALS      "=="
+%token <Token *>        NOTEQUALS   "!="
+%token <Token *>        LESS        "<"
+%token <Token *>        GREATER     ">"
+%token <Token *>        LESSEQ      "<="
+%token <Token *>        GREATEREQ   ">="
+%token <Token *>        ASSIGN      "="
 
 /* Nonterminals
 *  NOTE: You will need to add more nonterminals
 *  to this list as you add productions to the grammar
 *  below.
 */
-%type <programNode> program
-%type <declList> declList
-%type <declNode> decl
-%type <declNode> varDecl
-%type <typeNode> type
-%type <idNode> id
-%type <declList> structBody
-%type <structDeclNode> structDecl
-%type <formals> formals
-%type <declList> varDeclList
-%type <fnDecl> fnDecl
-%type <fnBody> fnBody
-%type <stmtList> stmtList
-%type <formalsList> formalsList
-%type <formalDecl> formalDecl
-%type <stmtNode> stmt
-%type <exp> exp
-%type <callNode> fncall
-%type <assignNode> assignExp
-%type <exp> term
-%type <exp> loc
-%type <expList> actualList
+%type <ProgramNode *> program
+%type <ASTList<DeclNode *>> declList
+%type <DeclNode *> decl
+%type <DeclNode *> varDecl
+%type <TypeNode *> type
+%type <IdNode *> id
+%type <ASTList<DeclNode *>> structBody
+%type <StructDeclNode *> structDecl
+%type <FormalsListNode *> formals
+%type <ASTList<DeclNode *>> varDeclList
+%type <FnDeclNode *> fnDecl
+%type <FnBodyNode *> fnBody
+%type <ASTList<StmtNode *>> stmtList
+%type <ASTList<FormalDeclNode *>> formalsList
+%type <FormalDeclNode *> formalDecl
+%type <StmtNode *> stmt
+%type <ExpNode *> exp
+%type <CallExpNode *> fncall
+%type <AssignNode *> assignExp
+%type <ExpNode *> term
+%type <ExpNode *> loc
+%type <ASTList<ExpNode *>> actualList
 
 /* NOTE: Make sure to add precedence and associativity
  * declarations
@@ -160,18 +174,19 @@ LILC::CallExpNode * callNode;
 
 program : declList 
           {
-          $$ = new ProgramNode(new DeclListNode($1));
+          $$ = new (compiler.nodeArena()) ProgramNode(
+                   new (compiler.nodeArena()) DeclListNode(std::move($1)));
           compiler.setASTRoot($$);
           }
 
 declList : declList decl 
            {
-           $1->push_back($2);
-           $$ = $1;
+           $$ = std::move($1);
+           compiler.addGlobal($$, $2);
            }
          | /* epsilon */ 
            {
-           $$ = new std::list<DeclNode *>();
+           $$ = compiler.newList<DeclNode *>();
            }
 
 decl : varDecl { $$ = $1; }
@@ -181,198 +196,204 @@ decl : varDecl { $$ = $1; }
 
 varDecl : type id SEMICOLON 
           {
-          $$ = new VarDeclNode($1, $2, VarDeclNode::NOT_STRUCT);
+          $$ = new (compiler.nodeArena()) VarDeclNode($1, $2, VarDeclNode::NOT_STRUCT);
           }
         | STRUCT id id SEMICOLON 
           {
-          $$ = new VarDeclNode(
-		new StructNode($2, $1->line, $1->column), $3, 0);
+          $$ = new (compiler.nodeArena()) VarDeclNode(
+		new (compiler.nodeArena()) StructNode($2, $1->line, $1->column), $3, 0);
           }
 
 varDeclList : /* epsilon */ 
               {
-              $$ = new std::list<DeclNode *>();
+              $$ = compiler.newList<DeclNode *>();
               }
             | varDeclList varDecl 
               {
-              $1->push_back($2);
-              $$ = $1;
+              $$ = std::move($1);
+              $$.push_back($2);
               }
 
 fnDecl : type id formals fnBody 
          {
-         $$ = new FnDeclNode($1, $2, $3, $4);
+         $$ = new (compiler.nodeArena()) FnDeclNode($1, $2, $3, $4);
          }
 
 structDecl : STRUCT id LCURLY structBody RCURLY SEMICOLON 
              {
-             $$ = new StructDeclNode($1->line, $1->column,
-                         $2, new DeclListNode($4)) ;
+             $$ = new (compiler.nodeArena()) StructDeclNode($1->line, $1->column,
+                         $2, new (compiler.nodeArena()) DeclListNode(std::move($4))) ;
              }
 
 structBody : structBody varDecl 
              {
-             $1->push_back($2);
-             $$ = $1;
+             $$ = std::move($1);
+             $$.push_back($2);
              }
 
 structBody : varDecl 
              {
-             std::list<DeclNode *> * list = new std::list<DeclNode *>;
-             list->push_back($1);
-             $$ = list;
+             $$ = compiler.newList<DeclNode *>();
+             $$.push_back($1);
              }
 
 formals : LPAREN RPAREN 
           {
-          $$ = new FormalsListNode(new std::list<FormalDeclNode *>()); 
+          $$ = new (compiler.nodeArena()) FormalsListNode(
+                   compiler.newList<FormalDeclNode *>());
           }
 
 formals : LPAREN formalsList RPAREN 
           {
-          $$ = new FormalsListNode($2); 
+          $$ = new (compiler.nodeArena()) FormalsListNode(std::move($2)); 
           }
 
 formalsList : formalDecl 
               {
-              std::list<FormalDeclNode *> * list = new std::list<FormalDeclNode *>();
-              list->push_back($1);
-              $$ = list;
+              $$ = compiler.newList<FormalDeclNode *>();
+              $$.push_back($1);
               }
-            | formalDecl COMMA formalsList 
+            | formalsList COMMA formalDecl 
               {
-              $3->push_front($1);
-              $$ = $3;
+              $$ = std::move($1);
+              $$.push_back($3);
               }
 
 fnBody : LCURLY varDeclList stmtList RCURLY {
-         $$ = new FnBodyNode($1->line, $1->column, 
-                  new DeclListNode($2), new StmtListNode($3));
+         $$ = new (compiler.nodeArena()) FnBodyNode($1->line, $1->column, 
+                  new (compiler.nodeArena()) DeclListNode(std::move($2)),
+                  new (compiler.nodeArena()) StmtListNode(std::move($3)));
        }
 
 formalDecl : type id 
              {
-             $$ = new FormalDeclNode($1, $2);
+             $$ = new (compiler.nodeArena()) FormalDeclNode($1, $2);
              }
 
 stmtList : /* epsilon */ 
            { 
-           $$ = new std::list<StmtNode *>();}
+           $$ = compiler.newList<StmtNode *>();}
          | stmtList stmt 
            { 
-           $1->push_back($2);
-           $$ = $1;
+           $$ = std::move($1);
+           $$.push_back($2);
            }
 
-stmt : assignExp SEMICOLON { $$ = new AssignStmtNode($1); }
-     | loc PLUSPLUS SEMICOLON { $$ = new PostIncStmtNode($1); }
-     | loc MINUSMINUS SEMICOLON { $$ = new PostDecStmtNode($1); }
+stmt : assignExp SEMICOLON { $$ = new (compiler.nodeArena()) AssignStmtNode($1); }
+     | loc PLUSPLUS SEMICOLON { $$ = new (compiler.nodeArena()) PostIncStmtNode($1); }
+     | loc MINUSMINUS SEMICOLON { $$ = new (compiler.nodeArena()) PostDecStmtNode($1); }
      | INPUT READ loc SEMICOLON 
        { 
-       $$ = new ReadStmtNode($3); 
+       $$ = new (compiler.nodeArena()) ReadStmtNode($3); 
        }
      | OUTPUT WRITE exp SEMICOLON 
        { 
-       $$ = new WriteStmtNode($3); 
+       $$ = new (compiler.nodeArena()) WriteStmtNode($3); 
        }
      | IF LPAREN exp RPAREN LCURLY varDeclList stmtList RCURLY 
         { 
-        $$ = new IfStmtNode($1->line, $1->column, $3, 
-                     new DeclListNode($6), new StmtListNode($7));
+        $$ = new (compiler.nodeArena()) IfStmtNode($1->line, $1->column, $3, 
+                     new (compiler.nodeArena()) DeclListNode(std::move($6)),
+                     new (compiler.nodeArena()) StmtListNode(std::move($7)));
         }
      | IF LPAREN exp RPAREN LCURLY varDeclList stmtList RCURLY ELSE LCURLY varDeclList stmtList RCURLY
         { 
-        $$ = new IfElseStmtNode(
+        $$ = new (compiler.nodeArena()) IfElseStmtNode(
                 $3, 
-                new DeclListNode($6), 
-                new StmtListNode($7), 
-                new DeclListNode($11), 
-                new StmtListNode($12)); 
+                new (compiler.nodeArena()) DeclListNode(std::move($6)), 
+                new (compiler.nodeArena()) StmtListNode(std::move($7)), 
+                new (compiler.nodeArena()) DeclListNode(std::move($11)), 
+                new (compiler.nodeArena()) StmtListNode(std::move($12))); 
         }
      | WHILE LPAREN exp RPAREN LCURLY varDeclList stmtList RCURLY
        { 
-        $$ = new WhileStmtNode($1->line, $1->column, 
-                 $3, new DeclListNode($6), new StmtListNode($7)); 
+        $$ = new (compiler.nodeArena()) WhileStmtNode($1->line, $1->column, 
+                 $3, new (compiler.nodeArena()) DeclListNode(std::move($6)),
+                 new (compiler.nodeArena()) StmtListNode(std::move($7)));
        }
      | RETURN exp SEMICOLON 
-	{ $$ = new ReturnStmtNode($1->line, $1->column, $2); }
+	{ $$ = new (compiler.nodeArena()) ReturnStmtNode($1->line, $1->column, $2); }
      | RETURN SEMICOLON 
-       { $$ = new ReturnStmtNode($1->line, $1->column, nullptr); }
-     | fncall SEMICOLON { $$ = new CallStmtNode($1); }
+       { $$ = new (compiler.nodeArena()) ReturnStmtNode($1->line, $1->column, nullptr); }
+     | fncall SEMICOLON { $$ = new (compiler.nodeArena()) CallStmtNode($1); }
 
 
 assignExp : loc ASSIGN exp 
-    { $$ = new AssignNode($2->line, $2->column, $1, $3); }
+    { $$ = new (compiler.nodeArena()) AssignNode($2->line, $2->column, $1, $3); }
 
 exp : assignExp { $$ = $1;}
     | exp PLUS exp 
-      { $$ = new PlusNode($2->line, $2->column, $1, $3); }
+      { $$ = new (compiler.nodeArena()) PlusNode($2->line, $2->column, $1, $3); }
     | exp MINUS exp 
-      { $$ = new MinusNode($2->line, $2->column, $1, $3); }
+      { $$ = new (compiler.nodeArena()) MinusNode($2->line, $2->column, $1, $3); }
     | exp TIMES exp 
-      { $$ = new TimesNode($2->line, $2->column, $1, $3); }
+      { $$ = new (compiler.nodeArena()) TimesNode($2->line, $2->column, $1, $3); }
     | exp DIVIDE exp 
-      { $$ = new DivideNode($2->line, $2->column, $1, $3); }
+      { $$ = new (compiler.nodeArena()) DivideNode($2->line, $2->column, $1, $3); }
     | NOT exp 
-      { $$ = new NotNode($1->line, $1->column, $2); }
+      { $$ = new (compiler.nodeArena()) NotNode($1->line, $1->column, $2); }
     | exp AND exp 
-      { $$ = new AndNode($2->line, $2->column, $1, $3); }
+      { $$ = new (compiler.nodeArena()) AndNode($2->line, $2->column, $1, $3); }
     | exp OR exp 
-      { $$ = new OrNode($2->line, $2->column, $1, $3); }
+      { $$ = new (compiler.nodeArena()) OrNode($2->line, $2->column, $1, $3); }
     | exp EQUALS exp 
-      { $$ = new EqualsNode($2->line, $2->column, $1, $3); }
+      { $$ = new (compiler.nodeArena()) EqualsNode($2->line, $2->column, $1, $3); }
     | exp NOTEQUALS exp 
-      { $$ = new NotEqualsNode($2->line, $2->column, $1, $3); }
+      { $$ = new (compiler.nodeArena()) NotEqualsNode($2->line, $2->column, $1, $3); }
     | exp LESS exp 
-      { $$ = new LessNode($2->line, $2->column, $1, $3); }
+      { $$ = new (compiler.nodeArena()) LessNode($2->line, $2->column, $1, $3); }
     | exp GREATER exp 
-      { $$ = new GreaterNode($2->line, $2->column, $1, $3); }
+      { $$ = new (compiler.nodeArena()) GreaterNode($2->line, $2->column, $1, $3); }
     | exp LESSEQ exp 
-      { $$ = new LessEqNode($2->line, $2->column, $1, $3); }
+      { $$ = new (compiler.nodeArena()) LessEqNode($2->line, $2->column, $1, $3); }
     | exp GREATEREQ exp 
-      { $$ = new GreaterEqNode($2->line, $2->column, $1, $3); }
-    | MINUS term { $$ = new UnaryMinusNode($2); }
+      { $$ = new (compiler.nodeArena()) GreaterEqNode($2->line, $2->column, $1, $3); }
+    | MINUS term 
+      { $$ = new (compiler.nodeArena()) UnaryMinusNode($1->line, $1->column, $2); }
     | term { $$ = $1; }
 
 term : loc { $$ = $1; }
-     | INTLITERAL { $$ = new IntLitNode($1); }
-     | STRINGLITERAL { $$ = new StrLitNode($1); }
-     | TRUE { $$ = new TrueNode($1->line, $1->column); }
-     | FALSE { $$ = new FalseNode($1->line, $1->column); }
+     | INTLITERAL { $$ = new (compiler.nodeArena()) IntLitNode($1); }
+     | STRINGLITERAL
+       { $$ = new (compiler.nodeArena()) StrLitNode($1, compiler.nodeArena()); }
+     | TRUE { $$ = new (compiler.nodeArena()) TrueNode($1->line, $1->column); }
+     | FALSE { $$ = new (compiler.nodeArena()) FalseNode($1->line, $1->column); }
      | LPAREN exp RPAREN { $$ = $2; }
      | fncall { $$ = $1; }
 
 fncall : id LPAREN RPAREN 
         { 
-        $$ = new CallExpNode($1, new ExpListNode(new std::list<ExpNode *>()));
+        $$ = new (compiler.nodeArena()) CallExpNode($1,
+                 new (compiler.nodeArena()) ExpListNode(
+                 compiler.newList<ExpNode *>()));
         }
         | id LPAREN actualList RPAREN 
         { 
-        $$ = new CallExpNode($1, new ExpListNode($3)); 
+        $$ = new (compiler.nodeArena()) CallExpNode($1,
+                 new (compiler.nodeArena()) ExpListNode(std::move($3)));
         }
 
 actualList : exp 
         { 
-        std::list<ExpNode *> * list = new std::list<ExpNode *>();
-        list->push_back($1);
-        $$ = list;
+        $$ = compiler.newList<ExpNode *>();
+        $$.push_back($1);
         }
         | actualList COMMA exp 
         {
-        $1->push_back($3);
-        $$ = $1;
+        $$ = std::move($1);
+        $$.push_back($3);
         }
 
-type : INT { $$ = new IntNode($1->line, $1->column); }
-     | BOOL { $$ = new BoolNode($1->line, $1->column); }
-     | VOID { $$ = new VoidNode($1->line, $1->column); }
+type : INT { $$ = new (compiler.nodeArena()) IntNode($1->line, $1->column); }
+     | BOOL { $$ = new (compiler.nodeArena()) BoolNode($1->line, $1->column); }
+     | VOID { $$ = new (compiler.nodeArena()) VoidNode($1->line, $1->column); }
 
 
 loc : id { $$ = $1; }
     | loc DOT id 
-      { $$ = new DotAccessNode($1, $3); }
+      { $$ = new (compiler.nodeArena()) DotAccessNode($1, $3); }
 
-id : ID { $$ = new IdNode($1); }
+id : ID { $$ = new (compiler.nodeArena()) IdNode($1); }
 
 %%
 void
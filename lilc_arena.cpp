@@ -0,0 +1,61 @@
+#include <cstdlib>
+#include <cstring>
+
+#include "lilc_arena.hpp"
+
+namespace LILC{
+
+Arena::~Arena(){
+	while (blocks != nullptr){
+		Block * next = blocks->next;
+		std::free(blocks);
+		blocks = next;
+	}
+}
+
+void Arena::newBlock(size_t minSize){
+	size_t size = blockSize;
+	if (minSize + sizeof(Block) > size){
+		size = minSize + sizeof(Block);
+	}
+	void * mem = std::malloc(size);
+	if (mem == nullptr){ throw std::bad_alloc(); }
+
+	Block * block = static_cast<Block *>(mem);
+	block->next = blocks;
+	block->size = size;
+	blocks = block;
+	cur = reinterpret_cast<char *>(block + 1);
+	limit = reinterpret_cast<char *>(block) + size;
+	reserved += size;
+}
+
+void * Arena::allocateSlow(size_t size, size_t align){
+	//Leave room to align the first allocation in the block
+	newBlock(size + align);
+	return allocate(size, align);
+}
+
+const char * Arena::copy(const char * src, size_t len){
+	char * dst = static_cast<char *>(allocate(len, 1));
+	std::memcpy(dst, src, len);
+	return dst;
+}
+
+void Arena::reset(){
+	if (blocks == nullptr){ return; }
+	//Keep the oldest block (usually the only one for small
+	// inputs) so the next compilation doesn't have to
+	// malloc again
+	while (blocks->next != nullptr){
+		Block * next = blocks->next;
+		reserved -= blocks->size;
+		std::free(blocks);
+		blocks = next;
+	}
+	cur = reinterpret_cast<char *>(blocks + 1);
+	limit = reinterpret_cast<char *>(blocks) + blocks->size;
+	used = 0;
+}
+
+} // End namespace LILC
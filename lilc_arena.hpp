@@ -0,0 +1,123 @@
+#ifndef __LILC_ARENA_HPP__
+#define __LILC_ARENA_HPP__ 1
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+namespace LILC{
+
+/*
+* A bump-pointer allocator. Allocation is a pointer increment
+* into the current block; nothing is ever freed individually.
+* Instead, reset() releases everything handed out so far in one
+* go (keeping the first block around for reuse), so it is only
+* suitable for objects whose destructors don't need to run.
+*/
+class Arena{
+public:
+	explicit Arena(size_t blockSizeIn = 64 * 1024)
+	: blockSize(blockSizeIn) { }
+	~Arena();
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	void * allocate(size_t size,
+		size_t align = alignof(std::max_align_t))
+	{
+		uintptr_t p = reinterpret_cast<uintptr_t>(cur);
+		uintptr_t aligned = (p + align - 1) & ~(align - 1);
+		if (cur == nullptr || aligned + size >
+		    reinterpret_cast<uintptr_t>(limit)){
+			return allocateSlow(size, align);
+		}
+		cur = reinterpret_cast<char *>(aligned + size);
+		used += size;
+		return reinterpret_cast<void *>(aligned);
+	}
+
+	// Copy len bytes into the arena (e.g. lexeme text)
+	const char * copy(const char * src, size_t len);
+
+	// Release every allocation at once
+	void reset();
+
+	size_t bytesUsed() const { return used; }
+	size_t bytesReserved() const { return reserved; }
+
+private:
+	struct Block{
+		Block * next;
+		size_t size;
+	};
+	void * allocateSlow(size_t size, size_t align);
+	void newBlock(size_t minSize);
+
+	size_t blockSize;
+	Block * blocks = nullptr; // most recent first
+	char * cur = nullptr;
+	char * limit = nullptr;
+	size_t used = 0;
+	size_t reserved = 0;
+};
+
+/*
+* Standard-library allocator over an Arena, for containers whose
+* storage should live (and die) with the arena. deallocate does
+* nothing, so such containers never need to be destroyed.
+*
+* The allocator travels with the contents when a container is
+* moved, copied or swapped. That lets a container built without an
+* arena (bison default-constructs its semantic values, for one)
+* act as a placeholder until one that has an arena is assigned to
+* it; it must not allocate before then.
+*/
+template <typename T>
+class ArenaAllocator{
+public:
+	using value_type = T;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_copy_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+
+	ArenaAllocator() : arena(nullptr) { }
+	explicit ArenaAllocator(Arena& arenaIn) : arena(&arenaIn) { }
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other)
+	: arena(other.getArena()) { }
+
+	T * allocate(size_t n){
+		return static_cast<T *>(
+			arena->allocate(n * sizeof(T), alignof(T)));
+	}
+	void deallocate(T *, size_t){ }
+
+	Arena * getArena() const { return arena; }
+
+private:
+	Arena * arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b){
+	return a.getArena() == b.getArena();
+}
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b){
+	return !(a == b);
+}
+
+} /* end namespace */
+
+// Placement form so that objects can be built with
+//   new (arena) Foo(...)
+inline void * operator new(size_t size, LILC::Arena& arena){
+	return arena.allocate(size);
+}
+// Only called if a constructor throws; the arena reclaims the
+// space on its next reset
+inline void operator delete(void *, LILC::Arena&){ }
+
+#endif /* END __LILC_ARENA_HPP__ */
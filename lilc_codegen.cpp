@@ -0,0 +1,442 @@
+#include "err.hpp"
+#include "lilc_codegen.hpp"
+#include "lilc_types.hpp"
+
+namespace LILC{
+
+using NodeKind = FlatAST::NodeKind;
+using Backend = LilC_Backend;
+
+CodeGen::CodeGen(std::ostream& outIn) : out(outIn), backend(program){
+}
+
+// SPIM starts at main; everything else gets a prefix, so that
+// no name can clash with an opcode or a generated label
+Label CodeGen::globalLabel(Name name){
+	auto found = globalLabels.find(name);
+	if (found != globalLabels.end()){ return found->second; }
+	Label label = program.namedLabel(
+		name.str() == "main" ? name.str() : "_" + name.str());
+	globalLabels.emplace(name, label);
+	return label;
+}
+
+void CodeGen::genGlobal(Name name, VarSymbol * var){
+	program.globals.push_back(
+		MipsProgram::Global{ globalLabel(name), var->getSize() });
+}
+
+void CodeGen::genFnEntry(Name name, FuncSymbol * fn){
+	isMain = name.str() == "main";
+	backend.beginFunction(globalLabel(name));
+	backend.genPush(Backend::RA);
+	backend.genPush(Backend::FP);
+	backend.generateImm(Opcode::ADDIU, Backend::FP, Backend::SP, 8);
+	localsSize = fn->getLocalsSize();
+	if (localsSize > 0 || virtualRegs()){
+		backend.generateImm(Opcode::ADDIU, Backend::SP, Backend::SP,
+			-localsSize);
+	}
+	paramsSize = fn->getParamsSize();
+	exitLabel = backend.nextLabel();
+
+	if (virtualRegs()){
+		frameAdjust = program.functions.back().code.size() - 1;
+		operands.clear();
+		localRegs.clear();
+		isLocalReg.clear();
+		formalLoads.clear();
+	}
+}
+
+void CodeGen::genFnExit(){
+	backend.genLabel(exitLabel);
+	backend.generateIndexed(Opcode::LW, Backend::RA, Backend::FP, 0);
+	backend.generate(Opcode::MOVE, Backend::T0, Backend::FP);
+	backend.generateIndexed(Opcode::LW, Backend::FP, Backend::FP, -4);
+	backend.generateImm(Opcode::ADDIU, Backend::SP, Backend::T0,
+		paramsSize);
+	if (isMain){
+		backend.generateImm(Opcode::LI, Backend::V0, Backend::ZERO, 10);
+		backend.generate(Opcode::SYSCALL);
+	} else {
+		backend.generate(Opcode::JR, Backend::ZERO, Backend::RA);
+	}
+	if (virtualRegs()){ allocate(); }
+}
+
+/*
+* The callee-saved registers are saved below the spill slots at
+* the end of the prologue, and restored at the start of the
+* epilogue. Nothing is live by then, which is also why the
+* epilogue can use $t0.
+*/
+void CodeGen::allocate(){
+	MipsFunction& fn = program.functions.back();
+	std::vector<Instr>& code = fn.code;
+	code.insert(code.begin() + static_cast<std::ptrdiff_t>(frameAdjust + 1),
+		formalLoads.begin(), formalLoads.end());
+
+	int firstSlot = SymbolTable::FIRST_LOCAL - localsSize;
+	allocated.virtuals += fn.numVirtuals;
+	Allocation allocation = regAlloc == RegAlloc::COLORING
+		? GraphColoring().allocate(fn, firstSlot)
+		: LinearScan().allocate(fn, firstSlot);
+	allocated.spilled += allocation.numSpilled;
+	allocated.coalesced += allocation.numCoalesced;
+
+	std::vector<Instr> saves;
+	std::vector<Instr> restores;
+	int slot = firstSlot - allocation.spillSize;
+	for (Reg reg : allocation.saved){
+		saves.push_back(Instr{ Opcode::SW, Backend::ZERO, Backend::FP,
+			reg, slot, Instr::NO_LABEL });
+		restores.push_back(Instr{ Opcode::LW, reg, Backend::FP,
+			Backend::ZERO, slot, Instr::NO_LABEL });
+		slot -= 4;
+	}
+	code[frameAdjust].imm = slot - SymbolTable::FIRST_LOCAL;
+
+	size_t exit = code.size();
+	while (code[--exit].op != Opcode::LABEL
+		|| code[exit].label != exitLabel){ }
+	code.insert(code.begin() + static_cast<std::ptrdiff_t>(exit + 1),
+		restores.begin(), restores.end());
+	code.insert(code.begin() + static_cast<std::ptrdiff_t>(frameAdjust + 1),
+		saves.begin(), saves.end());
+}
+
+void CodeGen::finish(){
+	if (virtualRegs() && optReport != nullptr){
+		*optReport << (regAlloc == RegAlloc::COLORING
+			? "coloring" : "linear scan")
+			<< ": spilled " << allocated.spilled << " of "
+			<< allocated.virtuals << " virtual registers";
+		if (regAlloc == RegAlloc::COLORING){
+			*optReport << ", coalesced " << allocated.coalesced
+				<< " moves";
+		}
+		*optReport << "\n";
+	}
+	if (optLevel >= 1){
+		size_t before = 0;
+		for (const MipsFunction& fn : program.functions){
+			for (const Instr& instr : fn.code){
+				if (instr.op != Opcode::LABEL){ before++; }
+			}
+		}
+		size_t removed = MipsPeephole().optimize(program);
+		if (optReport != nullptr){
+			*optReport << "peephole: removed " << removed << " of "
+				<< before << " instructions\n";
+		}
+	}
+	MipsPrinter(out).print(program);
+}
+
+MemLoc CodeGen::locate(Name name, VarSymbol * var){
+	MemLoc loc;
+	loc.global = var->getStorage() == Storage::GLOBAL;
+	loc.name = name;
+	loc.offset = loc.global ? 0 : var->getOffset();
+	loc.var = var;
+	return loc;
+}
+
+void CodeGen::push(Reg reg){
+	if (virtualRegs()){
+		operands.push_back(reg);
+	} else {
+		backend.genPush(reg);
+	}
+}
+
+Reg CodeGen::pop(Reg reg){
+	if (virtualRegs()){
+		Reg top = operands.back();
+		operands.pop_back();
+		return top;
+	}
+	backend.genPop(reg);
+	return reg;
+}
+
+Reg CodeGen::peek(Reg reg){
+	if (virtualRegs()){ return operands.back(); }
+	backend.generateIndexed(Opcode::LW, reg, Backend::SP, 4);
+	return reg;
+}
+
+Reg CodeGen::temp(Reg reg){
+	return virtualRegs() ? backend.nextVirtual() : reg;
+}
+
+Reg CodeGen::localReg(const MemLoc& loc){
+	VarSymbol * var = loc.var;
+	if (!virtualRegs() || loc.global || var->getType()->isStructVar()){
+		return Backend::ZERO;
+	}
+	auto found = localRegs.find(var);
+	if (found != localRegs.end()){ return found->second; }
+
+	Reg reg = backend.nextVirtual();
+	localRegs.emplace(var, reg);
+	isLocalReg.resize(virtualIndex(reg) + 1);
+	isLocalReg[virtualIndex(reg)] = true;
+	// A formal; locals are below $fp
+	if (loc.offset > 0){
+		formalLoads.push_back(Instr{ Opcode::LW, reg, Backend::FP,
+			Backend::ZERO, loc.offset, Instr::NO_LABEL });
+	}
+	return reg;
+}
+
+// A local's register goes on the operand stack as it is, which
+// only works as long as it's copied before it changes
+void CodeGen::protect(Reg reg){
+	for (Reg& operand : operands){
+		if (operand == reg){
+			operand = backend.nextVirtual();
+			backend.generate(Opcode::MOVE, operand, reg);
+		}
+	}
+}
+
+void CodeGen::genAccess(Opcode op, Reg reg, const MemLoc& loc){
+	if (loc.global){
+		backend.generateGlobal(op, reg, globalLabel(loc.name),
+			loc.offset);
+	} else {
+		backend.generateIndexed(op, reg, Backend::FP, loc.offset);
+	}
+}
+
+void CodeGen::genIntLit(int value){
+	Reg reg = temp(Backend::T0);
+	backend.generateImm(Opcode::LI, reg, Backend::ZERO, value);
+	push(reg);
+}
+
+void CodeGen::genBoolLit(bool value){
+	Reg reg = temp(Backend::T0);
+	backend.generateImm(Opcode::LI, reg, Backend::ZERO,
+		value ? Backend::TRUE : Backend::FALSE);
+	push(reg);
+}
+
+/*
+* The literal's text is kept as written, quotes and all, apart
+* from the escapes that SPIM doesn't know, which only stand for
+* themselves anyway.
+*/
+void CodeGen::genStrLit(TokenText text){
+	std::string spelling;
+	spelling.reserve(text.size);
+	for (size_t i = 0; i < text.size; i++){
+		char c = text.data[i];
+		if (c == '\\' && i + 1 < text.size
+			&& (text.data[i + 1] == '\'' || text.data[i + 1] == '?'))
+		{
+			continue;
+		}
+		spelling += c;
+		if (c == '\\' && i + 1 < text.size){
+			spelling += text.data[++i];
+		}
+	}
+
+	auto found = stringLabels.find(spelling);
+	Label label;
+	if (found == stringLabels.end()){
+		label = backend.nextLabel();
+		stringLabels.emplace(spelling, label);
+		program.strings.push_back(
+			MipsProgram::StringLit{ label, spelling });
+	} else {
+		label = found->second;
+	}
+	Reg reg = temp(Backend::T0);
+	backend.generateGlobal(Opcode::LA, reg, label);
+	push(reg);
+}
+
+void CodeGen::genLoad(const MemLoc& loc){
+	Reg local = localReg(loc);
+	if (local != Backend::ZERO){
+		push(local);
+		return;
+	}
+	Reg reg = temp(Backend::T0);
+	genAccess(Opcode::LW, reg, loc);
+	push(reg);
+}
+
+void CodeGen::genStore(const MemLoc& loc){
+	Reg value = peek(Backend::T0);
+	Reg local = localReg(loc);
+	if (local == Backend::ZERO){
+		genAccess(Opcode::SW, value, loc);
+	} else if (local != value){
+		protect(local);
+		backend.generate(Opcode::MOVE, local, value);
+	}
+}
+
+void CodeGen::genCall(Name fn, size_t numArgs){
+	if (virtualRegs()){
+		// The callee still finds its arguments on the stack
+		size_t first = operands.size() - numArgs;
+		for (size_t i = first; i < operands.size(); i++){
+			backend.genPush(operands[i]);
+		}
+		operands.resize(first);
+	}
+	backend.generateJump(Opcode::JAL, globalLabel(fn));
+	Reg result = temp(Backend::V0);
+	if (result != Backend::V0){
+		backend.generate(Opcode::MOVE, result, Backend::V0);
+	}
+	push(result);
+}
+
+void CodeGen::genUnary(NodeKind op){
+	Reg operand = pop(Backend::T0);
+	Reg result = temp(Backend::T0);
+	switch (op){
+		case NodeKind::NEG:
+			backend.generate(Opcode::NEGU, result, operand);
+			break;
+		case NodeKind::NOT:
+			backend.generateImm(Opcode::XORI, result, operand,
+				Backend::TRUE);
+			break;
+		default:
+			throw InternalError("codeGen of a non-unary operator");
+	}
+	push(result);
+}
+
+static Opcode binaryOpcode(NodeKind op){
+	switch (op){
+		case NodeKind::PLUS: return Opcode::ADDU;
+		case NodeKind::MINUS: return Opcode::SUBU;
+		case NodeKind::TIMES: return Opcode::MUL;
+		case NodeKind::DIVIDE: return Opcode::DIV;
+		case NodeKind::EQUALS: return Opcode::SEQ;
+		case NodeKind::NOT_EQUALS: return Opcode::SNE;
+		case NodeKind::LESS: return Opcode::SLT;
+		case NodeKind::GREATER: return Opcode::SGT;
+		case NodeKind::LESS_EQ: return Opcode::SLE;
+		case NodeKind::GREATER_EQ: return Opcode::SGE;
+		default:
+			throw InternalError("codeGen of a non-binary operator");
+	}
+}
+
+void CodeGen::genBinary(NodeKind op){
+	Reg rhs = pop(Backend::T1);
+	Reg lhs = pop(Backend::T0);
+	Reg result = temp(Backend::T0);
+	backend.generate(binaryOpcode(op), result, lhs, rhs);
+	push(result);
+}
+
+/*
+* With virtual registers, whichever operand decides the result
+* leaves it in the same register, which mustn't be a local's.
+*/
+Label CodeGen::genShortCircuit(NodeKind op){
+	Label done = backend.nextLabel();
+	Reg value = peek(Backend::T0);
+	if (virtualRegs()){
+		if (virtualIndex(value) < isLocalReg.size()
+			&& isLocalReg[virtualIndex(value)])
+		{
+			Reg copy = backend.nextVirtual();
+			backend.generate(Opcode::MOVE, copy, value);
+			value = copy;
+		}
+		joins.push_back(value);
+	}
+	backend.generateBranch(op == NodeKind::AND ? Opcode::BEQ : Opcode::BNE,
+		value, Backend::ZERO, done);
+	genDiscard();
+	return done;
+}
+
+void CodeGen::genShortCircuitEnd(Label done){
+	if (virtualRegs()){
+		Reg result = joins.back();
+		joins.pop_back();
+		Reg rhs = pop(Backend::T0);
+		if (rhs != result){
+			backend.generate(Opcode::MOVE, result, rhs);
+		}
+		push(result);
+	}
+	backend.genLabel(done);
+}
+
+void CodeGen::genDiscard(){
+	if (virtualRegs()){
+		operands.pop_back();
+	} else {
+		backend.generateImm(Opcode::ADDIU, Backend::SP, Backend::SP, 4);
+	}
+}
+
+void CodeGen::genIncDec(const MemLoc& loc, int delta){
+	Reg local = localReg(loc);
+	if (local != Backend::ZERO){
+		protect(local);
+		backend.generateImm(Opcode::ADDIU, local, local, delta);
+		return;
+	}
+	Reg reg = temp(Backend::T0);
+	genAccess(Opcode::LW, reg, loc);
+	backend.generateImm(Opcode::ADDIU, reg, reg, delta);
+	genAccess(Opcode::SW, reg, loc);
+}
+
+void CodeGen::genRead(const MemLoc& loc){
+	backend.generateImm(Opcode::LI, Backend::V0, Backend::ZERO, 5);
+	backend.generate(Opcode::SYSCALL);
+	Reg local = localReg(loc);
+	if (local != Backend::ZERO){
+		protect(local);
+		backend.generate(Opcode::MOVE, local, Backend::V0);
+	} else {
+		genAccess(Opcode::SW, Backend::V0, loc);
+	}
+}
+
+void CodeGen::genWrite(const Type * type){
+	Reg value = pop(Backend::A0);
+	if (value != Backend::A0){
+		backend.generate(Opcode::MOVE, Backend::A0, value);
+	}
+	backend.generateImm(Opcode::LI, Backend::V0, Backend::ZERO,
+		type == Type::stringType() ? 4 : 1);
+	backend.generate(Opcode::SYSCALL);
+}
+
+void CodeGen::genReturn(bool hasValue){
+	if (hasValue){
+		Reg value = pop(Backend::V0);
+		if (value != Backend::V0){
+			backend.generate(Opcode::MOVE, Backend::V0, value);
+		}
+	}
+	backend.generateJump(Opcode::J, exitLabel);
+}
+
+void CodeGen::genJump(Label label){
+	backend.generateJump(Opcode::J, label);
+}
+
+void CodeGen::genJumpIfFalse(Label label){
+	Reg cond = pop(Backend::T0);
+	backend.generateBranch(Opcode::BEQ, cond, Backend::ZERO, label);
+}
+
+} // End namespace LILC
@@ -0,0 +1,177 @@
+#ifndef LILC_CODEGEN_HPP
+#define LILC_CODEGEN_HPP
+
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lilc_mips.hpp"
+#include "lilc_regalloc.hpp"
+#include "lilc_names.hpp"
+#include "lilc_flat_ast.hpp"
+#include "symbol_table.hpp"
+#include "tokens.hpp"
+
+namespace LILC{
+
+/*
+* A variable, or a field of one, as the generated code addresses
+* it: offset bytes from $fp, or from a global's label. With
+* virtual registers, a local that's a single word lives in one of
+* those instead.
+*/
+struct MemLoc{
+	bool global;
+	Name name; // the global's
+	int offset;
+	VarSymbol * var; // the variable, not the field
+};
+
+/*
+* Code generation for a stack machine, shared by the walks of the
+* tree (code_generation.cpp) and of the FlatAST
+* (flat_code_generation.cpp). Each expression pushes its value as
+* one word and each statement leaves the stack as it found it.
+* Where every variable lives was settled in name analysis (see
+* SymbolTable::place), so nothing here lays out memory.
+*
+* A frame, growing down, with $fp pointing at the saved $ra:
+*
+*     arg 1 .. arg n     pushed by the caller, popped by the callee
+*     saved $ra          0($fp)
+*     saved $fp          -4($fp)
+*     locals             from -8($fp) down
+*
+* Functions return their value in $v0. The code is built up as a
+* MipsProgram, and only printed by finish.
+*
+* With a register allocator (see setRegAlloc), the operand stack
+* only exists at compile time: each value goes in a new virtual
+* register, and so does each local word, so that only arguments
+* are pushed. Each function's registers are allocated once its
+* code is complete, and the frame then grows to hold the spills
+* and callee-saved registers.
+*/
+class CodeGen{
+public:
+	explicit CodeGen(std::ostream& out);
+
+	// Declarations
+	void genGlobal(Name name, VarSymbol * var);
+	void genFnEntry(Name name, FuncSymbol * fn);
+	void genFnExit();
+	// Print the program, once every declaration is done
+	void finish();
+
+	// At level 1 and up (lilcc -O1), finish runs MipsPeephole
+	// over the code first, and says how many instructions that
+	// removed on report, unless it's null, along with how the
+	// register allocator did
+	void setOptLevel(unsigned level){ optLevel = level; }
+	void setOptReport(std::ostream * report){ optReport = report; }
+	// Keep values in virtual registers, allocated this way, rather
+	// than on the stack. Set before generating anything.
+	void setRegAlloc(RegAlloc alloc){ regAlloc = alloc; }
+
+	// Where a variable named name, with symbol var, is, and
+	// where field is within it
+	static MemLoc locate(Name name, VarSymbol * var);
+	static MemLoc field(MemLoc base, VarSymbol * field){
+		base.offset += field->getOffset();
+		return base;
+	}
+
+	// Expressions: each pushes its value
+	void genIntLit(int value);
+	void genBoolLit(bool value);
+	void genStrLit(TokenText text);
+	void genLoad(const MemLoc& loc);
+	// Stores the value on top of the stack, leaving it there
+	void genStore(const MemLoc& loc);
+	// With the numArgs arguments pushed, in order
+	void genCall(Name fn, size_t numArgs);
+	// op is the FlatAST kind of the operator, one of NEG, NOT or
+	// PLUS ... GREATER_EQ other than AND and OR
+	void genUnary(FlatAST::NodeKind op);
+	void genBinary(FlatAST::NodeKind op);
+	// With the left operand of && (or ||) pushed, skips to the
+	// returned label, leaving it there, if it decides the result;
+	// otherwise pops it, for the right operand to be pushed, and
+	// then genShortCircuitEnd marks the label
+	Label genShortCircuit(FlatAST::NodeKind op);
+	void genShortCircuitEnd(Label done);
+
+	// Statements
+	void genDiscard();
+	void genIncDec(const MemLoc& loc, int delta);
+	void genRead(const MemLoc& loc);
+	// Pops the value and writes it as type says
+	void genWrite(const Type * type);
+	// Pops the value, if there is one, and leaves the function
+	void genReturn(bool hasValue);
+
+	// Control flow
+	Label nextLabel(){ return backend.nextLabel(); }
+	void genLabel(Label label){ backend.genLabel(label); }
+	void genJump(Label label);
+	// Pops a condition and jumps if it's false
+	void genJumpIfFalse(Label label);
+
+private:
+	bool virtualRegs() const { return regAlloc != RegAlloc::NONE; }
+	// The operand stack, kept in memory through the register
+	// given, or, with virtual registers, at compile time
+	void push(Reg reg);
+	Reg pop(Reg reg);
+	Reg peek(Reg reg);
+	// Where to put a new value: reg, or a new virtual register
+	Reg temp(Reg reg);
+	// The register loc's variable lives in, or ZERO if it's in
+	// memory
+	Reg localReg(const MemLoc& loc);
+	// Copies any operands that are reg, before reg is set
+	void protect(Reg reg);
+	// Allocates the finished function's registers
+	void allocate();
+
+	// Load into, or store from, reg
+	void genAccess(Opcode op, Reg reg, const MemLoc& loc);
+	// The label of a global or function, made on first use
+	Label globalLabel(Name name);
+
+	std::ostream& out;
+	unsigned optLevel = 0;
+	std::ostream * optReport = nullptr;
+	RegAlloc regAlloc = RegAlloc::NONE;
+	// Totals over the functions allocated so far, for optReport
+	struct {
+		size_t virtuals = 0;
+		size_t spilled = 0;
+		size_t coalesced = 0;
+	} allocated;
+	MipsProgram program;
+	LilC_Backend backend;
+	std::unordered_map<Name, Label> globalLabels;
+	std::unordered_map<std::string, Label> stringLabels;
+	// The function being generated
+	bool isMain = false;
+	int paramsSize = 0;
+	int localsSize = 0;
+	Label exitLabel = 0;
+	// With virtual registers: the operand stack, the registers
+	// the && and || being generated leave their results in, and
+	// the locals' registers. Formals are loaded into theirs at
+	// the end of the prologue, whose last instruction, setting
+	// $sp, is at frameAdjust.
+	std::vector<Reg> operands;
+	std::vector<Reg> joins;
+	std::unordered_map<VarSymbol *, Reg> localRegs;
+	std::vector<bool> isLocalReg;
+	std::vector<Instr> formalLoads;
+	size_t frameAdjust = 0;
+};
+
+} // End namespace LILC
+
+#endif
@@ -0,0 +1,521 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include "lilc_regalloc.hpp"
+
+namespace LILC{
+
+/*
+* This follows the allocator in Appel's "Modern Compiler
+* Implementation", pretty much name for name. Nodes 0 to K-1 of
+* the interference graph stand for the K registers, in colors()
+* order, and node K+v for virtual register v. Nodes move between
+* the worklists by their state; a list may still hold a node that
+* has since left it, which is skipped when it comes off.
+*/
+
+// Colors in the order they're tried, so that callee-saved
+// registers, which cost a save and restore, come last. Made on
+// first use, since CALLER_SAVED and CALLEE_SAVED may not be yet
+// when this file's statics are.
+static const std::vector<Reg>& colors(){
+	static const std::vector<Reg> COLORS = [](){
+		std::vector<Reg> all(CALLER_SAVED);
+		all.insert(all.end(), CALLEE_SAVED.begin(), CALLEE_SAVED.end());
+		return all;
+	}();
+	return COLORS;
+}
+
+// Spill costs stop going up past this many loops in
+static const size_t MAX_DEPTH = 8;
+
+/*
+* How many loops each instruction is in. LilC's loops all come
+* out as a jump back to a label earlier in the function, so each
+* such jump adds one to everything from the label to the jump.
+*/
+static std::vector<size_t> loopDepths(const std::vector<Instr>& code){
+	std::unordered_map<Label, size_t> labels;
+	for (size_t i = 0; i < code.size(); i++){
+		if (code[i].op == Opcode::LABEL){ labels[code[i].label] = i; }
+	}
+	std::vector<long> deltas(code.size() + 1, 0);
+	for (size_t i = 0; i < code.size(); i++){
+		if (code[i].op != Opcode::J){ continue; }
+		auto target = labels.find(code[i].label);
+		if (target != labels.end() && target->second <= i){
+			deltas[target->second]++;
+			deltas[i + 1]--;
+		}
+	}
+	std::vector<size_t> depths(code.size());
+	long depth = 0;
+	for (size_t i = 0; i < code.size(); i++){
+		depth += deltas[i];
+		depths[i] = static_cast<size_t>(depth);
+	}
+	return depths;
+}
+
+class Coloring{
+public:
+	explicit Coloring(const MipsFunction& fn);
+	// Whether build gave up, with the graph past MAX_EDGES
+	bool tooBig() const { return edges > GraphColoring::MAX_EDGES; }
+	// Colors the graph; each node then has a color, or is spilled
+	void run();
+
+	// Of virtual register v, or colors().size() if it's spilled.
+	// Coalesced nodes share the color of the node they joined.
+	size_t colorOf(size_t v){ return color[alias(K + v)]; }
+	// The virtual register whose node v was coalesced into
+	size_t representative(size_t v){ return alias(K + v) - K; }
+	size_t numCoalesced() const { return coalescedMoves; }
+
+private:
+	enum class State : uint8_t {
+		PRECOLORED, INITIAL, SIMPLIFY, FREEZE, SPILL, SPILLED,
+		COALESCED, COLORED, SELECTED,
+	};
+	enum class MoveState : uint8_t {
+		WORKLIST, ACTIVE, COALESCED, CONSTRAINED, FROZEN,
+	};
+	struct Move{
+		size_t dst;
+		size_t src;
+		MoveState state;
+	};
+
+	void build(const MipsFunction& fn);
+	void addEdge(size_t u, size_t v);
+	bool adjacent(size_t u, size_t v) const {
+		return (adjSet[(u * n + v) / 64] >> ((u * n + v) % 64)) & 1;
+	}
+	bool inGraph(size_t node) const {
+		return state[node] != State::SELECTED
+			&& state[node] != State::COALESCED;
+	}
+	// Calls fn with each neighbor of node that's still in the graph
+	template <typename Fn>
+	void forAdjacent(size_t node, Fn fn){
+		for (size_t neighbor : adjList[node]){
+			if (inGraph(neighbor)){ fn(neighbor); }
+		}
+	}
+	bool moveRelated(size_t node) const;
+	template <typename Fn>
+	void forNodeMoves(size_t node, Fn fn){
+		for (size_t m : moveList[node]){
+			if (moves[m].state == MoveState::WORKLIST
+				|| moves[m].state == MoveState::ACTIVE)
+			{
+				fn(m);
+			}
+		}
+	}
+	// Puts node on the worklist for its degree and moves
+	void classify(size_t node);
+	void simplify(size_t node);
+	void decrementDegree(size_t node);
+	void enableMoves(size_t node);
+	void coalesce();
+	void addWorkList(size_t node);
+	bool conservative(size_t u, size_t v);
+	size_t alias(size_t node);
+	void combine(size_t u, size_t v);
+	void freeze(size_t node);
+	void freezeMoves(size_t node);
+	double spillPriority(size_t node) const {
+		return cost[node] / static_cast<double>(degree[node]);
+	}
+	void addSpill(size_t node);
+	bool selectSpill();
+	void assignColors();
+	// Pops list down to a node still in state from, if there is one
+	bool take(std::vector<size_t>& list, State from, size_t& node);
+
+	const size_t K;
+	size_t n;
+	size_t edges = 0;
+	std::vector<uint64_t> adjSet;
+	std::vector<std::vector<size_t>> adjList;
+	std::vector<size_t> degree;
+	std::vector<State> state;
+	std::vector<size_t> aliases;
+	std::vector<size_t> color;
+	std::vector<double> cost;
+	std::vector<std::vector<size_t>> moveList;
+	std::vector<Move> moves;
+	std::vector<size_t> simplifyWorklist;
+	std::vector<size_t> freezeWorklist;
+	// By spillPriority, least first
+	std::priority_queue<std::pair<double, size_t>,
+		std::vector<std::pair<double, size_t>>,
+		std::greater<std::pair<double, size_t>>> spillWorklist;
+	std::vector<size_t> moveWorklist;
+	std::vector<size_t> selectStack;
+	size_t coalescedMoves = 0;
+};
+
+Coloring::Coloring(const MipsFunction& fn)
+: K(colors().size()), n(colors().size() + fn.numVirtuals),
+  adjSet((n * n + 63) / 64), adjList(n), degree(n, 0),
+  state(n, State::INITIAL), aliases(n), color(n, colors().size()),
+  cost(n, 0), moveList(n)
+{
+	for (size_t node = 0; node < n; node++){ aliases[node] = node; }
+	for (size_t c = 0; c < K; c++){
+		state[c] = State::PRECOLORED;
+		color[c] = c;
+		// Never simplified, so never low enough to matter
+		degree[c] = SIZE_MAX / 2;
+	}
+	build(fn);
+}
+
+void Coloring::addEdge(size_t u, size_t v){
+	if (u == v || adjacent(u, v)){ return; }
+	adjSet[(u * n + v) / 64] |= uint64_t(1) << ((u * n + v) % 64);
+	adjSet[(v * n + u) / 64] |= uint64_t(1) << ((v * n + u) % 64);
+	edges++;
+	if (state[u] != State::PRECOLORED){
+		adjList[u].push_back(v);
+		degree[u]++;
+	}
+	if (state[v] != State::PRECOLORED){
+		adjList[v].push_back(u);
+		degree[v]++;
+	}
+}
+
+/*
+* Walks each block backward from what's live out of it. Whatever
+* an instruction writes interferes with everything live after it,
+* except, for a move, the register it copies; a call writes every
+* caller-saved register.
+*/
+void Coloring::build(const MipsFunction& fn){
+	const std::vector<Instr>& code = fn.code;
+	std::vector<size_t> depths = loopDepths(code);
+	Liveness liveness(fn);
+	const std::vector<Liveness::Block>& blocks = liveness.getBlocks();
+	std::vector<uint64_t> live((fn.numVirtuals + 63) / 64);
+	auto forLive = [&](auto f){
+		for (size_t word = 0; word < live.size(); word++){
+			for (uint64_t bits = live[word]; bits != 0; bits &= bits - 1){
+				f(word * 64 + static_cast<size_t>(__builtin_ctzll(bits)));
+			}
+		}
+	};
+	auto setLive = [&](size_t v, bool on){
+		if (on){
+			live[v / 64] |= uint64_t(1) << (v % 64);
+		} else {
+			live[v / 64] &= ~(uint64_t(1) << (v % 64));
+		}
+	};
+
+	for (size_t b = 0; b < blocks.size(); b++){
+		std::fill(live.begin(), live.end(), 0);
+		liveness.forLiveOut(b, [&](size_t v){ setLive(v, true); });
+		for (size_t i = blocks[b].last + 1; i-- > blocks[b].first; ){
+			if (tooBig()){ return; }
+			const Instr& instr = code[i];
+			double weight = 1;
+			for (size_t d = std::min(depths[i], MAX_DEPTH); d > 0; d--){
+				weight *= 10;
+			}
+			if (instr.op == Opcode::JAL){
+				for (size_t c = 0; c < CALLER_SAVED.size(); c++){
+					forLive([&](size_t v){ addEdge(c, K + v); });
+				}
+				continue;
+			}
+			Reg def = instr.written();
+			if (instr.op == Opcode::MOVE && isVirtual(def)
+				&& isVirtual(instr.rs))
+			{
+				size_t src = virtualIndex(instr.rs);
+				setLive(src, false);
+				moves.push_back(Move{ K + virtualIndex(def), K + src,
+					MoveState::WORKLIST });
+				moveList[K + virtualIndex(def)].push_back(moves.size() - 1);
+				moveList[K + src].push_back(moves.size() - 1);
+				moveWorklist.push_back(moves.size() - 1);
+			}
+			if (isVirtual(def)){
+				size_t v = virtualIndex(def);
+				forLive([&](size_t l){ addEdge(K + v, K + l); });
+				setLive(v, false);
+				cost[K + v] += weight;
+			}
+			for (Reg reg : { instr.rs, instr.rt }){
+				if (isVirtual(reg) && instr.reads(reg)){
+					setLive(virtualIndex(reg), true);
+					cost[K + virtualIndex(reg)] += weight;
+				}
+			}
+		}
+	}
+}
+
+bool Coloring::moveRelated(size_t node) const{
+	for (size_t m : moveList[node]){
+		if (moves[m].state == MoveState::WORKLIST
+			|| moves[m].state == MoveState::ACTIVE)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void Coloring::classify(size_t node){
+	if (degree[node] >= K){
+		state[node] = State::SPILL;
+		addSpill(node);
+	} else if (moveRelated(node)){
+		state[node] = State::FREEZE;
+		freezeWorklist.push_back(node);
+	} else {
+		state[node] = State::SIMPLIFY;
+		simplifyWorklist.push_back(node);
+	}
+}
+
+bool Coloring::take(std::vector<size_t>& list, State from, size_t& node){
+	while (!list.empty()){
+		node = list.back();
+		list.pop_back();
+		if (state[node] == from){ return true; }
+	}
+	return false;
+}
+
+void Coloring::run(){
+	for (size_t node = K; node < n; node++){ classify(node); }
+	while (true){
+		size_t node;
+		if (take(simplifyWorklist, State::SIMPLIFY, node)){
+			simplify(node);
+		} else if (!moveWorklist.empty()){
+			coalesce();
+		} else if (take(freezeWorklist, State::FREEZE, node)){
+			freeze(node);
+		} else if (!selectSpill()){
+			break;
+		}
+	}
+	assignColors();
+}
+
+void Coloring::simplify(size_t node){
+	state[node] = State::SELECTED;
+	selectStack.push_back(node);
+	forAdjacent(node, [&](size_t m){ decrementDegree(m); });
+}
+
+void Coloring::decrementDegree(size_t node){
+	if (state[node] == State::PRECOLORED){ return; }
+	if (degree[node]-- != K){ return; }
+	enableMoves(node);
+	forAdjacent(node, [&](size_t m){ enableMoves(m); });
+	if (state[node] == State::SPILL){ classify(node); }
+}
+
+void Coloring::enableMoves(size_t node){
+	for (size_t m : moveList[node]){
+		if (moves[m].state == MoveState::ACTIVE){
+			moves[m].state = MoveState::WORKLIST;
+			moveWorklist.push_back(m);
+		}
+	}
+}
+
+void Coloring::coalesce(){
+	size_t m = moveWorklist.back();
+	moveWorklist.pop_back();
+	if (moves[m].state != MoveState::WORKLIST){ return; }
+	size_t u = alias(moves[m].dst);
+	size_t v = alias(moves[m].src);
+	if (state[v] == State::PRECOLORED){ std::swap(u, v); }
+
+	if (u == v){
+		moves[m].state = MoveState::COALESCED;
+		coalescedMoves++;
+		addWorkList(u);
+	} else if (state[v] == State::PRECOLORED || adjacent(u, v)){
+		moves[m].state = MoveState::CONSTRAINED;
+		addWorkList(u);
+		addWorkList(v);
+	} else if (conservative(u, v)){
+		moves[m].state = MoveState::COALESCED;
+		coalescedMoves++;
+		combine(u, v);
+		addWorkList(u);
+	} else {
+		moves[m].state = MoveState::ACTIVE;
+	}
+}
+
+void Coloring::addWorkList(size_t node){
+	if (state[node] == State::FREEZE && !moveRelated(node)
+		&& degree[node] < K)
+	{
+		state[node] = State::SIMPLIFY;
+		simplifyWorklist.push_back(node);
+	}
+}
+
+// Briggs: the two can be one node if that would have fewer than
+// K neighbors of significant degree
+bool Coloring::conservative(size_t u, size_t v){
+	size_t significant = 0;
+	for (size_t m : adjList[u]){
+		if (inGraph(m) && degree[m] >= K && ++significant == K){
+			return false;
+		}
+	}
+	for (size_t m : adjList[v]){
+		if (inGraph(m) && degree[m] >= K && !adjacent(u, m)
+			&& ++significant == K)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+size_t Coloring::alias(size_t node){
+	while (state[node] == State::COALESCED){ node = aliases[node]; }
+	return node;
+}
+
+void Coloring::combine(size_t u, size_t v){
+	state[v] = State::COALESCED;
+	aliases[v] = u;
+	cost[u] += cost[v];
+	moveList[u].insert(moveList[u].end(),
+		moveList[v].begin(), moveList[v].end());
+	enableMoves(v);
+	forAdjacent(v, [&](size_t t){
+		addEdge(t, u);
+		decrementDegree(t);
+	});
+	if (degree[u] >= K && state[u] == State::FREEZE){
+		state[u] = State::SPILL;
+	}
+	// With its new degree and cost
+	if (state[u] == State::SPILL){ addSpill(u); }
+}
+
+void Coloring::freeze(size_t node){
+	state[node] = State::SIMPLIFY;
+	simplifyWorklist.push_back(node);
+	freezeMoves(node);
+}
+
+void Coloring::freezeMoves(size_t node){
+	forNodeMoves(node, [&](size_t m){
+		size_t other = alias(moves[m].dst) == alias(node)
+			? alias(moves[m].src) : alias(moves[m].dst);
+		moves[m].state = MoveState::FROZEN;
+		if (state[other] == State::FREEZE && !moveRelated(other)){
+			state[other] = State::SIMPLIFY;
+			simplifyWorklist.push_back(other);
+		}
+	});
+}
+
+void Coloring::addSpill(size_t node){
+	spillWorklist.push(std::make_pair(spillPriority(node), node));
+}
+
+/*
+* Spills whatever costs least for how much it's in the way, if
+* there's anything left to spill. Short of a combine, which queues
+* the node again, a node's degree only goes down while it waits, so
+* its priority only goes up, and one that comes off with an out of
+* date priority is queued again rather than taken.
+*/
+bool Coloring::selectSpill(){
+	while (!spillWorklist.empty()){
+		std::pair<double, size_t> top = spillWorklist.top();
+		spillWorklist.pop();
+		size_t node = top.second;
+		if (state[node] != State::SPILL){ continue; }
+		if (top.first != spillPriority(node)){
+			addSpill(node);
+			continue;
+		}
+		state[node] = State::SIMPLIFY;
+		simplifyWorklist.push_back(node);
+		freezeMoves(node);
+		return true;
+	}
+	return false;
+}
+
+void Coloring::assignColors(){
+	std::vector<bool> used(K);
+	while (!selectStack.empty()){
+		size_t node = selectStack.back();
+		selectStack.pop_back();
+		std::fill(used.begin(), used.end(), false);
+		for (size_t m : adjList[node]){
+			size_t c = color[alias(m)];
+			if (c < K){ used[c] = true; }
+		}
+		size_t c = static_cast<size_t>(
+			std::find(used.begin(), used.end(), false) - used.begin());
+		state[node] = c < K ? State::COLORED : State::SPILLED;
+		color[node] = c;
+	}
+}
+
+Allocation GraphColoring::allocate(MipsFunction& fn, int firstSlot){
+	if (fn.numVirtuals > MAX_VIRTUALS){
+		return LinearScan().allocate(fn, firstSlot);
+	}
+	Coloring coloring(fn);
+	if (coloring.tooBig()){
+		return LinearScan().allocate(fn, firstSlot);
+	}
+	coloring.run();
+
+	Allocation allocation;
+	allocation.numCoalesced = coloring.numCoalesced();
+	std::vector<Reg> assigned(fn.numVirtuals, Reg::ZERO);
+	std::vector<int> slots(fn.numVirtuals, 0);
+	std::vector<bool> colorUsed(colors().size(), false);
+	std::vector<bool> slotTaken(fn.numVirtuals, false);
+	for (size_t v = 0; v < fn.numVirtuals; v++){
+		size_t c = coloring.colorOf(v);
+		if (c < colors().size()){
+			assigned[v] = colors()[c];
+			colorUsed[c] = true;
+			continue;
+		}
+		// Coalesced registers share their representative's slot
+		size_t rep = coloring.representative(v);
+		if (!slotTaken[rep]){
+			slotTaken[rep] = true;
+			slots[rep] = firstSlot - allocation.spillSize;
+			allocation.spillSize += 4;
+			allocation.numSpilled++;
+		}
+		slots[v] = slots[rep];
+	}
+	for (size_t c = CALLER_SAVED.size(); c < colors().size(); c++){
+		if (colorUsed[c]){ allocation.saved.push_back(colors()[c]); }
+	}
+	rewriteVirtuals(fn, assigned, slots);
+	return allocation;
+}
+
+} // End namespace LILC
@@ -1,11 +1,41 @@
 #include <cctype>
 #include <fstream>
+#include <sstream>
 #include <cassert>
+#include <string>
+#include <vector>
 
 #include "lilc_compiler.hpp"
+#include "lilc_token_stream.hpp"
+#include "lilc_dfa_scanner.hpp"
 
 using TokenTag = LILC::LilC_Parser::token;
-using Lexeme = LILC::LilC_Parser::semantic_type;
+
+// How much token dump text scan() collects before writing it out
+static const size_t DUMP_BUFFER_SIZE = 1 << 20;
+
+/*
+* The spelling of a keyword/punctuation token, as given by its
+* alias in lilc.yy. Bison's yytname entries for aliases are
+* quoted, so strip the quotes once up front.
+*/
+static const std::string& tokenSpelling(int tag){
+	using Parser = LILC::LilC_Parser;
+	static std::vector<std::string> names;
+	if (names.empty()){
+		for (int k = 0; k < Parser::YYNTOKENS; k++){
+			std::string name = Parser::symbol_name(
+				static_cast<Parser::symbol_kind_type>(k));
+			if (name.size() >= 2 && name.front() == '"'){
+				name = name.substr(1, name.size() - 2);
+			}
+			names.push_back(name);
+		}
+		names[Parser::symbol_kind::S_YYUNDEF] = "UNKNOWN TOKEN";
+	}
+	Parser::by_kind kind(static_cast<Parser::token_kind_type>(tag));
+	return names[static_cast<size_t>(kind.kind())];
+}
 
 LILC::LilC_Compiler::~LilC_Compiler()
 {
@@ -13,184 +43,164 @@ LILC::LilC_Compiler::~LilC_Compiler()
    scanner = nullptr;
    delete(parser);
    parser = nullptr;
-   delete(astRoot);
+   // The AST itself goes with astArena
    astRoot = nullptr;
+   delete(inStream);
+   inStream = nullptr;
+   delete(source);
+   source = nullptr;
+   // Its TypeTable holds the types the symbols point at
+   delete(symbolTable);
+   symbolTable = nullptr;
+}
+
+/*
+* (Re)create the scanner over the given file, either mapped
+* or through an ifstream depending on mappedInput. Whichever
+* input object backs the scanner is kept alive until the next
+* call, since token text may point into it.
+*/
+bool LILC::LilC_Compiler::openScanner( const char * const filename )
+{
+   delete(scanner);
+   scanner = nullptr;
+   delete(inStream);
+   inStream = nullptr;
+   delete(source);
+   source = nullptr;
+   tokenArena.reset();
+
+   if (mappedInput || scannerKind == ScannerKind::DFA){
+      source = new SourceFile( filename );
+      if ( ! source->good() ){ return false; }
+      if ( TokenStream::isTokenStream( *source ) ){
+         scanner = new LILC::TokenStreamReader( source, tokenArena,
+            nameTable );
+      } else if ( scannerKind == ScannerKind::DFA ){
+         scanner = new LILC::LilC_DFAScanner( source->begin(),
+            source->end(), tokenArena, nameTable );
+      } else {
+         scanner = new LILC::LilC_Scanner( source, tokenArena, nameTable );
+      }
+   } else {
+      inStream = new std::ifstream( filename );
+      if ( ! inStream->good() ){ return false; }
+      if ( TokenStream::isTokenStream( *inStream ) ){
+         // Replayed from memory, the same as a mapped one
+         delete(inStream);
+         inStream = nullptr;
+         source = new SourceFile( filename );
+         if ( ! source->good() ){ return false; }
+         scanner = new LILC::TokenStreamReader( source, tokenArena,
+            nameTable );
+      } else {
+         scanner = new LILC::LilC_Scanner( inStream, tokenArena,
+            nameTable );
+      }
+   }
+   return true;
 }
 
 void LILC::LilC_Compiler::scan( const char * const filename,
 const char * outfile )
 {
-   std::ifstream inStream( filename );
-   if( ! inStream.good() ) {
+   PhaseTimer timer(timeReport, "scan");
+   if( ! openScanner( filename ) ) {
 	std::cerr << "Bad input stream " << filename << std::endl;
        exit( EXIT_FAILURE );
    }
 
-   delete(scanner);
-   scanner = new LILC::LilC_Scanner( &inStream );
-
    std::ofstream out(outfile);
-   Lexeme lexeme;
+   std::string buf;
+   buf.reserve(DUMP_BUFFER_SIZE + 256);
+   Token * tok;
    int tokenTag;
    while(true){
-   	tokenTag = scanner->yylex(&lexeme);
+   	tokenTag = scanner->yylex(&tok);
 	switch (tokenTag){
 		case TokenTag::END:
-			out << "EOF" << std::endl;
+			buf += "EOF\n";
+			out.write(buf.data(), 
+				static_cast<std::streamsize>(buf.size()));
+			out.flush();
 			return;
-		case TokenTag::BOOL:
-			out << "bool" << std::endl;
-			break;
-		case TokenTag::INT:
-			out << "int" << std::endl;
-			break;
-		case TokenTag::VOID:
-			out << "void" << std::endl;
-			break;
-		case TokenTag::TRUE:
-			out << "true" << std::endl;
-			break;
-		case TokenTag::FALSE:
-			out << "false" << std::endl;
-			break;
-		case TokenTag::STRUCT:
-			out << "struct" << std::endl;
-			break;
-		case TokenTag::INPUT:
-			out << "input" << std::endl;
-			break;
-		case TokenTag::OUTPUT:
-			out << "output" << std::endl;
-			break;
-		case TokenTag::IF:
-			out << "if" << std::endl;
-			break;
-		case TokenTag::ELSE:
-			out << "else" << std::endl;
-			break;
-		case TokenTag::WHILE:
-			out << "while" << std::endl;
-			break;
-		case TokenTag::RETURN:
-			out << "return" << std::endl;
-			break;
 		case TokenTag::ID:
-			{
-			IDToken * tok = static_cast<IDToken *>(
-				lexeme.tokenValue);
-			out << "ID:" << tok->value() << std::endl;
+			buf += "ID:";
+			buf += static_cast<IDToken *>(tok)->value();
 			break;
-			}
 		case TokenTag::INTLITERAL:
-			{
-			IntLitToken * tok = static_cast<IntLitToken *>(
-				lexeme.tokenValue);
-			out << "INTLIT:" << tok->value() << std::endl;	
+			buf += "INTLIT:";
+			buf += std::to_string(
+				static_cast<IntLitToken *>(tok)->value());
 			break;
-			}
 		case TokenTag::STRINGLITERAL:
 			{
-			StringLitToken * tok = static_cast<StringLitToken *>(
-				lexeme.tokenValue);
-			out << "STRINGLIT:" << tok->value() << std::endl;	
+			TokenText text =
+				static_cast<StringLitToken *>(tok)->text();
+			buf += "STRINGLIT:";
+			buf.append(text.data, text.size);
 			break;
 			}
-		case TokenTag::LCURLY:
-			out << "{" << std::endl;
-			break;
-		case TokenTag::RCURLY:
-			out << "}" << std::endl;
-			break;
-		case TokenTag::LPAREN:
-			out << "(" << std::endl;
-			break;
-		case TokenTag::RPAREN:
-			out << ")" << std::endl;
-			break;
-		case TokenTag::SEMICOLON:
-			out << ";" << std::endl;
-			break;
-		case TokenTag::COMMA:
-			out << "," << std::endl;
-			break;
-		case TokenTag::DOT:
-			out << "." << std::endl;
-			break;
-		case TokenTag::WRITE:
-			out << "<<" << std::endl;
-			break;
-		case TokenTag::READ:
-			out << ">>" << std::endl;
-			break;
-		case TokenTag::PLUSPLUS:
-			out << "++" << std::endl;
-			break;
-		case TokenTag::MINUSMINUS:
-			out << "--" << std::endl;
-			break;
-		case TokenTag::PLUS:
-			out << "+" << std::endl;
-			break;
-		case TokenTag::MINUS:
-			out << "-" << std::endl;
-			break;
-		case TokenTag::TIMES:
-			out << "*" << std::endl;
-			break;
-		case TokenTag::DIVIDE:
-			out << "/" << std::endl;
-			break;
-		case TokenTag::NOT:
-			out << "!" << std::endl;
-			break;
-		case TokenTag::AND:
-			out << "&&" << std::endl;
-			break;
-		case TokenTag::OR:
-			out << "||" << std::endl;
-			break;
-		case TokenTag::EQUALS:
-			out << "==" << std::endl;
-			break;
-		case TokenTag::NOTEQUALS:
-			out << "!=" << std::endl;
-			break;
-		case TokenTag::LESS:
-			out << "<" << std::endl;
-			break;
-		case TokenTag::GREATER:
-			out << ">" << std::endl;
-			break;
-		case TokenTag::LESSEQ:
-			out << ">=" << std::endl;
-			break;
-		case TokenTag::GREATEREQ:
-			out << ">=" << std::endl;
-			break;
-		case TokenTag::ASSIGN:
-			out << "=" << std::endl;
-			break;
 		default:
-			out << "UNKNOWN TOKEN" << std::endl;
+			buf += tokenSpelling(tokenTag);
 			break;
 	}
+	buf += '\n';
+	//Hand the stream big chunks rather than a line at a time
+	if (buf.size() >= DUMP_BUFFER_SIZE){
+		out.write(buf.data(), 
+			static_cast<std::streamsize>(buf.size()));
+		buf.clear();
+	}
    }
 }
 
+/*
+* Write the token stream for filename to outfile in the binary
+* format described in lilc_token_stream.hpp. parse() will
+* accept the result in place of the source. The format has no
+* room for the scanner's errors and warnings, which replaying it
+* would lose, so if the scan reports any nothing is written and
+* this returns false.
+*/
+bool LILC::LilC_Compiler::emitTokens( const char * const filename,
+const char * outfile )
+{
+   PhaseTimer timer(timeReport, "emit tokens");
+   if( ! openScanner( filename ) ) {
+	std::cerr << "Bad input stream " << filename << std::endl;
+       exit( EXIT_FAILURE );
+   }
+   size_t reported = Err::scanReports();
+   std::ostringstream tokens;
+   TokenStream::write(*scanner, tokens);
+   if (Err::scanReports() != reported){
+      std::cerr << "No token stream written for " << filename
+         << ", since it would leave out the messages above" << std::endl;
+      return false;
+   }
+   std::ofstream out(outfile, std::ios::binary);
+   const std::string& bytes = tokens.str();
+   out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+   return true;
+}
+
 bool
 LILC::LilC_Compiler::parse( const char * const infile) {
    assert( infile != nullptr );
-   std::ifstream in_stream( infile );
-   if( ! in_stream.good() )
+   // Includes scanning, since the parser pulls tokens as it goes
+   PhaseTimer timer(timeReport, "parse");
+   if( ! openScanner( infile ) )
    {
 	std::cerr << "bad input stream " << infile << std::endl;
        exit( EXIT_FAILURE );
    }
    
-   delete(scanner);
-   scanner = new LILC::LilC_Scanner( &in_stream );
    delete(parser); 
-   delete(astRoot);
+   // Any previous AST is dropped wholesale
+   astRoot = nullptr;
+   astArena.reset();
+   flatAST.clear();
    try
    {
       parser = new LILC::LilC_Parser( (*scanner) /* scanner */, 
@@ -203,7 +213,11 @@ LILC::LilC_Compiler::parse( const char * const infile) {
       exit( EXIT_FAILURE );
    }
    const int accept( 0 );
-   if( parser->parse() != accept )
+   const bool ok = parser->parse() == accept;
+   // Nothing in the AST points at a token, so the whole token
+   // stream can go now rather than when the compiler dies
+   tokenArena.reset();
+   if( ! ok )
    {
       std::cerr << "Parse failed!!\n";
       return false;
@@ -211,12 +225,33 @@ LILC::LilC_Compiler::parse( const char * const infile) {
    return true;
 }
 
+void LILC::LilC_Compiler::addGlobal(ASTList<DeclNode *>& decls,
+   DeclNode * decl)
+{
+   if ( ! useFlatAST ){
+      decls.push_back(decl);
+      return;
+   }
+   // decls stays empty, and nothing else on the parser's stack
+   // points into the AST arena between top-level declarations,
+   // so decl's tree can go as soon as it has been lowered
+   flatAST.addGlobal(decl->lower(flatAST));
+   astArena.reset();
+}
+
 bool LILC::LilC_Compiler::nameAnalysis(const char * const inF){
 	if (!this->parse(inF)){ return false; }
+	PhaseTimer timer(timeReport, "name analysis");
 	delete( symbolTable);
-	symbolTable = new SymbolTable();
+	symbolTable = new SymbolTable(nameTable);
 	
-	if (!this->astRoot->nameAnalysis(symbolTable)){
+	bool ok;
+	{
+		DiagnosticScope diagnostics(std::cerr);
+		ok = useFlatAST ? flatAST.nameAnalysis(symbolTable)
+			: astRoot->nameAnalysis(symbolTable);
+	}
+	if (!ok){
 		std::cerr << "Failed nameAnalysis!" << std::endl;
 		return false;
 	}
@@ -224,11 +259,58 @@ bool LILC::LilC_Compiler::nameAnalysis(const char * const inF){
 }
 
 bool LILC::LilC_Compiler::typeAnalysis(const char * const inF){
+	if (fusedAnalysis && !useFlatAST){
+		return this->semanticAnalysis(inF);
+	}
 	if (!this->nameAnalysis(inF)){ return false; }
-	return this->astRoot->typeAnalysis();
+	PhaseTimer timer(timeReport, "type analysis");
+	DiagnosticScope diagnostics(std::cerr);
+	if (useFlatAST){ return this->flatAST.typeAnalysis(jobs); }
+	return this->astRoot->typeAnalysis(jobs);
+}
+
+/*
+* Name and type analysis together (see semantic_analysis.cpp).
+* Name errors are reported as they are found; type errors wait
+* until the end, and only come out if there were no name errors,
+* just as if type analysis had only run after name analysis.
+*/
+bool LILC::LilC_Compiler::semanticAnalysis(const char * const inF){
+	if (!this->parse(inF)){ return false; }
+	PhaseTimer timer(timeReport, "semantic analysis");
+	delete( symbolTable);
+	symbolTable = new SymbolTable(nameTable);
+
+	SemanticState state = { symbolTable, nullptr, true };
+	Diagnostics typeErrs;
+	bool typesOk;
+	{
+		DiagnosticScope nameErrs(std::cerr);
+		Diagnostics * outerSink = TypeErr::sink();
+		TypeErr::sink() = &typeErrs;
+		try {
+			typesOk = astRoot->semanticAnalysis(state);
+		} catch (...) {
+			TypeErr::sink() = outerSink;
+			throw;
+		}
+		TypeErr::sink() = outerSink;
+	}
+
+	if (!state.namesOk){
+		std::cerr << "Failed nameAnalysis!" << std::endl;
+		return false;
+	}
+	typeErrs.flush(std::cerr);
+	return typesOk;
 }
 
 void LILC::LilC_Compiler::unparse(const char * const outF){
+	PhaseTimer timer(timeReport, "unparse");
 	std::ofstream out(outF);
+	if (useFlatAST){
+		this->flatAST.unparse(out, 0);
+		return;
+	}
 	this->astRoot->unparse(out, 0);
 }
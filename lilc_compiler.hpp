@@ -4,15 +4,26 @@
 #include <string>
 #include <cstddef>
 #include <istream>
+#include <ostream>
+#include <fstream>
 
 #include "lilc_scanner.hpp"
+#include "lilc_source.hpp"
+#include "lilc_arena.hpp"
+#include "lilc_token_source.hpp"
+#include "lilc_time_report.hpp"
 #include "tokens.hpp"
 #include "ast.hpp"
+#include "lilc_flat_ast.hpp"
 #include "grammar.hh"
 #include "symbol_table.hpp"
+#include "lilc_regalloc.hpp"
 
 namespace LILC{
 
+// Which scanner turns source text into tokens
+enum class ScannerKind { FLEX, DFA };
+
 class LilC_Compiler{
 public:
    LilC_Compiler() = default;
@@ -22,18 +33,93 @@ public:
    void setASTRoot(ProgramNode * root){ this->astRoot = root; }
    ProgramNode * getASTRoot(){ return this->astRoot; }
 
+   // Where the parser allocates AST nodes and their lists; see
+   // the comment on ASTList in ast.hpp
+   Arena& nodeArena(){ return this->astArena; }
+   template <typename T>
+   ASTList<T> newList(){
+      return ASTList<T>(ArenaAllocator<T>(astArena));
+   }
+   // The parser hands each top-level declaration over here, to
+   // go in the program's list or be lowered into the FlatAST
+   void addGlobal(ASTList<DeclNode *>& decls, DeclNode * decl);
+
+   // Lower the AST into a FlatAST while parsing and run the
+   // later phases over that (lilcc -fflat-ast)
+   void setFlatAST(bool flat){ this->useFlatAST = flat; }
+   FlatAST& getFlatAST(){ return this->flatAST; }
+
+   // Type check function bodies on up to this many threads
+   // (lilcc -j N); diagnostics come out as they would serially
+   void setJobs(unsigned jobsIn){ this->jobs = jobsIn; }
+
+   // Resolve names and check types in a single walk of the AST
+   // (lilcc -ffused-sema), with the same diagnostics as the two
+   // passes. Only the tree AST has the fused pass, and it runs
+   // on one thread, whatever setJobs says.
+   void setFusedAnalysis(bool fused){ this->fusedAnalysis = fused; }
+
+   // Scan from an mmap'd copy of the input (the default) or, if
+   // false, through an std::ifstream as flex normally would.
+   // Inputs that turn out to be token streams written by
+   // emitTokens are replayed instead of being scanned, either way.
+   void setMappedInput(bool mapped){ this->mappedInput = mapped; }
+
+   // The flex scanner (the default) or the hand-written one in
+   // lilc_dfa_scanner.hpp. The latter always reads through a
+   // SourceFile, whatever setMappedInput says.
+   void setScanner(ScannerKind kind){ this->scannerKind = kind; }
+
+   // If set, each phase that runs adds its costs to report
+   // (lilcc -ftime-report). The compiler doesn't own it.
+   void setTimeReport(TimeReport * report){ this->timeReport = report; }
+
+   // Optimize the generated code at this level (lilcc -O1),
+   // reporting what that did on report if it isn't null (lilcc
+   // -fopt-report). The compiler doesn't own report.
+   void setOptLevel(unsigned level){ this->optLevel = level; }
+   void setOptReport(std::ostream * report){ this->optReport = report; }
+   // Generate code with values in virtual registers, allocated
+   // this way, rather than on the stack (lilcc -fregalloc)
+   void setRegAlloc(RegAlloc alloc){ this->regAlloc = alloc; }
+
    void scan( const char * const filename, const char * outfile);
+   bool emitTokens( const char * const filename, const char * outfile);
    bool parse( const char * const filename );
    void unparse(const char * const outF);
    bool nameAnalysis( const char * const filename );
    bool typeAnalysis( const char * const filename );
+   bool semanticAnalysis( const char * const filename );
    bool codeGen(const char * const inFile, 
 	const char * const outFile);
 private:
+   bool openScanner( const char * const filename );
+
    LILC::LilC_Parser  *parser  = nullptr;
-   LILC::LilC_Scanner *scanner = nullptr;
+   LILC::TokenSource  *scanner = nullptr;
    ProgramNode * astRoot = nullptr;
    SymbolTable * symbolTable = nullptr;
+   SourceFile * source = nullptr;
+   std::ifstream * inStream = nullptr;
+   bool mappedInput = true;
+   ScannerKind scannerKind = ScannerKind::FLEX;
+   TimeReport * timeReport = nullptr;
+   // Every identifier this compiler has seen. Tokens, both ASTs
+   // and the symbol table hold Names in it, so it lasts as long as
+   // the compiler does.
+   NameTable nameTable;
+   bool useFlatAST = false;
+   FlatAST flatAST{nameTable};
+   unsigned jobs = 1;
+   bool fusedAnalysis = false;
+   unsigned optLevel = 0;
+   std::ostream * optReport = nullptr;
+   RegAlloc regAlloc = RegAlloc::NONE;
+   // Every token the scanner produces lives here until the end
+   // of the parse (the AST copies out what it keeps)
+   Arena tokenArena;
+   // The current AST, until the next parse
+   Arena astArena;
 };
 
 } /* end namespace */
@@ -0,0 +1,381 @@
+#include <cstring>
+
+#include "err.hpp"
+#include "lilc_names.hpp"
+#include "lilc_simd.hpp"
+#include "lilc_dfa_scanner.hpp"
+
+using TokenTag = LILC::LilC_Parser::token;
+
+namespace LILC{
+
+// ***************************************************************
+// Character classes
+// ***************************************************************
+
+enum CharClass : unsigned char {
+	CC_OTHER = 0,
+	CC_IDSTART = 1,	// [a-zA-Z_]
+	CC_DIGIT = 2,	// [0-9]
+};
+
+struct CharClassTable{
+	unsigned char cls[256];
+};
+
+static constexpr CharClassTable buildCharClasses(){
+	CharClassTable t{};
+	for (int c = 'a'; c <= 'z'; c++){ t.cls[c] = CC_IDSTART; }
+	for (int c = 'A'; c <= 'Z'; c++){ t.cls[c] = CC_IDSTART; }
+	t.cls[static_cast<int>('_')] = CC_IDSTART;
+	for (int c = '0'; c <= '9'; c++){ t.cls[c] = CC_DIGIT; }
+	return t;
+}
+
+static constexpr CharClassTable CHAR_CLASSES = buildCharClasses();
+
+static inline unsigned char charClass(char c){
+	return CHAR_CLASSES.cls[static_cast<unsigned char>(c)];
+}
+
+// Characters that may follow a backslash in a string literal
+static inline bool isEscapedChar(char c){
+	switch (c){
+	case 'n': case 't': case '\'': case '"': case '?': case '\\':
+		return true;
+	default:
+		return false;
+	}
+}
+
+// ***************************************************************
+// Keywords
+//
+// h(kw) = (length + first byte + last byte) mod 32 happens to be
+// collision-free over the twelve keywords, so a lookup is one
+// hash, one length check and one memcmp. The static_assert below
+// keeps it that way if the keyword set ever changes.
+// ***************************************************************
+
+struct Keyword{
+	const char * text;
+	size_t len;
+	int tag;
+};
+
+static constexpr Keyword KEYWORDS[] = {
+	{ "bool", 4, TokenTag::BOOL },
+	{ "void", 4, TokenTag::VOID },
+	{ "int", 3, TokenTag::INT },
+	{ "true", 4, TokenTag::TRUE },
+	{ "false", 5, TokenTag::FALSE },
+	{ "struct", 6, TokenTag::STRUCT },
+	{ "input", 5, TokenTag::INPUT },
+	{ "output", 6, TokenTag::OUTPUT },
+	{ "if", 2, TokenTag::IF },
+	{ "else", 4, TokenTag::ELSE },
+	{ "while", 5, TokenTag::WHILE },
+	{ "return", 6, TokenTag::RETURN },
+};
+
+static const size_t KEYWORD_SLOTS = 32;
+
+static constexpr size_t keywordHash(const char * text, size_t len){
+	return (len + static_cast<unsigned char>(text[0])
+		+ static_cast<unsigned char>(text[len - 1]))
+		& (KEYWORD_SLOTS - 1);
+}
+
+struct KeywordTable{
+	Keyword slots[KEYWORD_SLOTS];
+	bool perfect;
+};
+
+static constexpr KeywordTable buildKeywordTable(){
+	KeywordTable t{};
+	t.perfect = true;
+	for (const Keyword& kw : KEYWORDS){
+		Keyword& slot = t.slots[keywordHash(kw.text, kw.len)];
+		if (slot.text != nullptr){ t.perfect = false; }
+		slot = kw;
+	}
+	return t;
+}
+
+static constexpr KeywordTable KEYWORD_TABLE = buildKeywordTable();
+static_assert(KEYWORD_TABLE.perfect,
+	"keywordHash has a collision; pick a different hash");
+
+// The keyword tag for the given word, or 0 if it's an identifier
+static inline int keywordTag(const char * text, size_t len){
+	const Keyword& slot = KEYWORD_TABLE.slots[keywordHash(text, len)];
+	if (slot.len == len && std::memcmp(slot.text, text, len) == 0){
+		return slot.tag;
+	}
+	return 0;
+}
+
+// ***************************************************************
+// The scanner
+// ***************************************************************
+
+LilC_DFAScanner::LilC_DFAScanner(
+	const char * begin,
+	const char * endIn,
+	Arena& arena,
+	NameTable& names
+) : cur(begin), end(endIn), tokenArena(arena), nameTable(names) { }
+
+void LilC_DFAScanner::warn(size_t lineNumIn, size_t charNumIn,
+	std::string msg)
+{
+	Err::warn(SourcePos(lineNumIn, charNumIn), msg);
+}
+
+void LilC_DFAScanner::error(size_t lineNumIn, size_t charNumIn,
+	std::string msg)
+{
+	Err::report(SourcePos(lineNumIn, charNumIn), msg);
+}
+
+int LilC_DFAScanner::produceNullaryToken(Token ** const lval,
+	int tag, size_t len)
+{
+	*lval =
+		new (tokenArena) NullaryToken(lineNum, charNum, tag);
+	charNum += len;
+	cur += len;
+	return tag;
+}
+
+int LilC_DFAScanner::scanWord(Token ** const lval){
+	const char * start = cur;
+	cur = LilC_Simd::skipIdentChars(cur + 1, end);
+	size_t len = static_cast<size_t>(cur - start);
+
+	int tag = keywordTag(start, len);
+	if (tag != 0){
+		*lval =
+			new (tokenArena) NullaryToken(lineNum, charNum, tag);
+	} else {
+		tag = TokenTag::ID;
+		*lval = new (tokenArena) IDToken(lineNum, charNum,
+			nameTable.intern(start, len));
+	}
+	charNum += len;
+	return tag;
+}
+
+int LilC_DFAScanner::scanNumber(Token ** const lval){
+	const char * start = cur;
+	int intVal;
+	bool overflow;
+	cur = IntLitToken::convert(cur, end, intVal, overflow);
+	if (overflow){
+		warn(lineNum, charNum,
+			"Integer literal too large; using max value");
+	}
+	*lval = new (tokenArena) IntLitToken(
+		lineNum, charNum, intVal);
+	charNum += static_cast<size_t>(cur - start);
+	return TokenTag::INTLITERAL;
+}
+
+/*
+* lilc.l has four overlapping rules for string literals: a good
+* one, an unterminated one, one with a bad escape and one that is
+* both. flex picks whichever matches the most input (the earlier
+* rule on a tie), so this works out the longest match the same
+* way. Returns true with tag set if yylex should return (the good
+* literal, or 0 for the two rules that end the token stream), and
+* false if scanning should just carry on.
+*/
+bool LilC_DFAScanner::scanString(Token ** const lval, int& tag){
+	const char * start = cur;
+	const char * p = cur + 1;
+
+	//Scan the part made of ordinary chars and good escapes
+	while (p < end && *p != '"' && *p != '\n'){
+		if (*p == '\\'){
+			if (p + 1 < end && isEscapedChar(p[1])){
+				p += 2;
+				continue;
+			}
+			break;
+		}
+		p++;
+	}
+
+	if (p < end && *p == '"'){
+		p++;
+		size_t len = static_cast<size_t>(p - start);
+		*lval = new (tokenArena) StringLitToken(
+			lineNum, charNum, TokenText{start, len});
+		charNum += len;
+		cur = p;
+		tag = TokenTag::STRINGLITERAL;
+		return true;
+	}
+
+	const char * unterminatedBadEnd;
+	const char * badEnd = nullptr;
+	if (p == end || *p == '\n'){
+		error(lineNum, charNum, "unterminated string literal ignored");
+		charNum += static_cast<size_t>(p - start);
+		cur = p;
+		tag = 0;
+		return true;
+	} else if (p + 1 == end || p[1] == '\n'){
+		//A lone backslash at the end of the line
+		unterminatedBadEnd = p + 1;
+	} else {
+		//p[1] is a bad escape. The bad-escape rule runs to the
+		// next quote on the line (escaped or not); the
+		// unterminated one takes good escapes and ordinary
+		// chars, and then maybe one last backslash.
+		const char * q = p + 2;
+		while (q < end && *q != '\n'){
+			if (*q == '"'){ badEnd = q + 1; break; }
+			q++;
+		}
+		q = p + 2;
+		while (q < end && *q != '"' && *q != '\n'){
+			if (*q == '\\'){
+				if (q + 1 < end && isEscapedChar(q[1])){
+					q += 2;
+					continue;
+				}
+				q++;
+				break;
+			}
+			q++;
+		}
+		unterminatedBadEnd = q;
+	}
+
+	if (badEnd != nullptr && badEnd >= unterminatedBadEnd){
+		error(lineNum, charNum,
+			"string literal with bad escaped character ignored");
+		charNum += static_cast<size_t>(badEnd - start);
+		cur = badEnd;
+		tag = 0;
+		return true;
+	}
+	charNum += static_cast<size_t>(unterminatedBadEnd - start);
+	cur = unterminatedBadEnd;
+	error(lineNum, charNum, "unterminated string literal with bad"
+		"escaped character ignored");
+	return false;
+}
+
+int LilC_DFAScanner::yylex(Token ** const lval){
+	while (cur < end){
+		char c = *cur;
+		char next = cur + 1 < end ? cur[1] : '\0';
+		switch (c){
+		case '\n':
+			lineNum++;
+			charNum = 1;
+			cur++;
+			continue;
+		case ' ':
+		case '\t':
+			{
+			const char * start = cur;
+			cur = LilC_Simd::skipBlanks(cur + 1, end);
+			charNum += static_cast<size_t>(cur - start);
+			continue;
+			}
+		case '/':
+			if (next != '/'){
+				return produceNullaryToken(lval,
+					TokenTag::DIVIDE, 1);
+			}
+			//A // comment, same as #
+			/* fall through */
+		case '#':
+			{
+			//Like lilc.l, comments don't advance charNum
+			cur = LilC_Simd::skipToNewline(cur + 1, end);
+			continue;
+			}
+		case '"':
+			{
+			int tag;
+			if (scanString(lval, tag)){ return tag; }
+			continue;
+			}
+		case '{': return produceNullaryToken(lval, TokenTag::LCURLY, 1);
+		case '}': return produceNullaryToken(lval, TokenTag::RCURLY, 1);
+		case '(': return produceNullaryToken(lval, TokenTag::LPAREN, 1);
+		case ')': return produceNullaryToken(lval, TokenTag::RPAREN, 1);
+		case ';': return produceNullaryToken(lval, TokenTag::SEMICOLON, 1);
+		case ',': return produceNullaryToken(lval, TokenTag::COMMA, 1);
+		case '.': return produceNullaryToken(lval, TokenTag::DOT, 1);
+		case '*': return produceNullaryToken(lval, TokenTag::TIMES, 1);
+		case '<':
+			if (next == '<'){
+				return produceNullaryToken(lval, TokenTag::WRITE, 2);
+			}
+			if (next == '='){
+				return produceNullaryToken(lval, TokenTag::LESSEQ, 2);
+			}
+			return produceNullaryToken(lval, TokenTag::LESS, 1);
+		case '>':
+			if (next == '>'){
+				return produceNullaryToken(lval, TokenTag::READ, 2);
+			}
+			if (next == '='){
+				return produceNullaryToken(lval,
+					TokenTag::GREATEREQ, 2);
+			}
+			return produceNullaryToken(lval, TokenTag::GREATER, 1);
+		case '+':
+			if (next == '+'){
+				return produceNullaryToken(lval,
+					TokenTag::PLUSPLUS, 2);
+			}
+			return produceNullaryToken(lval, TokenTag::PLUS, 1);
+		case '-':
+			if (next == '-'){
+				return produceNullaryToken(lval,
+					TokenTag::MINUSMINUS, 2);
+			}
+			return produceNullaryToken(lval, TokenTag::MINUS, 1);
+		case '!':
+			if (next == '='){
+				return produceNullaryToken(lval,
+					TokenTag::NOTEQUALS, 2);
+			}
+			return produceNullaryToken(lval, TokenTag::NOT, 1);
+		case '=':
+			if (next == '='){
+				return produceNullaryToken(lval, TokenTag::EQUALS, 2);
+			}
+			return produceNullaryToken(lval, TokenTag::ASSIGN, 1);
+		case '&':
+			if (next == '&'){
+				return produceNullaryToken(lval, TokenTag::AND, 2);
+			}
+			break;
+		case '|':
+			if (next == '|'){
+				return produceNullaryToken(lval, TokenTag::OR, 2);
+			}
+			break;
+		default:
+			if (charClass(c) == CC_IDSTART){ return scanWord(lval); }
+			if (charClass(c) == CC_DIGIT){ return scanNumber(lval); }
+			break;
+		}
+
+		std::string msg = "Illegal character ";
+		if (c != '\0'){ msg += c; } //flex appends yytext as a C string
+		error(lineNum, charNum, msg);
+		charNum++;
+		cur++;
+	}
+	return TokenTag::END;
+}
+
+} // End namespace LILC
@@ -0,0 +1,55 @@
+#ifndef __LILC_DFA_SCANNER_HPP__
+#define __LILC_DFA_SCANNER_HPP__ 1
+
+#include <cstddef>
+#include <string>
+
+#include "grammar.hh"
+#include "tokens.hpp"
+#include "lilc_arena.hpp"
+#include "lilc_names.hpp"
+#include "lilc_token_source.hpp"
+
+namespace LILC{
+
+/*
+* A hand-written scanner for the same token language as lilc.l,
+* selected with --scanner=dfa. Rather than running flex's tables
+* it switches on the first byte of each lexeme and then loops over
+* the rest of it, reading straight out of an in-memory copy of the
+* source (normally a mapped SourceFile). Keywords are found with a
+* perfect hash computed at compile time. Runs of blanks, comment
+* bodies and identifiers are skipped with the vector helpers in
+* lilc_simd.hpp.
+*
+* Tokens, positions and diagnostics are meant to be exactly those
+* of LilC_Scanner; any difference is a bug in one or the other.
+*/
+class LilC_DFAScanner : public TokenSource{
+public:
+	LilC_DFAScanner(const char * begin, const char * end,
+		Arena& arena, NameTable& names);
+
+	int yylex(Token ** const lval) override;
+
+private:
+	int produceNullaryToken(
+		Token ** const lval,
+		int tag, size_t len);
+	int scanWord(Token ** const lval);
+	int scanNumber(Token ** const lval);
+	bool scanString(Token ** const lval,
+		int& tag);
+	void warn(size_t lineNumIn, size_t charNumIn, std::string msg);
+	void error(size_t lineNumIn, size_t charNumIn, std::string msg);
+
+	const char * cur;
+	const char * end;
+	Arena& tokenArena;
+	NameTable& nameTable;
+	size_t lineNum = 1;
+	size_t charNum = 1;
+};
+
+} /* end namespace */
+#endif /* END __LILC_DFA_SCANNER_HPP__ */
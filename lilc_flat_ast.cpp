@@ -0,0 +1,133 @@
+#include "err.hpp"
+#include "lilc_flat_ast.hpp"
+
+namespace LILC{
+
+const FlatAST::Index FlatAST::NONE = UINT32_MAX;
+
+/*
+* A position is packed as the line in bits 10-30 and the column
+* in bits 0-9. One that doesn't fit has bit 31 set and the rest
+* indexes widePositions instead.
+*/
+static const uint32_t WIDE_POSITION = 1u << 31;
+static const unsigned COL_BITS = 10;
+static const size_t MAX_PACKED_LINE = (WIDE_POSITION >> COL_BITS) - 1;
+static const size_t MAX_PACKED_COL = (1u << COL_BITS) - 1;
+
+void FlatAST::clear(){
+	kinds.clear();
+	positions.clear();
+	lhss.clear();
+	rhss.clear();
+	extra.clear();
+	globals.clear();
+	symbols.clear();
+	types.clear();
+	widePositions.clear();
+	strings.clear();
+}
+
+uint32_t FlatAST::packPosition(size_t line, size_t col){
+	if (line <= MAX_PACKED_LINE && col <= MAX_PACKED_COL){
+		return static_cast<uint32_t>(line << COL_BITS | col);
+	}
+	widePositions.push_back(std::make_pair(line, col));
+	return WIDE_POSITION
+		| static_cast<uint32_t>(widePositions.size() - 1);
+}
+
+FlatAST::Index FlatAST::add(NodeKind kind, size_t line, size_t col,
+	uint32_t lhs, uint32_t rhs)
+{
+	if (kinds.size() >= NONE){
+		throw InternalError("Too many AST nodes for 32-bit indices");
+	}
+	kinds.push_back(kind);
+	positions.push_back(packPosition(line, col));
+	lhss.push_back(lhs);
+	rhss.push_back(rhs);
+	return static_cast<Index>(kinds.size() - 1);
+}
+
+FlatAST::Index FlatAST::addId(Name name, size_t line, size_t col){
+	symbols.push_back(nullptr);
+	return add(NodeKind::ID, line, col, name.id(),
+		static_cast<uint32_t>(symbols.size() - 1));
+}
+
+FlatAST::Index FlatAST::addStrLit(TokenText text,
+	size_t line, size_t col)
+{
+	uint32_t offset = static_cast<uint32_t>(strings.size());
+	strings.append(text.data, text.size);
+	return add(NodeKind::STR_LIT, line, col, offset,
+		static_cast<uint32_t>(text.size));
+}
+
+FlatAST::Index FlatAST::reserve(size_t words){
+	Index at = static_cast<Index>(extra.size());
+	extra.resize(extra.size() + words);
+	return at;
+}
+
+FlatAST::Index FlatAST::reserveList(size_t length){
+	Index at = reserve(length + 1);
+	extra[at] = static_cast<uint32_t>(length);
+	return at;
+}
+
+size_t FlatAST::getLine(Index node) const {
+	uint32_t pos = positions[node];
+	if (pos & WIDE_POSITION){
+		return widePositions[pos & ~WIDE_POSITION].first;
+	}
+	return pos >> COL_BITS;
+}
+
+size_t FlatAST::getCol(Index node) const {
+	uint32_t pos = positions[node];
+	if (pos & WIDE_POSITION){
+		return widePositions[pos & ~WIDE_POSITION].second;
+	}
+	return pos & MAX_PACKED_COL;
+}
+
+std::string FlatAST::getTypeString(Index type) const {
+	switch (kinds[type]){
+		case NodeKind::INT_TYPE:
+			return "int";
+		case NodeKind::BOOL_TYPE:
+			return "bool";
+		case NodeKind::VOID_TYPE:
+			return "void";
+		case NodeKind::STRUCT_TYPE:
+			return getName(lhss[type]).str();
+		default:
+			throw InternalError("getTypeString of a non-type node");
+	}
+}
+
+size_t FlatAST::bytesUsed() const {
+	return kinds.size() * sizeof(NodeKind)
+		+ (positions.size() + lhss.size()
+			+ rhss.size() + extra.size()) * sizeof(uint32_t)
+		+ globals.size() * sizeof(Index)
+		+ symbols.size() * sizeof(SymbolTableEntry *)
+		+ types.size() * sizeof(const Type *)
+		+ widePositions.size() * sizeof(widePositions[0])
+		+ strings.size();
+}
+
+size_t FlatAST::bytesReserved() const {
+	return kinds.capacity() * sizeof(NodeKind)
+		+ (positions.capacity() + lhss.capacity()
+			+ rhss.capacity() + extra.capacity()) * sizeof(uint32_t)
+		+ globals.capacity() * sizeof(Index)
+		+ symbols.capacity() * sizeof(SymbolTableEntry *)
+		+ types.capacity() * sizeof(const Type *)
+		+ widePositions.capacity() * sizeof(widePositions[0])
+		+ strings.capacity();
+}
+
+} // End namespace LILC
@@ -0,0 +1,205 @@
+#ifndef __LILC_FLAT_AST_HPP__
+#define __LILC_FLAT_AST_HPP__ 1
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "err.hpp"
+#include "lilc_names.hpp"
+#include "tokens.hpp"
+
+namespace LILC{
+
+class SymbolTable;
+class SymbolTableEntry;
+class Type;
+class CodeGen;
+
+/*
+* A compact form of the AST (lilcc -fflat-ast). Rather than one
+* heap object per node, each node is an entry in a few parallel
+* arrays: its kind, its packed source position and two 32-bit
+* operands, usually the indices of its children. Children with
+* more than two parts, and lists of children, are kept in the
+* extra array and referred to by their index there. The parser
+* still builds ASTNode trees, but only one top-level declaration
+* at a time: each is lowered into the FlatAST as soon as it is
+* reduced (see ASTNode::lower) and its tree thrown away.
+*
+* The operands of each kind of node:
+*
+*  kind                lhs                 rhs
+*  VAR_DECL            type                id
+*  FORMAL_DECL         type                id
+*  FN_DECL             id                  [type, formals list, block]
+*  STRUCT_DECL         id                  fields list
+*  INT_TYPE, BOOL_TYPE, VOID_TYPE          -
+*  STRUCT_TYPE         id                  -
+*  ASSIGN_STMT         ASSIGN exp          -
+*  POST_INC, POST_DEC, READ, WRITE, CALL_STMT
+*                      exp                 -
+*  IF, WHILE           condition           block
+*  IF_ELSE             condition           [then block, else block]
+*  RETURN              exp or NONE         -
+*  ID                  name id             symbol slot
+*  INT_LIT             value               -
+*  STR_LIT             offset of the text  length of the text
+*  TRUE_LIT, FALSE_LIT -                   -
+*  DOT                 exp                 field id
+*  ASSIGN              lhs exp             rhs exp
+*  CALL                id                  args list
+*  NEG, NOT            exp                 -
+*  PLUS ... GREATER_EQ lhs exp             rhs exp
+*
+* where [...] is a record of consecutive words in extra, a list
+* is its length followed by its items, and a block is a record
+* [decls list, stmts list].
+*
+* The passes mirror those on the ASTNode tree, down to the order
+* in which they report errors, and share its type rules (see
+* LilC_Types).
+*/
+class FlatAST{
+public:
+	using Index = uint32_t;
+	// The missing expression of a bare return
+	static const Index NONE;
+
+	enum class NodeKind : uint8_t {
+		VAR_DECL, FORMAL_DECL, FN_DECL, STRUCT_DECL,
+		INT_TYPE, BOOL_TYPE, VOID_TYPE, STRUCT_TYPE,
+		ASSIGN_STMT, POST_INC, POST_DEC, READ, WRITE,
+		IF, IF_ELSE, WHILE, CALL_STMT, RETURN,
+		ID, INT_LIT, STR_LIT, TRUE_LIT, FALSE_LIT,
+		DOT, ASSIGN, CALL, NEG, NOT,
+		PLUS, MINUS, TIMES, DIVIDE, AND, OR,
+		EQUALS, NOT_EQUALS, LESS, GREATER, LESS_EQ, GREATER_EQ
+	};
+
+	// The items of a list in extra
+	class List{
+	public:
+		List(const Index * firstIn, size_t sizeIn)
+		: first(firstIn), count(sizeIn) { }
+		const Index * begin() const { return first; }
+		const Index * end() const { return first + count; }
+		size_t size() const { return count; }
+	private:
+		const Index * first;
+		size_t count;
+	};
+
+	// IDs are kept by Name::id(), in names
+	explicit FlatAST(const NameTable& namesIn) : names(namesIn) { }
+
+	void clear();
+
+	// Building (see flat_lowering.cpp)
+	Index add(NodeKind kind, size_t line, size_t col,
+		uint32_t lhs = 0, uint32_t rhs = 0);
+	Index addId(Name name, size_t line, size_t col);
+	Index addStrLit(TokenText text, size_t line, size_t col);
+	// Room for a record of the given number of words, or a
+	// list of the given length, for the caller to fill in
+	Index reserve(size_t words);
+	Index reserveList(size_t length);
+	void setExtra(Index at, uint32_t value){ extra[at] = value; }
+	void setListItem(Index list, size_t k, Index item){
+		extra[list + 1 + k] = item;
+	}
+	void addGlobal(Index decl){ globals.push_back(decl); }
+
+	// Reading
+	NodeKind kind(Index node) const { return kinds[node]; }
+	uint32_t lhs(Index node) const { return lhss[node]; }
+	uint32_t rhs(Index node) const { return rhss[node]; }
+	uint32_t extraAt(Index at) const { return extra[at]; }
+	List list(Index list) const {
+		return List(extra.data() + list + 1, extra[list]);
+	}
+	const std::vector<Index>& getGlobals() const { return globals; }
+
+	// The parts of records
+	Index fnRetType(Index fn) const { return extra[rhss[fn]]; }
+	Index fnFormals(Index fn) const { return extra[rhss[fn] + 1]; }
+	Index fnBody(Index fn) const { return extra[rhss[fn] + 2]; }
+	Index blockDecls(Index block) const { return extra[block]; }
+	Index blockStmts(Index block) const { return extra[block + 1]; }
+	Index thenBlock(Index stmt) const {
+		if (kinds[stmt] == NodeKind::IF_ELSE){
+			return extra[rhss[stmt]];
+		}
+		return rhss[stmt];
+	}
+	Index elseBlock(Index ifElse) const {
+		return extra[rhss[ifElse] + 1];
+	}
+
+	size_t getLine(Index node) const;
+	size_t getCol(Index node) const;
+	SourcePos pos(Index node) const {
+		return SourcePos(getLine(node), getCol(node));
+	}
+	Name getName(Index id) const {
+		return names.byId(lhss[id]);
+	}
+	SymbolTableEntry * getSymbol(Index id) const {
+		return symbols[rhss[id]];
+	}
+	void setSymbol(Index id, SymbolTableEntry * symbol){
+		symbols[rhss[id]] = symbol;
+	}
+	// What type analysis found an expression's type to be, as
+	// for ExpNode::getType
+	const Type * getType(Index exp) const {
+		return exp < types.size() ? types[exp] : nullptr;
+	}
+	void setType(Index exp, const Type * type){ types[exp] = type; }
+	int getInt(Index intLit) const {
+		return static_cast<int>(lhss[intLit]);
+	}
+	TokenText getText(Index strLit) const {
+		return TokenText{ strings.data() + lhss[strLit], rhss[strLit] };
+	}
+	// "int", "bool", "void" or the struct's name
+	std::string getTypeString(Index type) const;
+
+	size_t numNodes() const { return kinds.size(); }
+	// What the nodes take, and what the arrays have allocated,
+	// as for Arena::bytesUsed and Arena::bytesReserved
+	size_t bytesUsed() const;
+	size_t bytesReserved() const;
+
+	// The passes, as on ProgramNode
+	bool nameAnalysis(SymbolTable * symTab);
+	// With the functions checked on up to jobs threads
+	bool typeAnalysis(unsigned jobs = 1);
+	void unparse(std::ostream& out, int indent);
+	void codeGen(CodeGen& gen);
+
+private:
+	uint32_t packPosition(size_t line, size_t col);
+
+	const NameTable& names;
+	std::vector<NodeKind> kinds;
+	std::vector<uint32_t> positions;
+	std::vector<uint32_t> lhss;
+	std::vector<uint32_t> rhss;
+	std::vector<uint32_t> extra;
+	std::vector<Index> globals;
+	// What name analysis binds each ID to
+	std::vector<SymbolTableEntry *> symbols;
+	// Indexed by node, and only there once type analysis has run
+	std::vector<const Type *> types;
+	// Positions whose line or column is too big to pack
+	std::vector<std::pair<size_t, size_t>> widePositions;
+	// The text of every string literal, back to back
+	std::string strings;
+};
+
+} /* end namespace */
+#endif /* END __LILC_FLAT_AST_HPP__ */
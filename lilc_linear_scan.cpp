@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include "lilc_regalloc.hpp"
+
+namespace LILC{
+
+/*
+* Points in the code are numbered twice as finely as the
+* instructions, so that an interval that ends with a use at
+* instruction i (point 2i) is over before one that starts with a
+* def there (point 2i + 1), and the two can share a register.
+* An interval has no holes: it covers every point from the first
+* at which its register is live or set to the last.
+*/
+struct Interval{
+	size_t virt;
+	size_t start;
+	size_t end;
+	Reg reg;
+};
+
+static bool isCalleeSaved(Reg reg){
+	return std::find(CALLEE_SAVED.begin(), CALLEE_SAVED.end(), reg)
+		!= CALLEE_SAVED.end();
+}
+
+Allocation LinearScan::allocate(MipsFunction& fn, int firstSlot){
+	const std::vector<Instr>& code = fn.code;
+	size_t numVirtuals = fn.numVirtuals;
+	std::vector<size_t> start(numVirtuals, SIZE_MAX);
+	std::vector<size_t> end(numVirtuals, 0);
+	auto extend = [&](size_t virt, size_t point){
+		start[virt] = std::min(start[virt], point);
+		end[virt] = std::max(end[virt], point);
+	};
+
+	Liveness live(fn);
+	const std::vector<Liveness::Block>& blocks = live.getBlocks();
+	for (size_t b = 0; b < blocks.size(); b++){
+		size_t first = 2 * blocks[b].first;
+		size_t last = 2 * blocks[b].last + 1;
+		live.forLiveIn(b, [&](size_t virt){ extend(virt, first); });
+		live.forLiveOut(b, [&](size_t virt){ extend(virt, last); });
+	}
+	std::vector<size_t> calls;
+	for (size_t i = 0; i < code.size(); i++){
+		const Instr& instr = code[i];
+		for (Reg reg : { instr.rs, instr.rt }){
+			if (isVirtual(reg) && instr.reads(reg)){
+				extend(virtualIndex(reg), 2 * i);
+			}
+		}
+		if (isVirtual(instr.written())){
+			extend(virtualIndex(instr.written()), 2 * i + 1);
+		}
+		if (instr.op == Opcode::JAL){ calls.push_back(2 * i); }
+	}
+
+	std::vector<Interval> intervals;
+	for (size_t virt = 0; virt < numVirtuals; virt++){
+		if (start[virt] <= end[virt]){
+			intervals.push_back(
+				Interval{ virt, start[virt], end[virt], Reg::ZERO });
+		}
+	}
+	std::sort(intervals.begin(), intervals.end(),
+		[](const Interval& a, const Interval& b){
+			return a.start < b.start;
+		});
+
+	// Taken from the back, so in the order they're listed
+	std::vector<Reg> freeCaller(CALLER_SAVED.rbegin(), CALLER_SAVED.rend());
+	std::vector<Reg> freeCallee(CALLEE_SAVED.rbegin(), CALLEE_SAVED.rend());
+	std::vector<bool> calleeUsed(CALLEE_SAVED.size(), false);
+	// Those holding registers, by increasing end
+	std::vector<Interval *> active;
+
+	for (Interval& cur : intervals){
+		size_t expired = 0;
+		while (expired < active.size() && active[expired]->end < cur.start){
+			Reg reg = active[expired++]->reg;
+			(isCalleeSaved(reg) ? freeCallee : freeCaller).push_back(reg);
+		}
+		active.erase(active.begin(),
+			active.begin() + static_cast<std::ptrdiff_t>(expired));
+
+		auto call = std::upper_bound(calls.begin(), calls.end(), cur.start);
+		bool spansCall = call != calls.end() && *call < cur.end;
+
+		if (!spansCall && !freeCaller.empty()){
+			cur.reg = freeCaller.back();
+			freeCaller.pop_back();
+		} else if (!freeCallee.empty()){
+			cur.reg = freeCallee.back();
+			freeCallee.pop_back();
+		} else {
+			// Spill whichever ends last, of cur and the intervals
+			// holding a register cur could have
+			auto victim = active.end();
+			for (auto a = active.begin(); a != active.end(); a++){
+				if ((!spansCall || isCalleeSaved((*a)->reg))
+					&& (victim == active.end() || (*a)->end > (*victim)->end))
+				{
+					victim = a;
+				}
+			}
+			if (victim == active.end() || (*victim)->end <= cur.end){
+				continue;
+			}
+			cur.reg = (*victim)->reg;
+			(*victim)->reg = Reg::ZERO;
+			active.erase(victim);
+		}
+
+		if (isCalleeSaved(cur.reg)){
+			calleeUsed[static_cast<size_t>(std::find(CALLEE_SAVED.begin(),
+				CALLEE_SAVED.end(), cur.reg) - CALLEE_SAVED.begin())] = true;
+		}
+		active.insert(std::upper_bound(active.begin(), active.end(), &cur,
+			[](const Interval * a, const Interval * b){
+				return a->end < b->end;
+			}), &cur);
+	}
+
+	Allocation allocation;
+	std::vector<Reg> assigned(numVirtuals, Reg::ZERO);
+	std::vector<int> slots(numVirtuals, 0);
+	for (const Interval& interval : intervals){
+		assigned[interval.virt] = interval.reg;
+		if (interval.reg == Reg::ZERO){
+			slots[interval.virt] = firstSlot - allocation.spillSize;
+			allocation.spillSize += 4;
+			allocation.numSpilled++;
+		}
+	}
+	for (size_t i = 0; i < CALLEE_SAVED.size(); i++){
+		if (calleeUsed[i]){ allocation.saved.push_back(CALLEE_SAVED[i]); }
+	}
+	rewriteVirtuals(fn, assigned, slots);
+	return allocation;
+}
+
+} // End namespace LILC
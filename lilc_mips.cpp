@@ -1,131 +1,162 @@
 #include <string>
 #include "lilc_mips.hpp"
 #include "err.hpp"
-#include "ast.hpp"
-#include "symbol_table.hpp"
-#include "lilc_compiler.hpp"
 
 namespace LILC{
 
-const std::string LilC_Backend::TRUE = "1";
-const std::string LilC_Backend::FALSE = "0";
-
-const std::string LilC_Backend::FP = "$fp";
-const std::string LilC_Backend::SP = "$sp";
-const std::string LilC_Backend::RA = "$ra";
-const std::string LilC_Backend::V0 = "$v0";
-const std::string LilC_Backend::V1 = "$v1";
-const std::string LilC_Backend::A0 = "$a0";
-const std::string LilC_Backend::T0 = "$t0";
-const std::string LilC_Backend::T1 = "$t1";
-
-void LilC_Backend::generateWithComment(
-	std::string opcode, 
-	std::string comment,
-	std::string arg1, 
-	std::string arg2, 
-	std::string arg3
-) {
-        int space = MAXLEN - opcode.length() + 2;
-    
-        out << "\t" + opcode;
-        if (arg1 != "") {
-            for (int k = 1; k <= space; k++) 
-                out << " ";
-            out << arg1;
-            if (arg2 != "") {
-                out << ", " + arg2;
-                if (arg3 != "") 
-                    out << ", " + arg3;
-            }
-        }
-        if (comment != "") 
-            out << "\t\t#" + comment;
-	out << std::endl;
-}
-
-void LilC_Backend::generate(
-	const std::string opcode, 
-	const std::string arg1, 
-	const std::string arg2,
-	const std::string arg3) {
-        int space = MAXLEN - opcode.length() + 2;
-    
-        out << "\t" + opcode;
-        if (arg1 != "") {
-            for (int k = 1; k <= space; k++) 
-                out << " ";
-            out << arg1;
-            if (arg2 != "") {
-                out << ", " + arg2;
-                if (arg3 != "") 
-                    out << ", " + arg3;
-            }
-        }
-	out << std::endl;
-}
-
-void LilC_Backend::generateIndexed(
-	std::string opcode, 
-	std::string arg1, 
-	std::string arg2,
-	int arg3, 
-	std::string comment=""
-) {
-        int space = MAXLEN - opcode.length() + 2;
-    
-	out << "\t" << opcode;
-	for (int k = 1; k <= space; k++) {
-		out << " ";
+const Label Instr::NO_LABEL;
+
+const int LilC_Backend::TRUE;
+const int LilC_Backend::FALSE;
+
+const Reg LilC_Backend::ZERO;
+const Reg LilC_Backend::FP;
+const Reg LilC_Backend::SP;
+const Reg LilC_Backend::RA;
+const Reg LilC_Backend::V0;
+const Reg LilC_Backend::V1;
+const Reg LilC_Backend::A0;
+const Reg LilC_Backend::T0;
+const Reg LilC_Backend::T1;
+
+Reg Instr::written() const {
+	switch (op){
+		case Opcode::SW:
+		case Opcode::BEQ:
+		case Opcode::BNE:
+		case Opcode::J:
+		case Opcode::JR:
+		case Opcode::NOP:
+		case Opcode::LABEL:
+			return Reg::ZERO;
+		case Opcode::JAL:
+			return Reg::RA;
+		case Opcode::SYSCALL:
+			return Reg::V0;
+		default:
+			return rd;
+	}
+}
+
+bool Instr::reads(Reg reg) const {
+	switch (op){
+		case Opcode::LI:
+		case Opcode::J:
+		case Opcode::JAL:
+		case Opcode::NOP:
+		case Opcode::LABEL:
+			return false;
+		case Opcode::LA:
+		case Opcode::LW:
+			return label == NO_LABEL && rs == reg;
+		case Opcode::SW:
+			return rt == reg || (label == NO_LABEL && rs == reg);
+		case Opcode::MOVE:
+		case Opcode::NEGU:
+		case Opcode::ADDIU:
+		case Opcode::XORI:
+		case Opcode::JR:
+			return rs == reg;
+		case Opcode::SYSCALL:
+			return reg == Reg::V0 || reg == Reg::A0;
+		default:
+			return rs == reg || rt == reg;
+	}
+}
+
+Label MipsProgram::newLabel(){
+	names.emplace_back();
+	return static_cast<Label>(names.size() - 1);
+}
+
+Label MipsProgram::namedLabel(const std::string& name){
+	names.push_back(name);
+	return static_cast<Label>(names.size() - 1);
+}
+
+std::string MipsProgram::labelName(Label label) const {
+	if (names[label].empty()){ return ".L" + std::to_string(label); }
+	return names[label];
+}
+
+void LilC_Backend::beginFunction(Label label){
+	program.functions.emplace_back();
+	program.functions.back().label = label;
+	code = &program.functions.back().code;
+}
+
+Reg LilC_Backend::nextVirtual(){
+	if (code == nullptr){
+		throw InternalError("virtual register outside of any function");
+	}
+	MipsFunction& fn = program.functions.back();
+	if (fn.numVirtuals >= UINT16_MAX - static_cast<size_t>(Reg::FIRST_VIRTUAL)){
+		throw InternalError("too many virtual registers in a function");
+	}
+	return virtualReg(fn.numVirtuals++);
+}
+
+void LilC_Backend::emit(Opcode op, Reg rd, Reg rs, Reg rt, int imm,
+	Label label)
+{
+	if (code == nullptr){
+		throw InternalError("instruction outside of any function");
 	}
-	out << arg1 << ", " << arg3 << "(" << arg2 << ")";
-	if (comment != "") 
-		out << "\t#" + comment;
-	out << std::endl;
-}
-    
-void LilC_Backend::generateLabeled(
-	std::string label, 
-	std::string opcode,
-        std::string comment, 
-	std::string arg1
-) {
-	int space = MAXLEN - opcode.length() + 2;
-    
-	out << label << ":";
-	out << "\t" << opcode;
-	if (arg1 != "") {
-		for (int k = 1; k <= space; k++) {
-			out << " ";
-		}
-		out << arg1;
-        }
-        if (comment != "") { out << "\t# " << comment; }
-	out << std::endl;
-}
-
-void LilC_Backend::genPush(std::string s) {
-	generateIndexed("sw", s, SP, 0, "PUSH");
-	generate("subu", SP, SP, "4");
-}
-
-void LilC_Backend::genPop(std::string s) {
-	generateIndexed("lw", s, SP, 4, "POP");
-	generate("addu", SP, SP, "4");
-}
-
-void LilC_Backend::genLabel(std::string label, std::string comment) {
-	out << label << ":";
-	if (comment != "") 
-		out << "\t\t" << "# " << comment;
-	out << std::endl;
-}
-    
-std::string LilC_Backend::nextLabel() {
-	int k = currLabel++;
-	std::string tmp = ".L" + k;
-	return(tmp);
-}
-
-} // End namespace LILC 
+	code->push_back(Instr{ op, rd, rs, rt, imm, label });
+}
+
+void LilC_Backend::generate(Opcode op, Reg rd, Reg rs, Reg rt){
+	emit(op, rd, rs, rt, 0, Instr::NO_LABEL);
+}
+
+void LilC_Backend::generateImm(Opcode op, Reg rd, Reg rs, int imm){
+	emit(op, rd, rs, ZERO, imm, Instr::NO_LABEL);
+}
+
+// The register goes in rt for a store, since it's read, and in
+// rd otherwise
+void LilC_Backend::generateIndexed(Opcode op, Reg reg, Reg base,
+	int offset)
+{
+	if (op == Opcode::SW){
+		emit(op, ZERO, base, reg, offset, Instr::NO_LABEL);
+	} else {
+		emit(op, reg, base, ZERO, offset, Instr::NO_LABEL);
+	}
+}
+
+void LilC_Backend::generateGlobal(Opcode op, Reg reg, Label label,
+	int offset)
+{
+	if (op == Opcode::SW){
+		emit(op, ZERO, ZERO, reg, offset, label);
+	} else {
+		emit(op, reg, ZERO, ZERO, offset, label);
+	}
+}
+
+void LilC_Backend::generateBranch(Opcode op, Reg rs, Reg rt,
+	Label label)
+{
+	emit(op, ZERO, rs, rt, 0, label);
+}
+
+void LilC_Backend::generateJump(Opcode op, Label label){
+	emit(op, ZERO, ZERO, ZERO, 0, label);
+}
+
+void LilC_Backend::genPush(Reg reg) {
+	generateIndexed(Opcode::SW, reg, SP, 0);
+	generateImm(Opcode::ADDIU, SP, SP, -4);
+}
+
+void LilC_Backend::genPop(Reg reg) {
+	generateIndexed(Opcode::LW, reg, SP, 4);
+	generateImm(Opcode::ADDIU, SP, SP, 4);
+}
+
+void LilC_Backend::genLabel(Label label) {
+	emit(Opcode::LABEL, ZERO, ZERO, ZERO, 0, label);
+}
 
+} // End namespace LILC
@@ -1,150 +1,274 @@
 #ifndef LILC_MIPS_INCLUDE
+#define LILC_MIPS_INCLUDE
 
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
 #include <string>
-#include "err.hpp"
-#include "ast.hpp"
-#include "symbol_table.hpp"
-#include "lilc_compiler.hpp"
+#include <vector>
 
 namespace LILC{
 
+// **************************************************************
+// The generated program, held as instructions rather than text
+// until MipsPrinter writes it out, so that it can be rewritten
+// on the way.
+//
+// Registers are named by their MIPS numbers, and the virtual
+// registers a function may use until register allocation (see
+// lilc_regalloc.hpp) are numbered on from there. Labels are
+// dense ids handed out by the program: functions and globals
+// have names, and the rest print as .L<id>.
+// ***************************************************************
+
+enum class Reg : uint16_t {
+	ZERO = 0, AT = 1, V0 = 2, V1 = 3,
+	A0 = 4, A1, A2, A3,
+	T0 = 8, T1, T2, T3, T4, T5, T6, T7,
+	S0 = 16, S1, S2, S3, S4, S5, S6, S7,
+	T8 = 24, T9 = 25, K0 = 26, K1 = 27,
+	GP = 28, SP = 29, FP = 30, RA = 31,
+	FIRST_VIRTUAL = 32
+};
+
+inline bool isVirtual(Reg reg){ return reg >= Reg::FIRST_VIRTUAL; }
+// Virtual registers as indexes from 0, and back
+inline size_t virtualIndex(Reg reg){
+	return static_cast<size_t>(reg) - static_cast<size_t>(Reg::FIRST_VIRTUAL);
+}
+inline Reg virtualReg(size_t index){
+	return static_cast<Reg>(index + static_cast<size_t>(Reg::FIRST_VIRTUAL));
+}
+
+enum class Opcode : uint8_t {
+	LI,             // rd, imm
+	LA,             // rd, label+imm
+	LW,             // rd, imm(rs) or label+imm
+	SW,             // rt, imm(rs) or label+imm
+	MOVE, NEGU,     // rd, rs
+	ADDIU, XORI,    // rd, rs, imm
+	ADDU, SUBU, MUL, DIV,
+	SEQ, SNE, SLT, SGT, SLE, SGE,   // rd, rs, rt
+	BEQ, BNE,       // rs, rt, label
+	J, JAL,         // label
+	JR,             // rs
+	SYSCALL,
+	NOP,
+	LABEL           // marks where label is
+};
+
+using Label = uint32_t;
+
+/*
+* One instruction, in a fixed 16 bytes. Which fields mean
+* anything depends on op, as listed for Opcode; the others are
+* ZERO. A memory operand is imm(rs), or label+imm if label isn't
+* NO_LABEL. Only rd is ever written, and rs and rt only read.
+*/
+struct Instr{
+	static const Label NO_LABEL = UINT32_MAX;
+
+	Opcode op;
+	Reg rd;
+	Reg rs;
+	Reg rt;
+	int32_t imm;
+	Label label;
+
+	// The register this sets (RA for JAL and V0 for SYSCALL), or
+	// ZERO if none
+	Reg written() const;
+	bool reads(Reg reg) const;
+};
+
+struct MipsFunction{
+	Label label;
+	std::vector<Instr> code;
+	// Virtual registers 0 .. numVirtuals - 1 are in use
+	size_t numVirtuals = 0;
+};
+
+class MipsProgram{
+public:
+	// A fresh .L label, or one printed as name
+	Label newLabel();
+	Label namedLabel(const std::string& name);
+	std::string labelName(Label label) const;
+
+	struct Global{
+		Label label;
+		int size;
+	};
+	struct StringLit{
+		Label label;
+		std::string text; // as written, quotes and all
+	};
+
+	std::vector<Global> globals;
+	std::vector<StringLit> strings;
+	std::vector<MipsFunction> functions;
+
+private:
+	// By label; empty for the .L ones
+	std::vector<std::string> names;
+};
+
 // **************************************************************
 // Provides constants and operations useful for code
-// generation.
+// generation, each adding instructions to the end of the
+// function being generated in a MipsProgram.
 //
 // The constants are:
-//     Registers: FP, SP, RA, V0, V1, A0, T0, T1
+//     Registers: ZERO, FP, SP, RA, V0, V1, A0, T0, T1
 //     Values: TRUE, FALSE
 //
-// The operations are include various "generate" methods to 
-// print nicely formatted assembly code:
-//     generateWithComment
+// The operations are the various "generate" methods, one for
+// each shape of instruction:
 //     generate
+//     generateImm
 //     generateIndexed
-//     generateLabeled
+//     generateGlobal
+//     generateBranch
+//     generateJump
 //     genPush
 //     genPop
 //     genLabel
-// and a method nextLabel to create and return a new label.
-//
+// and methods nextLabel and nextVirtual to create and return a
+// new label or virtual register.
 // ***************************************************************
 class LilC_Backend {
 public:
-	// file into which generated code is written
-
-
 	// values of true and false
-	static const std::string TRUE;
-	static const std::string FALSE;
+	static const int TRUE = 1;
+	static const int FALSE = 0;
 
 	// registers
-	static const std::string FP;
-	static const std::string SP;
-	static const std::string RA;
-	static const std::string V0;
-	static const std::string V1;
-	static const std::string A0;
-	static const std::string T0;
-	static const std::string T1;
+	static const Reg ZERO = Reg::ZERO;
+	static const Reg FP = Reg::FP;
+	static const Reg SP = Reg::SP;
+	static const Reg RA = Reg::RA;
+	static const Reg V0 = Reg::V0;
+	static const Reg V1 = Reg::V1;
+	static const Reg A0 = Reg::A0;
+	static const Reg T0 = Reg::T0;
+	static const Reg T1 = Reg::T1;
 
-	std::ostream& out;
+	LilC_Backend(MipsProgram& programIn) : program(programIn){ }
 
-	LilC_Backend(std::ostream& outIn) : out(outIn){
-		this->currLabel = 0;
-	}
+	// Instructions from here on go in a new function
+	void beginFunction(Label label);
 
 	// *******************************************************
+	// generate
+	//    op rd, rs, rt (or op rd, rs for MOVE and NEGU, or
+	//    just op for SYSCALL)
 	// *******************************************************
-	// GENERATE OPERATIONS
+	void generate(Opcode op, Reg rd = ZERO, Reg rs = ZERO,
+		Reg rt = ZERO);
+
 	// *******************************************************
+	// generateImm
+	//    op rd, rs, imm (or op rd, imm for LI)
 	// *******************************************************
-    
+	void generateImm(Opcode op, Reg rd, Reg rs, int imm);
+
 	// *******************************************************
-	// generateWithComment
-	//    takes an op code, comment, and 0 to 3 string args
-	//    writes formatted, commented code (ending with new 
-	//    line)
+	// generateIndexed
+	//    op reg, offset(base) for LW, SW and LA
 	// *******************************************************
-	void generateWithComment(
-		std::string opcode, 
-		std::string comment,
-		std::string arg1="", 
-		std::string arg2="", 
-		std::string arg3="");
+	void generateIndexed(Opcode op, Reg reg, Reg base, int offset);
 
-	// ******************************************************
-	// generate
-	//    takes an op code, and 0 to 3 string args
-	//    writes formatted code (ending with new line)
-	// ******************************************************
-	void generate(
-		const std::string opcode, 
-		const std::string arg1="", 
-		const std::string arg2="", 
-		const std::string arg3="");
+	// *******************************************************
+	// generateGlobal
+	//    op reg, label+offset for LW, SW and LA
+	// *******************************************************
+	void generateGlobal(Opcode op, Reg reg, Label label,
+		int offset = 0);
 
 	// *******************************************************
-	// generateIndexed
-	//    takes an op code, target register T1 (as string), 
-	//    indexed register T2 (as string), - offset xx (int), 
-	//    and optional comment
-	//    writes formatted code (ending with new line) of the form
-	//    op T1, xx(T2) #comment
+	// generateBranch
+	//    op rs, rt, label for BEQ and BNE
 	// *******************************************************
-	void generateIndexed(
-		std::string opcode, 
-		std::string arg1, 
-		std::string arg2,
-		int arg3, 
-		std::string comment);
+	void generateBranch(Opcode op, Reg rs, Reg rt, Label label);
 
 	// *******************************************************
-	// generateLabeled (string args -- perhaps empty)
-	//    takes a label, op code, comment, and arg
-	//    writes formatted code (ending with new line)
+	// generateJump
+	//    op label for J and JAL
 	// *******************************************************
-	void generateLabeled(
-		std::string label, 
-		std::string opcode,
-		std::string comment, 
-		std::string arg1 = "");
+	void generateJump(Opcode op, Label label);
 
 	// ******************************************************
 	// genPush
-	//    generate code to push the given value onto the stack
+	//    generate code to push the given register onto the stack
 	// ******************************************************
-	void genPush(std::string s);
+	void genPush(Reg reg);
 
 	// ******************************************************
 	// genPop
 	//    generate code to pop into the given register
 	// ******************************************************
-	void genPop(std::string s);
+	void genPop(Reg reg);
 
 	// ******************************************************
 	// genLabel
-	//   given:    label L and comment (comment may be empty)
-	//   generate: L:    # comment
+	//    mark where label is
 	// ******************************************************
-	void genLabel(
-		std::string label, 
-		std::string comment="");
+	void genLabel(Label label);
 
 	// ******************************************************
-	// Return a different label each time:
-	//        L0 L1 L2, etc.
+	// Return a different label each time
 	// ******************************************************
-	std::string nextLabel();
+	Label nextLabel(){ return program.newLabel(); }
+
+	// ******************************************************
+	// Return a virtual register the function hasn't used yet
+	// ******************************************************
+	Reg nextVirtual();
+
+private:
+	void emit(Opcode op, Reg rd, Reg rs, Reg rt, int imm, Label label);
+
+	MipsProgram& program;
+	std::vector<Instr> * code = nullptr;
+};
+
+/*
+* Rewrites a MipsProgram's code with a table of patterns over
+* short runs of instructions (see lilc_mips_peephole.cpp), until
+* none applies. The patterns rely on the way CodeGen uses the
+* stack: a word below $sp is only ever read back by the pop of
+* the push that wrote it, never through $fp or a label.
+*/
+class MipsPeephole{
+public:
+	// Each returns the number of instructions removed
+	size_t optimize(MipsProgram& program);
+	size_t optimize(MipsFunction& fn);
+};
+
+/*
+* Writes a MipsProgram out as SPIM assembly: the functions in the
+* .text section, then the globals and string literals in .data.
+*/
+class MipsPrinter{
+public:
+	MipsPrinter(std::ostream& outIn) : out(outIn){ }
+	void print(const MipsProgram& program);
 
 private:
-	// for pretty printing generated code
-	static const int MAXLEN = 4;
+	void printFunction(const MipsProgram& program,
+		const MipsFunction& fn);
+	void printInstr(const MipsProgram& program, const Instr& instr);
+	void opcode(const char * mnemonic);
+	void reg(Reg r);
+	void address(const MipsProgram& program, const Instr& instr);
+	void endLine();
 
-	// for generating labels
-	int currLabel = 0;
-    
+	std::ostream& out;
+	// Put together a block at a time
+	std::string text;
 };
 
-} // End namespace LILC 
+} // End namespace LILC
 
 #endif
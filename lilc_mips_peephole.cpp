@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <vector>
+#include "lilc_mips.hpp"
+
+namespace LILC{
+
+/*
+* The patterns rewrite a function's code in place. One that drops
+* an instruction turns it into a NOP rather than erase it from the
+* middle of the vector; the others look past NOPs, and they're
+* squeezed out once no pattern applies any more.
+*
+* A push is
+*     sw    r, 0($sp)
+*     addiu $sp, $sp, -4
+* and a pop
+*     lw    r, 4($sp)
+*     addiu $sp, $sp, 4
+* as LilC_Backend generates them.
+*/
+
+using Code = std::vector<Instr>;
+
+// Returns whether it rewrote anything at code[at]
+using Pattern = bool (*)(Code& code, size_t at);
+
+// How far pushPop looks for the pop
+static const size_t LOOKAHEAD = 16;
+
+static const Reg ZERO = Reg::ZERO;
+static const Reg SP = Reg::SP;
+
+// The next instruction after at that isn't a NOP, or code.size()
+static size_t next(const Code& code, size_t at){
+	for (at++; at < code.size() && code[at].op == Opcode::NOP; at++){ }
+	return at;
+}
+
+static void remove(Instr& instr){
+	instr.op = Opcode::NOP;
+}
+
+// Make instr a move of from into to, or nothing if they're the same
+static void setMove(Instr& instr, Reg to, Reg from){
+	if (to == from){
+		remove(instr);
+		return;
+	}
+	instr = Instr{ Opcode::MOVE, to, from, ZERO, 0, Instr::NO_LABEL };
+}
+
+static bool isStackAdjust(const Instr& instr){
+	return instr.op == Opcode::ADDIU
+		&& instr.rd == SP && instr.rs == SP;
+}
+
+static bool isStackAccess(const Instr& instr, Opcode op, int offset){
+	return instr.op == op && instr.label == Instr::NO_LABEL
+		&& instr.rs == SP && instr.imm == offset;
+}
+
+// Whether control always goes on to the next instruction, and
+// nothing else runs in between
+static bool isStraight(const Instr& instr){
+	switch (instr.op){
+		case Opcode::BEQ:
+		case Opcode::BNE:
+		case Opcode::J:
+		case Opcode::JAL:
+		case Opcode::JR:
+		case Opcode::SYSCALL:
+		case Opcode::LABEL:
+			return false;
+		default:
+			return true;
+	}
+}
+
+static bool sameAddress(const Instr& a, const Instr& b){
+	return a.label == b.label && a.imm == b.imm
+		&& (a.label != Instr::NO_LABEL || a.rs == b.rs);
+}
+
+/*
+* A push of a, some instructions that leave a and $sp alone, and
+* then whatever uses the pushed word:
+*     its pop into b            ->  move b, a
+*     lw b, 4($sp), a peek      ->  move b, a, keeping the push
+*     addiu $sp, $sp, d >= 4    ->  addiu $sp, $sp, d-4
+*/
+static bool pushPop(Code& code, size_t at){
+	Instr& store = code[at];
+	if (!isStackAccess(store, Opcode::SW, 0) || store.rt == SP){
+		return false;
+	}
+	size_t adjust = next(code, at);
+	if (adjust == code.size() || !isStackAdjust(code[adjust])
+		|| code[adjust].imm != -4)
+	{
+		return false;
+	}
+
+	Reg pushed = store.rt;
+	size_t i = adjust;
+	for (size_t n = 0; n < LOOKAHEAD; n++){
+		i = next(code, i);
+		if (i == code.size()){ return false; }
+		Instr& instr = code[i];
+		if (isStackAccess(instr, Opcode::LW, 4)){
+			size_t pop = next(code, i);
+			if (pop < code.size() && isStackAdjust(code[pop])
+				&& code[pop].imm == 4)
+			{
+				remove(store);
+				remove(code[adjust]);
+				remove(code[pop]);
+			}
+			setMove(instr, instr.rd, pushed);
+			return true;
+		}
+		if (isStackAdjust(instr) && instr.imm >= 4){
+			remove(store);
+			remove(code[adjust]);
+			instr.imm -= 4;
+			if (instr.imm == 0){ remove(instr); }
+			return true;
+		}
+		if (!isStraight(instr) || instr.reads(SP)
+			|| instr.written() == SP || instr.written() == pushed)
+		{
+			return false;
+		}
+	}
+	return false;
+}
+
+// sw a, X; lw b, X  ->  sw a, X; move b, a
+static bool storeLoad(Code& code, size_t at){
+	const Instr& store = code[at];
+	if (store.op != Opcode::SW){ return false; }
+	size_t load = next(code, at);
+	if (load == code.size() || code[load].op != Opcode::LW
+		|| !sameAddress(store, code[load]))
+	{
+		return false;
+	}
+	setMove(code[load], code[load].rd, store.rt);
+	return true;
+}
+
+// addiu $sp, $sp, d; addiu $sp, $sp, e  ->  addiu $sp, $sp, d+e
+static bool stackAdjusts(Code& code, size_t at){
+	Instr& first = code[at];
+	if (!isStackAdjust(first)){ return false; }
+	if (first.imm == 0){
+		remove(first);
+		return true;
+	}
+	size_t second = next(code, at);
+	if (second == code.size() || !isStackAdjust(code[second])){
+		return false;
+	}
+	code[second].imm += first.imm;
+	remove(first);
+	return true;
+}
+
+/*
+* A value worked out in r only to be copied to s, just before r
+* is overwritten:
+*     op r, ...; move s, r; op' r, ...  ->  op s, ...; op' r, ...
+* as long as op' doesn't read r.
+*/
+static bool moveTarget(Code& code, size_t at){
+	Instr& def = code[at];
+	Reg reg = def.written();
+	if (!isStraight(def) || reg == ZERO || reg == SP || reg == Reg::FP){
+		return false;
+	}
+	size_t move = next(code, at);
+	if (move == code.size() || code[move].op != Opcode::MOVE
+		|| code[move].rs != reg)
+	{
+		return false;
+	}
+	size_t after = next(code, move);
+	if (after == code.size() || !isStraight(code[after])
+		|| code[after].written() != reg || code[after].reads(reg))
+	{
+		return false;
+	}
+	def.rd = code[move].rd;
+	remove(code[move]);
+	return true;
+}
+
+// A jump or branch to a label it would fall through to anyway
+static bool jumpToNext(Code& code, size_t at){
+	Instr& jump = code[at];
+	if (jump.op != Opcode::J && jump.op != Opcode::BEQ
+		&& jump.op != Opcode::BNE)
+	{
+		return false;
+	}
+	for (size_t i = next(code, at);
+		i < code.size() && code[i].op == Opcode::LABEL;
+		i = next(code, i))
+	{
+		if (code[i].label == jump.label){
+			remove(jump);
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+* Moves an adjustment of $sp down past an instruction that only
+* uses $sp as a base, changing its offset to suit, so that the
+* adjustments in a run of pushes and pops meet up and merge:
+*     addiu $sp, $sp, d; lw r, k($sp)  ->  lw r, k+d($sp); addiu $sp, $sp, d
+*/
+static bool sinkAdjust(Code& code, size_t at){
+	if (!isStackAdjust(code[at])){ return false; }
+	size_t after = next(code, at);
+	if (after == code.size()){ return false; }
+	Instr instr = code[after];
+	if (!isStraight(instr) || instr.written() == SP){ return false; }
+	if (instr.reads(SP)){
+		bool base = instr.label == Instr::NO_LABEL && instr.rs == SP
+			&& (instr.op == Opcode::LW || instr.op == Opcode::LA
+			|| instr.op == Opcode::ADDIU
+			|| (instr.op == Opcode::SW && instr.rt != SP));
+		if (!base){ return false; }
+		instr.imm += code[at].imm;
+	}
+	code[after] = code[at];
+	code[at] = instr;
+	return true;
+}
+
+// Tried in order at each instruction
+static const Pattern STACK_PATTERNS[] = {
+	pushPop, storeLoad, stackAdjusts, moveTarget, jumpToNext,
+};
+
+// Only once pushPop has run out, since it needs pushes and pops
+// whole and sinkAdjust splits them up
+static const Pattern SINK_PATTERNS[] = {
+	stackAdjusts, sinkAdjust, storeLoad,
+};
+
+template <size_t N>
+static void rewrite(Code& code, const Pattern (&patterns)[N]){
+	bool changed = true;
+	while (changed){
+		changed = false;
+		for (size_t at = 0; at < code.size(); at++){
+			if (code[at].op == Opcode::NOP){ continue; }
+			for (Pattern pattern : patterns){
+				if (pattern(code, at)){
+					changed = true;
+					break;
+				}
+			}
+		}
+	}
+}
+
+size_t MipsPeephole::optimize(MipsFunction& fn){
+	Code& code = fn.code;
+	size_t before = code.size();
+	rewrite(code, STACK_PATTERNS);
+	rewrite(code, SINK_PATTERNS);
+	code.erase(std::remove_if(code.begin(), code.end(),
+		[](const Instr& instr){ return instr.op == Opcode::NOP; }),
+		code.end());
+	return before - code.size();
+}
+
+size_t MipsPeephole::optimize(MipsProgram& program){
+	size_t removed = 0;
+	for (MipsFunction& fn : program.functions){
+		removed += optimize(fn);
+	}
+	return removed;
+}
+
+} // End namespace LILC
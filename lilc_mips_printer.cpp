@@ -0,0 +1,179 @@
+#include <string>
+#include "lilc_mips.hpp"
+#include "err.hpp"
+
+namespace LILC{
+
+static const char * const REG_NAMES[] = {
+	"$zero", "$at", "$v0", "$v1", "$a0", "$a1", "$a2", "$a3",
+	"$t0", "$t1", "$t2", "$t3", "$t4", "$t5", "$t6", "$t7",
+	"$s0", "$s1", "$s2", "$s3", "$s4", "$s5", "$s6", "$s7",
+	"$t8", "$t9", "$k0", "$k1", "$gp", "$sp", "$fp", "$ra",
+};
+
+// Indexed by Opcode
+static const char * const MNEMONICS[] = {
+	"li", "la", "lw", "sw", "move", "negu", "addiu", "xori",
+	"addu", "subu", "mul", "div",
+	"seq", "sne", "slt", "sgt", "sle", "sge",
+	"beq", "bne", "j", "jal", "jr", "syscall", "nop", "",
+};
+
+static_assert(sizeof(MNEMONICS) / sizeof(MNEMONICS[0])
+	== static_cast<size_t>(Opcode::LABEL) + 1,
+	"every Opcode needs a mnemonic");
+
+// for pretty printing generated code
+static const size_t MAXLEN = 4;
+
+void MipsPrinter::print(const MipsProgram& program){
+	text += "\t.text\n\t.globl main\n";
+	for (const MipsFunction& fn : program.functions){
+		printFunction(program, fn);
+	}
+	if (!program.globals.empty() || !program.strings.empty()){
+		text += "\t.data\n";
+	}
+	for (const MipsProgram::Global& global : program.globals){
+		text += program.labelName(global.label);
+		text += ":\t.space ";
+		text += std::to_string(global.size);
+		endLine();
+	}
+	for (const MipsProgram::StringLit& str : program.strings){
+		text += program.labelName(str.label);
+		text += ":\t.asciiz ";
+		text += str.text;
+		endLine();
+	}
+	out.write(text.data(), static_cast<std::streamsize>(text.size()));
+	text.clear();
+}
+
+void MipsPrinter::printFunction(const MipsProgram& program,
+	const MipsFunction& fn)
+{
+	text += program.labelName(fn.label);
+	text += ":";
+	endLine();
+	for (const Instr& instr : fn.code){
+		printInstr(program, instr);
+	}
+}
+
+void MipsPrinter::printInstr(const MipsProgram& program,
+	const Instr& instr)
+{
+	if (instr.op == Opcode::LABEL){
+		text += program.labelName(instr.label);
+		text += ':';
+		endLine();
+		return;
+	}
+	if (instr.op == Opcode::SYSCALL || instr.op == Opcode::NOP){
+		text += '\t';
+		text += MNEMONICS[static_cast<size_t>(instr.op)];
+		endLine();
+		return;
+	}
+
+	opcode(MNEMONICS[static_cast<size_t>(instr.op)]);
+	switch (instr.op){
+		case Opcode::LI:
+			reg(instr.rd);
+			text += ", ";
+			text += std::to_string(instr.imm);
+			break;
+		case Opcode::LA:
+		case Opcode::LW:
+			reg(instr.rd);
+			text += ", ";
+			address(program, instr);
+			break;
+		case Opcode::SW:
+			reg(instr.rt);
+			text += ", ";
+			address(program, instr);
+			break;
+		case Opcode::MOVE:
+		case Opcode::NEGU:
+			reg(instr.rd);
+			text += ", ";
+			reg(instr.rs);
+			break;
+		case Opcode::ADDIU:
+		case Opcode::XORI:
+			reg(instr.rd);
+			text += ", ";
+			reg(instr.rs);
+			text += ", ";
+			text += std::to_string(instr.imm);
+			break;
+		case Opcode::BEQ:
+		case Opcode::BNE:
+			reg(instr.rs);
+			text += ", ";
+			reg(instr.rt);
+			text += ", ";
+			text += program.labelName(instr.label);
+			break;
+		case Opcode::J:
+		case Opcode::JAL:
+			text += program.labelName(instr.label);
+			break;
+		case Opcode::JR:
+			reg(instr.rs);
+			break;
+		default:
+			reg(instr.rd);
+			text += ", ";
+			reg(instr.rs);
+			text += ", ";
+			reg(instr.rt);
+			break;
+	}
+	endLine();
+}
+
+// Followed by enough spaces to line up the operands
+void MipsPrinter::opcode(const char * mnemonic){
+	text += '\t';
+	text += mnemonic;
+	size_t len = std::char_traits<char>::length(mnemonic);
+	text.append(len < MAXLEN + 2 ? MAXLEN - len + 2 : 1, ' ');
+}
+
+void MipsPrinter::reg(Reg r){
+	if (isVirtual(r)){
+		throw InternalError("virtual register left after allocation");
+	}
+	text += REG_NAMES[static_cast<size_t>(r)];
+}
+
+void MipsPrinter::address(const MipsProgram& program,
+	const Instr& instr)
+{
+	if (instr.label != Instr::NO_LABEL){
+		text += program.labelName(instr.label);
+		if (instr.imm != 0){
+			text += '+';
+			text += std::to_string(instr.imm);
+		}
+		return;
+	}
+	text += std::to_string(instr.imm);
+	text += '(';
+	reg(instr.rs);
+	text += ')';
+}
+
+// Lines are written out in large pieces
+void MipsPrinter::endLine(){
+	text += '\n';
+	if (text.size() >= (1 << 16)){
+		out.write(text.data(), static_cast<std::streamsize>(text.size()));
+		text.clear();
+	}
+}
+
+} // End namespace LILC
@@ -0,0 +1,54 @@
+#include <cstring>
+
+#include "lilc_names.hpp"
+
+namespace LILC{
+
+NameTable::NameTable() : slots(1024, nullptr){ }
+
+/*
+* 64-bit FNV-1a. Identifiers are short, so something this
+* simple beats anything fancier.
+*/
+size_t NameTable::hashText(const char * text, size_t len){
+	uint64_t h = 14695981039346656037ULL;
+	for (size_t i = 0; i < len; i++){
+		h ^= static_cast<unsigned char>(text[i]);
+		h *= 1099511628211ULL;
+	}
+	return static_cast<size_t>(h);
+}
+
+Name NameTable::intern(const char * text, size_t len){
+	size_t h = hashText(text, len);
+	size_t mask = slots.size() - 1;
+	for (size_t i = h & mask; ; i = (i + 1) & mask){
+		const Name::Entry * e = slots[i];
+		if (e == nullptr){
+			entries.push_back(Name::Entry{
+				std::string(text, len), h,
+				static_cast<uint32_t>(entries.size())});
+			slots[i] = &entries.back();
+			//Keep the load factor under 1/2
+			if (entries.size() * 2 > slots.size()){ grow(); }
+			return Name(&entries.back());
+		}
+		if (e->hash == h && e->text.size() == len
+		    && std::memcmp(e->text.data(), text, len) == 0){
+			return Name(e);
+		}
+	}
+}
+
+void NameTable::grow(){
+	std::vector<const Name::Entry *> bigger(slots.size() * 2, nullptr);
+	size_t mask = bigger.size() - 1;
+	for (const Name::Entry& e : entries){
+		size_t i = e.hash & mask;
+		while (bigger[i] != nullptr){ i = (i + 1) & mask; }
+		bigger[i] = &e;
+	}
+	slots.swap(bigger);
+}
+
+} // End namespace LILC
@@ -0,0 +1,86 @@
+#ifndef __LILC_NAMES_HPP__
+#define __LILC_NAMES_HPP__ 1
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <functional>
+
+namespace LILC{
+
+/*
+* A handle on an interned identifier. Every spelling is stored
+* (and hashed) exactly once in the NameTable, so comparing two
+* Names is a pointer comparison and hashing one is a field read.
+*/
+class Name{
+public:
+	Name() : entry(nullptr) { }
+
+	const std::string& str() const { return entry->text; }
+	size_t hash() const noexcept { return entry->hash; }
+	// Dense, starting at 0, in order of first appearance
+	uint32_t id() const { return entry->id; }
+	bool isNull() const { return entry == nullptr; }
+
+	bool operator==(const Name& other) const {
+		return entry == other.entry;
+	}
+	bool operator!=(const Name& other) const {
+		return entry != other.entry;
+	}
+
+private:
+	friend class NameTable;
+	struct Entry{
+		std::string text;
+		size_t hash;
+		uint32_t id;
+	};
+	explicit Name(const Entry * e) : entry(e) { }
+
+	const Entry * entry;
+};
+
+/*
+* The table of all identifiers seen so far. The scanner interns
+* each ID lexeme here and everything downstream (the AST, the
+* symbol table, struct field maps) works with the resulting Name.
+* Each LilC_Compiler has its own, so a compilation's identifiers
+* go when it does.
+*/
+class NameTable{
+public:
+	NameTable();
+	NameTable(const NameTable&) = delete;
+	NameTable& operator=(const NameTable&) = delete;
+
+	Name intern(const char * text, size_t len);
+	Name intern(const std::string& text){
+		return intern(text.data(), text.size());
+	}
+	size_t size() const { return entries.size(); }
+	// The name with the given Name::id()
+	Name byId(uint32_t id) const { return Name(&entries[id]); }
+
+private:
+	static size_t hashText(const char * text, size_t len);
+	void grow();
+
+	std::deque<Name::Entry> entries; // stable addresses
+	std::vector<const Name::Entry *> slots; // open addressing
+};
+
+} /* end namespace */
+
+namespace std{
+template <> struct hash<LILC::Name>{
+	size_t operator()(const LILC::Name& name) const noexcept {
+		return name.hash();
+	}
+};
+}
+
+#endif /* END __LILC_NAMES_HPP__ */
@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#include "err.hpp"
+#include "lilc_parallel.hpp"
+
+namespace LILC{
+
+bool parallelChecks(size_t count, unsigned jobs,
+	const std::function<bool(size_t)>& check)
+{
+	if (jobs <= 1 || count <= 1){
+		bool result = true;
+		for (size_t i = 0; i < count; i++){
+			result = check(i) && result;
+		}
+		return result;
+	}
+
+	std::vector<Diagnostics> diagnostics(count);
+	std::vector<char> results(count, true);
+	std::vector<std::exception_ptr> errors(count);
+	std::atomic<size_t> next(0);
+
+	//Checks are handed out one at a time, since they can
+	// differ a lot in size
+	auto worker = [&](){
+		Diagnostics * outer = Diagnostics::current();
+		for (size_t i = next++; i < count; i = next++){
+			Diagnostics::current() = &diagnostics[i];
+			try {
+				results[i] = check(i);
+			} catch (...) {
+				errors[i] = std::current_exception();
+			}
+		}
+		Diagnostics::current() = outer;
+	};
+
+	size_t numThreads = std::min(static_cast<size_t>(jobs), count);
+	std::vector<std::thread> threads;
+	for (size_t t = 1; t < numThreads; t++){
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (std::thread& thread : threads){
+		thread.join();
+	}
+
+	Diagnostics * out = Diagnostics::current();
+	bool result = true;
+	for (size_t i = 0; i < count; i++){
+		if (out != nullptr){ out->append(diagnostics[i]); }
+		else { diagnostics[i].flush(std::cerr); }
+		if (errors[i]){ std::rethrow_exception(errors[i]); }
+		result = results[i] && result;
+	}
+	return result;
+}
+
+} // End namespace LILC
@@ -0,0 +1,22 @@
+#ifndef __LILC_PARALLEL_HPP__
+#define __LILC_PARALLEL_HPP__ 1
+
+#include <cstddef>
+#include <functional>
+
+namespace LILC{
+
+/*
+* Runs check(0) .. check(count - 1) on up to jobs threads and
+* returns whether all of them passed. Each check's diagnostics
+* (whatever it reports through Err) are collected separately and
+* passed on in index order once all are done, so the output is
+* the same as running the checks in order on one thread. An
+* exception from a check is rethrown after the diagnostics
+* before it.
+*/
+bool parallelChecks(size_t count, unsigned jobs,
+	const std::function<bool(size_t)>& check);
+
+} /* end namespace */
+#endif /* END __LILC_PARALLEL_HPP__ */
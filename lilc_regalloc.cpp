@@ -0,0 +1,157 @@
+#include <unordered_map>
+#include "lilc_regalloc.hpp"
+#include "err.hpp"
+
+namespace LILC{
+
+const std::vector<Reg> CALLER_SAVED = {
+	Reg::T0, Reg::T1, Reg::T2, Reg::T3, Reg::T4, Reg::T5, Reg::T6,
+	Reg::T7, Reg::V1, Reg::A1, Reg::A2, Reg::A3,
+};
+const std::vector<Reg> CALLEE_SAVED = {
+	Reg::S0, Reg::S1, Reg::S2, Reg::S3, Reg::S4, Reg::S5, Reg::S6,
+	Reg::S7,
+};
+const Reg SCRATCH[2] = { Reg::T8, Reg::T9 };
+
+static bool endsBlock(const Instr& instr){
+	switch (instr.op){
+		case Opcode::BEQ:
+		case Opcode::BNE:
+		case Opcode::J:
+		case Opcode::JR:
+			return true;
+		default:
+			return false;
+	}
+}
+
+Liveness::Liveness(const MipsFunction& fn){
+	const std::vector<Instr>& code = fn.code;
+	if (code.empty()){ return; }
+
+	// A block starts at each label and after each branch or jump
+	std::unordered_map<Label, size_t> labelBlocks;
+	for (size_t i = 0; i < code.size(); i++){
+		if (blocks.empty() || code[i].op == Opcode::LABEL
+			|| endsBlock(code[i - 1]))
+		{
+			if (!blocks.empty()){ blocks.back().last = i - 1; }
+			blocks.push_back(Block{ i, i, { } });
+		}
+		if (code[i].op == Opcode::LABEL){
+			labelBlocks[code[i].label] = blocks.size() - 1;
+		}
+	}
+	blocks.back().last = code.size() - 1;
+
+	for (size_t b = 0; b < blocks.size(); b++){
+		const Instr& end = code[blocks[b].last];
+		if (end.op == Opcode::J || end.op == Opcode::BEQ
+			|| end.op == Opcode::BNE)
+		{
+			auto target = labelBlocks.find(end.label);
+			if (target == labelBlocks.end()){
+				throw InternalError("branch to a label outside the function");
+			}
+			blocks[b].succs.push_back(target->second);
+		}
+		if (end.op != Opcode::J && end.op != Opcode::JR
+			&& b + 1 < blocks.size())
+		{
+			blocks[b].succs.push_back(b + 1);
+		}
+	}
+
+	// What each block reads before writing (gen) and writes (kill)
+	size_t words = (fn.numVirtuals + 63) / 64;
+	std::vector<Set> gen(blocks.size(), Set(words));
+	std::vector<Set> kill(blocks.size(), Set(words));
+	for (size_t b = 0; b < blocks.size(); b++){
+		for (size_t i = blocks[b].first; i <= blocks[b].last; i++){
+			const Instr& instr = code[i];
+			for (Reg reg : { instr.rs, instr.rt }){
+				if (!isVirtual(reg) || !instr.reads(reg)){ continue; }
+				size_t v = virtualIndex(reg);
+				if (!((kill[b][v / 64] >> (v % 64)) & 1)){
+					gen[b][v / 64] |= uint64_t(1) << (v % 64);
+				}
+			}
+			Reg def = instr.written();
+			if (isVirtual(def)){
+				size_t v = virtualIndex(def);
+				kill[b][v / 64] |= uint64_t(1) << (v % 64);
+			}
+		}
+	}
+
+	in.assign(blocks.size(), Set(words));
+	out.assign(blocks.size(), Set(words));
+	bool changed = true;
+	while (changed){
+		changed = false;
+		for (size_t b = blocks.size(); b-- > 0; ){
+			for (size_t w = 0; w < words; w++){
+				uint64_t o = 0;
+				for (size_t succ : blocks[b].succs){ o |= in[succ][w]; }
+				uint64_t i = gen[b][w] | (o & ~kill[b][w]);
+				if (o != out[b][w] || i != in[b][w]){
+					out[b][w] = o;
+					in[b][w] = i;
+					changed = true;
+				}
+			}
+		}
+	}
+}
+
+void rewriteVirtuals(MipsFunction& fn, const std::vector<Reg>& assigned,
+	const std::vector<int>& slots)
+{
+	std::vector<Instr> code;
+	code.reserve(fn.code.size());
+	auto spilled = [&](Reg reg){
+		return isVirtual(reg) && assigned[virtualIndex(reg)] == Reg::ZERO;
+	};
+	for (Instr instr : fn.code){
+		// Between registers spilled to the same slot
+		if (instr.op == Opcode::MOVE && spilled(instr.rd)
+			&& spilled(instr.rs) && slots[virtualIndex(instr.rd)]
+				== slots[virtualIndex(instr.rs)])
+		{
+			continue;
+		}
+		Instr store = Instr();
+		bool spilledDef = false;
+		Reg * regs[3] = { &instr.rs, &instr.rt, &instr.rd };
+		for (size_t r = 0; r < 3; r++){
+			Reg& reg = *regs[r];
+			if (!isVirtual(reg)){ continue; }
+			size_t v = virtualIndex(reg);
+			if (assigned[v] != Reg::ZERO){
+				reg = assigned[v];
+				continue;
+			}
+			// Spilled, so it lives in a scratch register just
+			// for this instruction
+			Reg scratch = SCRATCH[r == 1 ? 1 : 0];
+			if (r == 2){
+				store = Instr{ Opcode::SW, Reg::ZERO, Reg::FP, scratch,
+					slots[v], Instr::NO_LABEL };
+				spilledDef = true;
+			} else {
+				code.push_back(Instr{ Opcode::LW, scratch, Reg::FP,
+					Reg::ZERO, slots[v], Instr::NO_LABEL });
+			}
+			reg = scratch;
+		}
+		if (instr.op != Opcode::MOVE || instr.rd != instr.rs){
+			code.push_back(instr);
+		}
+		if (spilledDef){ code.push_back(store); }
+	}
+	fn.code.swap(code);
+	fn.numVirtuals = 0;
+}
+
+} // End namespace LILC
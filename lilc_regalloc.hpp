@@ -0,0 +1,143 @@
+#ifndef LILC_REGALLOC_HPP
+#define LILC_REGALLOC_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "lilc_mips.hpp"
+
+namespace LILC{
+
+// How CodeGen keeps the values it works with: on the stack (NONE),
+// or in virtual registers that an allocator then maps onto the
+// machine's
+enum class RegAlloc { NONE, LINEAR_SCAN, COLORING };
+
+/*
+* The registers an allocator hands out. Caller-saved ones don't
+* survive a call, so a value live across one needs a callee-saved
+* register, which the function must save itself. The rest are
+* never allocated: $v0 and $a0 carry results, arguments to
+* syscalls and return values, and SCRATCH holds spilled values for
+* the one instruction that uses them.
+*/
+extern const std::vector<Reg> CALLER_SAVED;
+extern const std::vector<Reg> CALLEE_SAVED;
+extern const Reg SCRATCH[2];
+
+/*
+* Which virtual registers are live going into and out of each
+* basic block of a function, worked out by the usual backward
+* dataflow over the blocks' successors.
+*/
+class Liveness{
+public:
+	struct Block{
+		size_t first; // index of its first instruction in the code
+		size_t last;  // and of its last
+		std::vector<size_t> succs;
+	};
+
+	explicit Liveness(const MipsFunction& fn);
+
+	const std::vector<Block>& getBlocks() const { return blocks; }
+	bool liveIn(size_t block, size_t virt) const {
+		return test(in, block, virt);
+	}
+	bool liveOut(size_t block, size_t virt) const {
+		return test(out, block, virt);
+	}
+	// Calls fn with each virtual register live out of block
+	template <typename Fn>
+	void forLiveOut(size_t block, Fn fn) const {
+		forEach(out, block, fn);
+	}
+	template <typename Fn>
+	void forLiveIn(size_t block, Fn fn) const {
+		forEach(in, block, fn);
+	}
+
+private:
+	using Set = std::vector<uint64_t>;
+
+	bool test(const std::vector<Set>& sets, size_t block,
+		size_t virt) const
+	{
+		return (sets[block][virt / 64] >> (virt % 64)) & 1;
+	}
+	template <typename Fn>
+	static void forEach(const std::vector<Set>& sets, size_t block,
+		Fn fn)
+	{
+		const Set& set = sets[block];
+		for (size_t word = 0; word < set.size(); word++){
+			for (uint64_t bits = set[word]; bits != 0; bits &= bits - 1){
+				fn(word * 64 + static_cast<size_t>(__builtin_ctzll(bits)));
+			}
+		}
+	}
+
+	std::vector<Block> blocks;
+	std::vector<Set> in;
+	std::vector<Set> out;
+};
+
+/*
+* What became of a function's frame: below the locals, spillSize
+* bytes now hold spilled virtual registers, and the callee-saved
+* registers in saved need saving below those. The counts are for
+* lilcc -fopt-report.
+*/
+struct Allocation{
+	int spillSize = 0;
+	std::vector<Reg> saved;
+	size_t numSpilled = 0;
+	size_t numCoalesced = 0;
+};
+
+/*
+* Replaces each virtual register in fn with its physical register
+* in assigned, or, where that's ZERO, loads and stores it through
+* SCRATCH from its slot, at slots[virt]($fp). Moves that end up
+* from a register or slot to itself go.
+*/
+void rewriteVirtuals(MipsFunction& fn, const std::vector<Reg>& assigned,
+	const std::vector<int>& slots);
+
+/*
+* Poletto and Sarkar's linear scan: each virtual register gets one
+* interval, from the first point it's live to the last, and the
+* intervals take registers in order of their starts, spilling the
+* one that ends furthest away when none is free. Intervals that
+* span a call only get callee-saved registers.
+*/
+class LinearScan{
+public:
+	// Spill slots go down from firstSlot($fp)
+	Allocation allocate(MipsFunction& fn, int firstSlot);
+};
+
+/*
+* George and Appel's iterated register coalescing, a Chaitin and
+* Briggs graph colorer that coalesces moves between virtual
+* registers as long as that can't make the graph harder to
+* color. Calls interfere with every caller-saved register, and
+* spill costs count each use and def ten times over for each loop
+* around it. Spills go through SCRATCH, as with LinearScan, so
+* one round of coloring is always enough. To keep compile times
+* in check, functions with more than MAX_VIRTUALS virtual
+* registers, or whose interference graphs turn out to have more
+* than MAX_EDGES edges, get LinearScan instead.
+*/
+class GraphColoring{
+public:
+	static const size_t MAX_VIRTUALS = 4096;
+	static const size_t MAX_EDGES = 1 << 19;
+
+	// Spill slots go down from firstSlot($fp)
+	Allocation allocate(MipsFunction& fn, int firstSlot);
+};
+
+} // End namespace LILC
+
+#endif
@@ -5,15 +5,37 @@
 #include <FlexLexer.h>
 #endif
 
+#include <algorithm>
+#include <cstring>
+
 #include "grammar.hh"
+#include "err.hpp"
+#include "lilc_token_source.hpp"
+#include "lilc_source.hpp"
+#include "lilc_arena.hpp"
+#include "lilc_names.hpp"
 
 namespace LILC{
 
-class LilC_Scanner : public yyFlexLexer{
+class LilC_Scanner : public yyFlexLexer, public TokenSource{
 public:
    
-   LilC_Scanner(std::istream *in) : yyFlexLexer(in)
+   LilC_Scanner(std::istream *in, Arena& arena, NameTable& names) 
+   : yyFlexLexer(in), tokenArena(arena), nameTable(names)
+   {
+	lineNum = 1;
+	charNum = 1;
+   };
+
+   // Scan straight out of a (usually mmap'd) source file rather
+   // than through an istream. The SourceFile must outlive any
+   // tokens produced, since their text may point into it.
+   // Tokens themselves are allocated from the given arena, and
+   // identifiers interned in names.
+   LilC_Scanner(const SourceFile *src, Arena& arena, NameTable& names) 
+   : yyFlexLexer(nullptr), tokenArena(arena), nameTable(names)
    {
+	source = src;
 	lineNum = 1;
 	charNum = 1;
    };
@@ -25,29 +47,58 @@ public:
 
    // YY_DECL defined in the flex file.l
    virtual
-   int yylex( LILC::LilC_Parser::semantic_type * const lval);
+   int yylex( LILC::Token ** const tok) override;
 
-   void warn(int lineNumIn, int charNumIn, std::string msg){
-	std::cerr << lineNumIn << ":" << charNumIn 
-		<< " ***WARNING*** " << msg << std::endl;
+   void warn(size_t lineNumIn, size_t charNumIn, std::string msg){
+	Err::warn(SourcePos(lineNumIn, charNumIn), msg);
    }
 
-   void error(int lineNumIn, int charNumIn, std::string msg){
-	std::cerr << lineNumIn << ":" << charNumIn 
-		<< " ***ERROR*** " << msg << std::endl;
+   void error(size_t lineNumIn, size_t charNumIn, std::string msg){
+	Err::report(SourcePos(lineNumIn, charNumIn), msg);
    }
 
    int produceNullaryToken(int tag){
-	this->yylval->tokenValue = new NullaryToken(lineNum, charNum, tag);
+	*this->yylval = 
+		new (tokenArena) NullaryToken(lineNum, charNum, tag);
 	charNum += static_cast<size_t>(yyleng);
 	return tag;
    }
 
+   // The text of the current lexeme, in storage that outlives
+   // the flex buffer (see TokenText)
+   TokenText lexemeText(){
+	size_t len = static_cast<size_t>(yyleng);
+	if (source != nullptr){
+		return TokenText{source->begin() + srcOffset - len, len};
+	}
+	return TokenText{tokenArena.copy(yytext, len), len};
+   }
+
+protected:
+   // flex refills its buffer through here; when we have a source
+   // file, hand it the bytes directly instead of going via yyin
+   int LexerInput(char * buf, int max_size) override {
+	if (source == nullptr){
+		return yyFlexLexer::LexerInput(buf, max_size);
+	}
+	size_t n = std::min(source->size() - readOffset,
+		static_cast<size_t>(max_size));
+	std::memcpy(buf, source->begin() + readOffset, n);
+	readOffset += n;
+	return static_cast<int>(n);
+   }
+
 private:
-   /* yyval ptr */
-   LILC::LilC_Parser::semantic_type *yylval = nullptr;
+   /* where yylex puts the token it scans */
+   LILC::Token ** yylval = nullptr;
    size_t lineNum;
    size_t charNum;
+
+   Arena& tokenArena;
+   NameTable& nameTable;
+   const SourceFile * source = nullptr;
+   size_t readOffset = 0; // next byte LexerInput will hand flex
+   size_t srcOffset = 0;  // end of the current lexeme (YY_USER_ACTION)
 };
 
 } /* end namespace */
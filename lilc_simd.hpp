@@ -0,0 +1,154 @@
+#ifndef __LILC_SIMD_HPP__
+#define __LILC_SIMD_HPP__ 1
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace LILC{
+
+/*
+* Helpers for the DFA scanner's hottest loops: skipping runs of
+* blanks, skipping to the end of a comment line, and finding the
+* end of an identifier. Each examines 32 bytes at a time with AVX2
+* or 16 with SSE2 (whichever the build targets; build with
+* -mavx2 or -march=native to get the former) and finishes the
+* last partial block a byte at a time, so it never reads past end.
+*
+* Each returns the first position in [p, end) that does NOT
+* belong to the run, or end.
+*/
+class LilC_Simd{
+public:
+	// Skip [ \t]*
+	static const char * skipBlanks(const char * p, const char * end){
+#if defined(__AVX2__)
+		const __m256i sp = _mm256_set1_epi8(' ');
+		const __m256i tab = _mm256_set1_epi8('\t');
+		while (end - p >= 32){
+			__m256i v = load32(p);
+			__m256i blank = _mm256_or_si256(
+				_mm256_cmpeq_epi8(v, sp),
+				_mm256_cmpeq_epi8(v, tab));
+			unsigned stop = ~static_cast<unsigned>(
+				_mm256_movemask_epi8(blank));
+			if (stop != 0){ return p + __builtin_ctz(stop); }
+			p += 32;
+		}
+#elif defined(__SSE2__)
+		const __m128i sp = _mm_set1_epi8(' ');
+		const __m128i tab = _mm_set1_epi8('\t');
+		while (end - p >= 16){
+			__m128i v = load16(p);
+			__m128i blank = _mm_or_si128(
+				_mm_cmpeq_epi8(v, sp), _mm_cmpeq_epi8(v, tab));
+			unsigned stop = ~static_cast<unsigned>(
+				_mm_movemask_epi8(blank)) & 0xffffu;
+			if (stop != 0){ return p + __builtin_ctz(stop); }
+			p += 16;
+		}
+#endif
+		while (p < end && (*p == ' ' || *p == '\t')){ p++; }
+		return p;
+	}
+
+	// Skip [^\n]*
+	static const char * skipToNewline(const char * p, const char * end){
+#if defined(__AVX2__)
+		const __m256i nl = _mm256_set1_epi8('\n');
+		while (end - p >= 32){
+			unsigned hit = static_cast<unsigned>(_mm256_movemask_epi8(
+				_mm256_cmpeq_epi8(load32(p), nl)));
+			if (hit != 0){ return p + __builtin_ctz(hit); }
+			p += 32;
+		}
+#elif defined(__SSE2__)
+		const __m128i nl = _mm_set1_epi8('\n');
+		while (end - p >= 16){
+			unsigned hit = static_cast<unsigned>(_mm_movemask_epi8(
+				_mm_cmpeq_epi8(load16(p), nl)));
+			if (hit != 0){ return p + __builtin_ctz(hit); }
+			p += 16;
+		}
+#endif
+		const void * hit = std::memchr(p, '\n',
+			static_cast<size_t>(end - p));
+		return hit ? static_cast<const char *>(hit) : end;
+	}
+
+	// Skip [a-zA-Z0-9_]*
+	static const char * skipIdentChars(const char * p, const char * end){
+#if defined(__AVX2__)
+		while (end - p >= 32){
+			unsigned stop = ~static_cast<unsigned>(
+				_mm256_movemask_epi8(identMask(load32(p))));
+			if (stop != 0){ return p + __builtin_ctz(stop); }
+			p += 32;
+		}
+#elif defined(__SSE2__)
+		while (end - p >= 16){
+			unsigned stop = ~static_cast<unsigned>(
+				_mm_movemask_epi8(identMask(load16(p)))) & 0xffffu;
+			if (stop != 0){ return p + __builtin_ctz(stop); }
+			p += 16;
+		}
+#endif
+		while (p < end && isIdentChar(*p)){ p++; }
+		return p;
+	}
+
+private:
+	static bool isIdentChar(char c){
+		unsigned char lower = static_cast<unsigned char>(c | 0x20);
+		return (lower >= 'a' && lower <= 'z')
+			|| (c >= '0' && c <= '9') || c == '_';
+	}
+
+	/*
+	* SSE/AVX only have signed byte compares, so a range test
+	* lo <= c <= lo + n - 1 is done by shifting lo down to -128
+	* and checking the result is below -128 + n.
+	*/
+	static char bias(char lo){
+		return static_cast<char>(static_cast<unsigned char>(lo) + 128u);
+	}
+	static char limit(int n){ return static_cast<char>(-128 + n); }
+
+#if defined(__AVX2__)
+	static __m256i load32(const char * p){
+		return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+	}
+	static __m256i inRange(__m256i v, char lo, int n){
+		return _mm256_cmpgt_epi8(_mm256_set1_epi8(limit(n)),
+			_mm256_sub_epi8(v, _mm256_set1_epi8(bias(lo))));
+	}
+	static __m256i identMask(__m256i v){
+		__m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+		return _mm256_or_si256(
+			_mm256_or_si256(inRange(lower, 'a', 26),
+				inRange(v, '0', 10)),
+			_mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+	}
+#elif defined(__SSE2__)
+	static __m128i load16(const char * p){
+		return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+	}
+	static __m128i inRange(__m128i v, char lo, int n){
+		return _mm_cmplt_epi8(
+			_mm_sub_epi8(v, _mm_set1_epi8(bias(lo))),
+			_mm_set1_epi8(limit(n)));
+	}
+	static __m128i identMask(__m128i v){
+		__m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+		return _mm_or_si128(
+			_mm_or_si128(inRange(lower, 'a', 26), inRange(v, '0', 10)),
+			_mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+	}
+#endif
+}; // end class LilC_Simd
+
+} /* end namespace */
+#endif /* END __LILC_SIMD_HPP__ */
@@ -0,0 +1,58 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "lilc_source.hpp"
+
+namespace LILC{
+
+SourceFile::SourceFile(const char * const filename){
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0){ return; }
+
+	struct stat info;
+	if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)
+	    && info.st_size > 0){
+		size_t len = static_cast<size_t>(info.st_size);
+		void * map = mmap(nullptr, len, PROT_READ,
+			MAP_PRIVATE, fd, 0);
+		if (map != MAP_FAILED){
+			//The scanner walks the file front to back
+			// exactly once, so tell the kernel to read
+			// ahead aggressively.
+			madvise(map, len, MADV_SEQUENTIAL);
+			myMapping = map;
+			myData = static_cast<const char *>(map);
+			mySize = len;
+			myGood = true;
+		}
+	}
+	if (!myGood){ myGood = readFallback(fd); }
+	close(fd);
+}
+
+SourceFile::~SourceFile(){
+	if (myMapping != nullptr){
+		munmap(myMapping, mySize);
+	}
+}
+
+/*
+* Used when the file can't be mapped: slurp it into memory
+* so the scanner still sees one contiguous buffer.
+*/
+bool SourceFile::readFallback(int fd){
+	char buf[1 << 16];
+	while (true){
+		ssize_t got = read(fd, buf, sizeof(buf));
+		if (got < 0){ return false; }
+		if (got == 0){ break; }
+		myCopy.append(buf, static_cast<size_t>(got));
+	}
+	myData = myCopy.data();
+	mySize = myCopy.size();
+	return true;
+}
+
+} // End namespace LILC
@@ -0,0 +1,42 @@
+#ifndef __LILC_SOURCE_HPP__
+#define __LILC_SOURCE_HPP__ 1
+
+#include <string>
+#include <cstddef>
+
+namespace LILC{
+
+/*
+* A read-only view of a whole source file. Where possible the
+* file is mapped with mmap so that the scanner can read (and
+* tokens can point) straight into the file's bytes without
+* going through an iostream buffer first. Files that cannot be
+* mapped (pipes, empty files, ...) are read into memory instead,
+* so callers never need to care which one happened.
+*/
+class SourceFile{
+public:
+	SourceFile(const char * const filename);
+	~SourceFile();
+
+	SourceFile(const SourceFile&) = delete;
+	SourceFile& operator=(const SourceFile&) = delete;
+
+	bool good() const { return myGood; }
+	bool isMapped() const { return myMapping != nullptr; }
+	const char * begin() const { return myData; }
+	const char * end() const { return myData + mySize; }
+	size_t size() const { return mySize; }
+
+private:
+	bool readFallback(int fd);
+
+	const char * myData = nullptr;
+	size_t mySize = 0;
+	void * myMapping = nullptr;
+	std::string myCopy;
+	bool myGood = false;
+};
+
+} /* end namespace */
+#endif /* END __LILC_SOURCE_HPP__ */
@@ -0,0 +1,124 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <sys/resource.h>
+
+#include "lilc_time_report.hpp"
+
+static std::atomic<size_t> globalAllocs(0);
+
+/*
+* Counting replacements for the global allocation functions. The
+* nothrow and array forms in libstdc++ all end up here.
+*/
+void * operator new(size_t size){
+	globalAllocs.fetch_add(1, std::memory_order_relaxed);
+	if (size == 0){ size = 1; }
+	while (true){
+		void * p = std::malloc(size);
+		if (p != nullptr){ return p; }
+		std::new_handler handler = std::get_new_handler();
+		if (handler == nullptr){ throw std::bad_alloc(); }
+		handler();
+	}
+}
+
+void * operator new[](size_t size){ return ::operator new(size); }
+void operator delete(void * p) noexcept { std::free(p); }
+void operator delete[](void * p) noexcept { std::free(p); }
+void operator delete(void * p, size_t) noexcept { std::free(p); }
+void operator delete[](void * p, size_t) noexcept { std::free(p); }
+
+namespace LILC{
+
+static double wallNow(){
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double toSecs(const timeval& tv){
+	return static_cast<double>(tv.tv_sec)
+		+ static_cast<double>(tv.tv_usec) / 1e6;
+}
+
+// CPU time (user + system) and peak RSS in kB, from one getrusage
+static void usage(double& cpuSecs, long& peakRSSKB){
+	rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	cpuSecs = toSecs(ru.ru_utime) + toSecs(ru.ru_stime);
+	peakRSSKB = ru.ru_maxrss;
+}
+
+size_t TimeReport::allocCount(){
+	return globalAllocs.load(std::memory_order_relaxed);
+}
+
+PhaseTimer::PhaseTimer(TimeReport * reportIn, const char * nameIn)
+: report(reportIn), name(nameIn) {
+	if (report == nullptr){ return; }
+	allocStart = TimeReport::allocCount();
+	usage(cpuStart, peakRSSStart);
+	wallStart = wallNow();
+}
+
+PhaseTimer::~PhaseTimer(){
+	if (report == nullptr){ return; }
+	double wallEnd = wallNow();
+	double cpuEnd;
+	long peakRSSEnd;
+	usage(cpuEnd, peakRSSEnd);
+	report->add(TimeReport::Phase{ name, wallEnd - wallStart,
+		cpuEnd - cpuStart, peakRSSEnd - peakRSSStart,
+		TimeReport::allocCount() - allocStart });
+}
+
+static TimeReport::Phase total(const std::vector<TimeReport::Phase>& ps){
+	TimeReport::Phase res{ "total", 0, 0, 0, 0 };
+	for (const TimeReport::Phase& p : ps){
+		res.wallSecs += p.wallSecs;
+		res.cpuSecs += p.cpuSecs;
+		res.peakRSSDeltaKB += p.peakRSSDeltaKB;
+		res.allocs += p.allocs;
+	}
+	return res;
+}
+
+void TimeReport::print(std::ostream& out) const {
+	auto row = [&out](const Phase& p){
+		out << " " << std::left << std::setw(16) << p.name
+			<< std::right << std::fixed << std::setprecision(3)
+			<< std::setw(10) << p.wallSecs << " s"
+			<< std::setw(10) << p.cpuSecs << " s"
+			<< std::setw(10) << p.peakRSSDeltaKB << " kB"
+			<< std::setw(12) << p.allocs << "\n";
+	};
+	out << "Time report:\n"
+		<< " " << std::left << std::setw(16) << "phase" << std::right
+		<< std::setw(12) << "wall" << std::setw(12) << "cpu"
+		<< std::setw(13) << "peak RSS +" << std::setw(12) << "allocs"
+		<< "\n";
+	for (const Phase& p : phases){ row(p); }
+	row(total(phases));
+}
+
+void TimeReport::printJSON(std::ostream& out) const {
+	auto obj = [&out](const Phase& p){
+		out << "{\"name\": \"" << p.name << "\""
+			<< ", \"wall_s\": " << p.wallSecs
+			<< ", \"cpu_s\": " << p.cpuSecs
+			<< ", \"peak_rss_delta_kb\": " << p.peakRSSDeltaKB
+			<< ", \"allocs\": " << p.allocs << "}";
+	};
+	out << std::setprecision(6) << std::fixed << "{\"phases\": [";
+	for (size_t k = 0; k < phases.size(); k++){
+		out << (k == 0 ? "\n  " : ",\n  ");
+		obj(phases[k]);
+	}
+	out << "\n ],\n \"total\": ";
+	obj(total(phases));
+	out << "}\n";
+}
+
+} // End namespace LILC
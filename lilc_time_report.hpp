@@ -0,0 +1,64 @@
+#ifndef __LILC_TIME_REPORT_HPP__
+#define __LILC_TIME_REPORT_HPP__ 1
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace LILC{
+
+/*
+* What lilcc -ftime-report prints: for each phase the compiler ran,
+* its wall and CPU time, how much it grew the process's peak RSS,
+* and how many times it called the global operator new (which
+* lilc_time_report.cpp replaces with a counting version; arena
+* allocations only count when the arena takes a new block).
+*/
+class TimeReport{
+public:
+	struct Phase{
+		std::string name;
+		double wallSecs;
+		double cpuSecs;
+		long peakRSSDeltaKB;
+		size_t allocs;
+	};
+
+	void add(Phase phase){ phases.push_back(phase); }
+	const std::vector<Phase>& getPhases() const { return phases; }
+
+	void print(std::ostream& out) const;
+	void printJSON(std::ostream& out) const;
+
+	// Calls to the global operator new so far
+	static size_t allocCount();
+
+private:
+	std::vector<Phase> phases;
+};
+
+/*
+* Measures from construction to destruction and adds the result to
+* report as the named phase. A null report makes it a no-op, so
+* phases can create one unconditionally.
+*/
+class PhaseTimer{
+public:
+	PhaseTimer(TimeReport * report, const char * name);
+	~PhaseTimer();
+
+	PhaseTimer(const PhaseTimer&) = delete;
+	PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+	TimeReport * report;
+	const char * name;
+	double wallStart;
+	double cpuStart;
+	long peakRSSStart;
+	size_t allocStart;
+};
+
+} /* end namespace */
+#endif /* END __LILC_TIME_REPORT_HPP__ */
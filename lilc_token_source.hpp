@@ -0,0 +1,26 @@
+#ifndef __LILC_TOKEN_SOURCE_HPP__
+#define __LILC_TOKEN_SOURCE_HPP__ 1
+
+#include "tokens.hpp"
+
+namespace LILC{
+
+/*
+* Anything the parser can pull tokens from. The flex scanner is
+* the usual one, but tokens can also be replayed from a file
+* written with --emit-tokens=bin (see lilc_token_stream.hpp).
+*
+* yylex points *tok at the token it scanned and returns the
+* token's tag (one of LilC_Parser::token), or TokenTag::END once
+* the input is exhausted. The parser turns the token into the
+* semantic value its grammar declares for that tag (see lilc.yy),
+* so token sources don't depend on the parser's value types.
+*/
+class TokenSource{
+public:
+	virtual ~TokenSource() { }
+	virtual int yylex(Token ** const tok) = 0;
+};
+
+} /* end namespace */
+#endif /* END __LILC_TOKEN_SOURCE_HPP__ */
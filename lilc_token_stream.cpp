@@ -0,0 +1,182 @@
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "grammar.hh"
+#include "lilc_token_stream.hpp"
+
+using TokenTag = LILC::LilC_Parser::token;
+
+namespace LILC{
+
+const char TokenStream::MAGIC[8] =
+	{ 'L', 'I', 'L', 'C', 'T', 'O', 'K', '1' };
+
+static void putVarint(std::string& buf, uint64_t val){
+	while (val >= 0x80){
+		buf += static_cast<char>((val & 0x7f) | 0x80);
+		val >>= 7;
+	}
+	buf += static_cast<char>(val);
+}
+
+static void putText(std::string& buf, const char * text, size_t len){
+	putVarint(buf, len);
+	buf.append(text, len);
+}
+
+bool TokenStream::isTokenStream(const SourceFile& file){
+	return file.size() >= sizeof(MAGIC)
+		&& std::memcmp(file.begin(), MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool TokenStream::isTokenStream(std::istream& in){
+	char start[sizeof(MAGIC)];
+	in.read(start, sizeof(start));
+	bool res = in.gcount() == sizeof(start)
+		&& std::memcmp(start, MAGIC, sizeof(MAGIC)) == 0;
+	in.clear();
+	in.seekg(0);
+	return res;
+}
+
+size_t TokenStream::write(TokenSource& src, std::ostream& out){
+	std::string buf(MAGIC, sizeof(MAGIC));
+	std::unordered_map<Name, uint64_t> nameIndex;
+	size_t prevLine = 1;
+	size_t count = 0;
+	Token * tok;
+	while (true){
+		int tag = src.yylex(&tok);
+		putVarint(buf, static_cast<uint64_t>(tag));
+		if (tag == TokenTag::END){ break; }
+
+		int64_t delta = static_cast<int64_t>(tok->line)
+			- static_cast<int64_t>(prevLine);
+		putVarint(buf, static_cast<uint64_t>(
+			(delta << 1) ^ (delta >> 63)));
+		putVarint(buf, tok->column);
+		prevLine = tok->line;
+
+		if (tag == TokenTag::ID){
+			Name name = static_cast<IDToken *>(tok)->name();
+			auto found = nameIndex.find(name);
+			if (found != nameIndex.end()){
+				putVarint(buf, found->second);
+			} else {
+				uint64_t idx = nameIndex.size();
+				nameIndex[name] = idx;
+				putVarint(buf, idx);
+				putText(buf, name.str().data(),
+					name.str().size());
+			}
+		} else if (tag == TokenTag::INTLITERAL){
+			int val = static_cast<IntLitToken *>(tok)->value();
+			putVarint(buf, static_cast<uint64_t>(val));
+		} else if (tag == TokenTag::STRINGLITERAL){
+			TokenText text =
+				static_cast<StringLitToken *>(tok)->text();
+			putText(buf, text.data, text.size);
+		}
+		count++;
+	}
+	out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+	return count;
+}
+
+TokenStreamReader::TokenStreamReader(
+	const SourceFile * fileIn,
+	Arena& arena,
+	NameTable& namesIn
+) : tokenArena(arena), nameTable(namesIn) {
+	if (!TokenStream::isTokenStream(*fileIn)){
+		throw std::runtime_error("not a token stream");
+	}
+	cur = fileIn->begin() + sizeof(TokenStream::MAGIC);
+	end = fileIn->end();
+}
+
+uint64_t TokenStreamReader::readVarint(){
+	uint64_t val = 0;
+	for (unsigned shift = 0; shift < 64; shift += 7){
+		if (cur == end){
+			throw std::runtime_error(
+				"truncated token stream");
+		}
+		unsigned char byte = static_cast<unsigned char>(*cur++);
+		val |= static_cast<uint64_t>(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0){ return val; }
+	}
+	throw std::runtime_error("corrupt token stream");
+}
+
+TokenText TokenStreamReader::readText(){
+	uint64_t len = readVarint();
+	if (len > static_cast<uint64_t>(end - cur)){
+		throw std::runtime_error("truncated token stream");
+	}
+	TokenText res{cur, static_cast<size_t>(len)};
+	cur += len;
+	return res;
+}
+
+/*
+* The tags the writer can produce besides ID and the literals:
+* the tokens the parser takes a plain Token * for. Anything else
+* would reach the parser as a value of the wrong type.
+*/
+static bool isNullaryKind(int tag){
+	using Kind = LilC_Parser::symbol_kind;
+	if (tag <= 0){ return false; }
+	LilC_Parser::symbol_kind_type kind = LilC_Parser::by_kind(
+		static_cast<LilC_Parser::token_kind_type>(tag)).kind();
+	return kind != Kind::S_YYUNDEF
+		&& kind >= Kind::S_CHAR && kind <= Kind::S_ASSIGN;
+}
+
+int TokenStreamReader::yylex(Token ** const tok){
+	int tag = static_cast<int>(readVarint());
+	if (tag == TokenTag::END){ return tag; }
+
+	uint64_t zz = readVarint();
+	int64_t delta = static_cast<int64_t>(zz >> 1)
+		^ -static_cast<int64_t>(zz & 1);
+	lineNum = static_cast<size_t>(
+		static_cast<int64_t>(lineNum) + delta);
+	size_t colNum = static_cast<size_t>(readVarint());
+
+	switch (tag){
+	case TokenTag::ID:
+		{
+		uint64_t idx = readVarint();
+		if (idx == names.size()){
+			TokenText text = readText();
+			names.push_back(nameTable.intern(
+				text.data, text.size));
+		} else if (idx > names.size()){
+			throw std::runtime_error("corrupt token stream");
+		}
+		*tok = new (tokenArena) IDToken(
+			lineNum, colNum, names[static_cast<size_t>(idx)]);
+		break;
+		}
+	case TokenTag::INTLITERAL:
+		*tok = new (tokenArena) IntLitToken(
+			lineNum, colNum, static_cast<int>(readVarint()));
+		break;
+	case TokenTag::STRINGLITERAL:
+		*tok = new (tokenArena) StringLitToken(
+			lineNum, colNum, readText());
+		break;
+	default:
+		if (!isNullaryKind(tag)){
+			throw std::runtime_error("corrupt token stream");
+		}
+		*tok = new (tokenArena) NullaryToken(
+			lineNum, colNum, tag);
+		break;
+	}
+	return tag;
+}
+
+} // End namespace LILC
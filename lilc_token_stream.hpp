@@ -0,0 +1,77 @@
+#ifndef __LILC_TOKEN_STREAM_HPP__
+#define __LILC_TOKEN_STREAM_HPP__ 1
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "tokens.hpp"
+#include "lilc_arena.hpp"
+#include "lilc_names.hpp"
+#include "lilc_source.hpp"
+#include "lilc_token_source.hpp"
+
+namespace LILC{
+
+/*
+* A compact binary encoding of a token stream, so that lexing
+* results can be cached and the parser can be run on its own.
+*
+* The file is the 8 byte MAGIC followed by one record per token:
+*
+*   tag          varint (0 = END, which ends the stream)
+*   line delta   zigzag varint, relative to the previous token
+*   column       varint
+*   payload      ID:            varint index into the identifiers
+*                               seen so far; if it is one past the
+*                               last index, varint length + bytes
+*                               of a new identifier follow
+*                INTLITERAL:    varint value
+*                STRINGLITERAL: varint length + bytes (quoted, as
+*                               scanned)
+*                anything else: none
+*
+* Varints are unsigned LEB128.
+*/
+class TokenStream{
+public:
+	static const char MAGIC[8];
+
+	// Does this file start with MAGIC?
+	static bool isTokenStream(const SourceFile& file);
+	// Does in? Either way, in is left at the start again.
+	static bool isTokenStream(std::istream& in);
+
+	// Drain src (up to and including END) into out. Returns the
+	// number of tokens written, not counting END.
+	static size_t write(TokenSource& src, std::ostream& out);
+};
+
+/*
+* Replays a file written by TokenStream::write as a TokenSource.
+* String literal text points straight into the file, so it must
+* outlive the tokens; the tokens themselves go in the arena, and
+* identifiers are interned in names.
+*/
+class TokenStreamReader : public TokenSource{
+public:
+	TokenStreamReader(const SourceFile * fileIn, Arena& arena,
+		NameTable& names);
+	int yylex(Token ** const tok) override;
+
+private:
+	uint64_t readVarint();
+	TokenText readText();
+
+	const char * cur;
+	const char * end;
+	Arena& tokenArena;
+	NameTable& nameTable;
+	std::vector<Name> names;
+	size_t lineNum = 1;
+};
+
+} /* end namespace */
+#endif /* END __LILC_TOKEN_STREAM_HPP__ */
@@ -0,0 +1,103 @@
+#include <unordered_map>
+
+#include "lilc_types.hpp"
+
+namespace LILC{
+
+const Type * Type::error(){
+	static const Type type(Tag::ERROR, "ERROR");
+	return &type;
+}
+
+const Type * Type::voidType(){
+	static const Type type(Tag::VOID, "void");
+	return &type;
+}
+
+const Type * Type::intType(){
+	static const Type type(Tag::INT, "int");
+	return &type;
+}
+
+const Type * Type::boolType(){
+	static const Type type(Tag::BOOL, "bool");
+	return &type;
+}
+
+const Type * Type::stringType(){
+	static const Type type(Tag::STRING, "string");
+	return &type;
+}
+
+const Type * Type::primitive(const std::string& spelling){
+	if (spelling == "int"){ return intType(); }
+	if (spelling == "bool"){ return boolType(); }
+	if (spelling == "void"){ return voidType(); }
+	return nullptr;
+}
+
+size_t TypeTable::SigHash::operator()(
+	const std::vector<const Type *>& sig) const noexcept
+{
+	size_t h = 0;
+	for (const Type * t : sig){
+		h = h * 31 + std::hash<const Type *>()(t);
+	}
+	return h;
+}
+
+TypeTable::~TypeTable(){
+	for (auto& entry : structVars){ delete entry.second; }
+	for (auto& entry : structNames){ delete entry.second; }
+	for (auto& entry : functions){ delete entry.second; }
+}
+
+const Type * TypeTable::structVar(const StructSymbol * def,
+	const std::string& structName)
+{
+	const Type *& slot = structVars[def];
+	if (slot == nullptr){
+		Type * type = new Type(Type::Tag::STRUCT_VAR, structName);
+		type->structDef = def;
+		slot = type;
+	}
+	return slot;
+}
+
+const Type * TypeTable::structName(const StructSymbol * def,
+	const std::string& fieldsSpelling)
+{
+	const Type *& slot = structNames[def];
+	if (slot == nullptr){
+		Type * type = new Type(Type::Tag::STRUCT_NAME,
+			fieldsSpelling);
+		type->structDef = def;
+		slot = type;
+	}
+	return slot;
+}
+
+const Type * TypeTable::function(
+	const std::vector<const Type *>& formals, const Type * ret)
+{
+	std::vector<const Type *> sig(formals);
+	sig.push_back(ret);
+	const Type *& slot = functions[sig];
+	if (slot == nullptr){
+		std::string spelling = "";
+		bool first = true;
+		for (const Type * formal : formals){
+			if (first) { first = false; }
+			else { spelling += ","; }
+			spelling += formal->toString();
+		}
+		Type * type = new Type(Type::Tag::FN,
+			spelling + "->" + ret->toString());
+		type->formals = formals;
+		type->ret = ret;
+		slot = type;
+	}
+	return slot;
+}
+
+} // End namespace LILC
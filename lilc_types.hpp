@@ -3,40 +3,341 @@
 
 #include <string>
 #include <cstddef>
+#include <cstdint>
 #include <istream>
+#include <unordered_map>
+#include <vector>
 
 #include "err.hpp"
 
+enum BinOpKind { REL, LOG, MATH, EQ};
+
 namespace LILC{
 
-/* This class mostly exists to abstract type identification 
+class StructSymbol;
+
+/*
+* A type, interned: there is exactly one Type object for each
+* distinct type, so two types are the same iff their pointers
+* are, and what sort of type one is is a read of its tag.
+*
+* The primitives are shared by every compilation; the rest are
+* made by a TypeTable during name analysis, as the symbols that
+* carry them are built. Type analysis just compares pointers,
+* so it never touches the tables.
+*/
+class Type{
+public:
+	enum class Tag : uint8_t {
+		ERROR, VOID, INT, BOOL, STRING,
+		STRUCT_VAR,  // a variable of some struct type
+		STRUCT_NAME, // the name of a struct itself
+		FN
+	};
+
+	Tag getTag() const { return tag; }
+	bool isError() const { return tag == Tag::ERROR; }
+	bool isVoid() const { return tag == Tag::VOID; }
+	bool isInt() const { return tag == Tag::INT; }
+	bool isBool() const { return tag == Tag::BOOL; }
+	bool isFnSig() const { return tag == Tag::FN; }
+	bool isStructName() const { return tag == Tag::STRUCT_NAME; }
+	bool isStructVar() const { return tag == Tag::STRUCT_VAR; }
+	bool isPrimitive() const {
+		return tag == Tag::VOID || tag == Tag::INT
+			|| tag == Tag::BOOL || tag == Tag::STRING;
+	}
+
+	/*
+	* The type as it has always been spelled: "int", the struct's
+	* name for a struct variable, "{f1,f2,}" for a struct name and
+	* "int,bool->void" for a function. Built once, when interned.
+	*/
+	const std::string& toString() const { return spelling; }
+
+	// The struct, for STRUCT_VAR and STRUCT_NAME
+	const StructSymbol * getStruct() const { return structDef; }
+	// The formals' and return types, for FN
+	const std::vector<const Type *>& getFormals() const {
+		return formals;
+	}
+	const Type * getRet() const { return ret; }
+
+	static const Type * error();
+	static const Type * voidType();
+	static const Type * intType();
+	static const Type * boolType();
+	static const Type * stringType();
+	// "int", "bool" or "void"; nullptr for anything else
+	static const Type * primitive(const std::string& spelling);
+
+private:
+	friend class TypeTable;
+	Type(Tag tagIn, std::string spellingIn)
+	: tag(tagIn), spelling(spellingIn) { }
+
+	Tag tag;
+	std::string spelling;
+	const StructSymbol * structDef = nullptr;
+	std::vector<const Type *> formals;
+	const Type * ret = nullptr;
+};
+
+/*
+* Every type other than the primitives, for one compilation.
+* Struct types are keyed by their StructSymbol, so the table
+* lives in the SymbolTable beside the symbols, and its types
+* are freed along with it.
+*/
+class TypeTable{
+public:
+	TypeTable() { }
+	TypeTable(const TypeTable&) = delete;
+	TypeTable& operator=(const TypeTable&) = delete;
+	~TypeTable();
+
+	const Type * structVar(const StructSymbol * def,
+		const std::string& structName);
+	const Type * structName(const StructSymbol * def,
+		const std::string& fieldsSpelling);
+	const Type * function(
+		const std::vector<const Type *>& formals, const Type * ret);
+
+private:
+	// A function type's key: its formals' types then its return type
+	struct SigHash{
+		size_t operator()(const std::vector<const Type *>& sig)
+			const noexcept;
+	};
+
+	std::unordered_map<const StructSymbol *, const Type *> structVars;
+	std::unordered_map<const StructSymbol *, const Type *> structNames;
+	std::unordered_map<std::vector<const Type *>, const Type *,
+		SigHash> functions;
+};
+
+/* This class mostly exists to abstract type identification
   out of type_analysis
 */
 class LilC_Types{
 public:
-	static bool isPrimitive(std::string& typeString){
-		if (typeString == "bool"){
-			return true;
+	/*
+	* The type rules themselves, shared by the typeAnalysis of
+	* the ASTNode tree and of the FlatAST. Each takes the types
+	* already computed for the operands, reports any error at
+	* the position(s) given and returns the resulting type, or
+	* the error type if an error was found (now or further down).
+	*/
+	static const Type * opResultType(BinOpKind kind){
+		switch (kind){
+			case BinOpKind::MATH:
+				return Type::intType();
+			case BinOpKind::LOG:
+				return Type::boolType();
+			case BinOpKind::REL:
+				return Type::boolType();
+			default:
+				throw InternalError(
+					"Unknown binary operation kind");
 		}
-		if (typeString == "void"){
-			return true;
+	}
+
+	static bool acceptsOperand(BinOpKind kind, const Type * type){
+		switch (kind){
+			case BinOpKind::MATH:
+				return type->isInt();
+			case BinOpKind::LOG:
+				return type->isBool();
+			case BinOpKind::REL:
+				return type->isInt();
+			default:
+				throw InternalError(
+					"Unknown binary operation kind");
 		}
-		if (typeString == "int"){
-			return true;
+	}
+
+	static const Type * reportOpErr(BinOpKind kind,
+		SourcePos pos)
+	{
+		switch (kind){
+			case BinOpKind::MATH:
+				TypeErr::badMath(pos);
+				break;
+			case BinOpKind::LOG:
+				TypeErr::badLogical(pos);
+				break;
+			case BinOpKind::REL:
+				TypeErr::badRelational(pos);
+				break;
+			default:
+				throw InternalError(
+					"Unknown binary operation kind");
 		}
-		if (typeString == "string"){
-			return true;
+		return Type::error();
+	}
+
+	// Arithmetic, logical and relational operators
+	static const Type * binaryType(BinOpKind kind,
+		const Type * type1, const Type * type2,
+		SourcePos pos1, SourcePos pos2)
+	{
+		if (type1->isError() || type2->isError()){
+			return Type::error();
+		}
+		bool resOk = true;
+		if (!acceptsOperand(kind, type1)){
+			reportOpErr(kind, pos1);
+			resOk = false;
+		}
+		if (!acceptsOperand(kind, type2)){
+			reportOpErr(kind, pos2);
+			resOk = false;
 		}
-		return false;
+		if (!resOk){ return Type::error(); }
+		return opResultType(kind);
 	}
-	static bool isFnSig(std::string typeString){
-		return typeString.find("->") != std::string::npos;
+
+	// ! (kind LOG) and unary - (kind MATH)
+	static const Type * unaryType(BinOpKind kind,
+		const Type * type, SourcePos pos)
+	{
+		if (type->isError()){ return type; }
+		if (acceptsOperand(kind, type)){ return type; }
+		return reportOpErr(kind, pos);
 	}
-	static bool isStructName(std::string typeString){
-		return typeString.find("{") != std::string::npos;
+
+	// == and !=
+	static const Type * equalityType(const Type * lhsType,
+		const Type * rhsType, SourcePos pos)
+	{
+		if (lhsType->isError() || rhsType->isError()){
+			return Type::error();
+		}
+		if (lhsType != rhsType){
+			TypeErr::typeMismatch(pos);
+		} else if (lhsType->isFnSig()){
+			TypeErr::funEq(pos);
+		} else if (lhsType->isStructName()){
+			TypeErr::structNameEq(pos);
+		} else if (lhsType->isVoid()){
+			TypeErr::voidEq(pos);
+		} else if (!lhsType->isPrimitive()){
+			TypeErr::structVarEq(pos);
+		} else {
+			return Type::boolType();
+		}
+		return Type::error();
+	}
+
+	static const Type * assignType(const Type * lhsType,
+		const Type * rhsType, SourcePos pos)
+	{
+		//The spec isn't crystal clear whether a type that could
+		// NEVER be an assign operand should raise a report
+		// if the other operand is error. In keeping with the
+		// spirit of the "(true + 3) == x" example, which
+		// raises just 1 error regardless of the type of x, this
+		// implementation doesn't raise an error on x even if it's
+		// a function, etc.
+		if (lhsType->isError() || rhsType->isError()){
+			return Type::error();
+		}
+		if (lhsType != rhsType){
+			TypeErr::typeMismatch(pos);
+		} else if (lhsType->isFnSig()){
+			TypeErr::assignFunction(pos);
+		} else if (lhsType->isStructName()){
+			TypeErr::assignStructName(pos);
+		} else if (!lhsType->isPrimitive()){
+			TypeErr::assignStructVar(pos);
+		} else {
+			return lhsType;
+		}
+		return Type::error();
+	}
+
+	/*
+	* Statement checks: true if the statement is well-typed
+	* given the type(s) of its expression(s).
+	*/
+	// x++ and x--
+	static bool checkIncDec(const Type * type, SourcePos pos){
+		if (type->isError()){ return false; }
+		if (!type->isInt()){
+			return TypeErr::badMath(pos);
+		}
+		return true;
 	}
-	static bool isVoid(std::string typeString){
-		return typeString == "void";
+
+	static bool checkRead(const Type * type, SourcePos pos){
+		if (type->isError()){ return false; }
+		if (type->isFnSig()){
+			return TypeErr::readFunction(pos);
+		}
+		if (type->isStructName()){
+			return TypeErr::readStructName(pos);
+		}
+		if (!type->isPrimitive()){
+			return TypeErr::readStructVar(pos);
+		}
+		return true;
+	}
+
+	static bool checkWrite(const Type * type, SourcePos pos){
+		if (type->isError()){ return false; }
+		if (type->isFnSig()){
+			return TypeErr::writeFunction(pos);
+		}
+		if (type->isStructName()){
+			return TypeErr::writeStructName(pos);
+		}
+		if (type->isVoid()){
+			return TypeErr::writeVoid(pos);
+		}
+		if (!type->isPrimitive()){
+			return TypeErr::writeStructVar(pos);
+		}
+		return true;
+	}
+
+	// The condition of an if or while
+	static bool checkCond(const Type * type, SourcePos pos){
+		if (!type->isBool()){
+			return TypeErr::badIfCond(pos);
+		}
+		return true;
+	}
+
+	// return;
+	static bool checkReturn(const Type * retType){
+		if (retType->isError()){ return false; }
+		if (retType->isVoid()){ return true; }
+		return TypeErr::missingReturnValue(SourcePos());
+	}
+
+	// return exp;
+	static bool checkReturn(const Type * retType,
+		const Type * expType, SourcePos pos)
+	{
+		if (retType->isError()){ return false; }
+		if (expType->isError()){ return false; }
+		if (retType != expType){
+			if (retType->isVoid()){
+				return TypeErr::returnFromVoid(pos);
+			}
+			return TypeErr::badReturnValue(pos);
+		}
+		return true;
+	}
+
+	// One actual argument against its formal
+	static bool checkArg(const Type * actualType,
+		const Type * formalType, SourcePos pos)
+	{
+		if (actualType != formalType){
+			return TypeErr::argMismatch(pos);
+		}
+		return true;
 	}
 
 }; // end class lilc_types
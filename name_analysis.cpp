@@ -19,9 +19,9 @@ bool DeclListNode::nameAnalysis(SymbolTable * symTab){
 	// list nodes, the below uses the "enhanced for loop"
 	// introduced in C++11. It works just like an iterator
 	// over the list. The below iterates over every
-	// element in the list pointed to by myDecls, with the
+	// element in the list myDecls, with the
 	// iteration variable named decl. 
-	for (DeclNode * decl : *myDecls){
+	for (DeclNode * decl : myDecls){
 		bool thisResult = decl->nameAnalysis(symTab);
 		result = thisResult && result;
 	}
@@ -54,7 +54,9 @@ bool DeclListNode::fieldNameAnalysis(
 	SymbolTable * symTab, 
 	FieldMap * fieldMap
 ){
-	for (DeclNode * decl : *myDecls){
+	//Fields are laid out in the order they're declared
+	int offset = 0;
+	for (DeclNode * decl : myDecls){
 		if (decl->getKind() != DeclKind::VAR){
 			//It's syntactically impossible
 			// to declare other Kinds inside
@@ -64,8 +66,8 @@ bool DeclListNode::fieldNameAnalysis(
 		}
 		VarDeclNode * varDecl = 
 			dynamic_cast<VarDeclNode *>(decl);
-		std::string ePos = varDecl->getPosition();
-		std::string fName = varDecl->getName();
+		SourcePos ePos = varDecl->pos();
+		Name fName = varDecl->getName();
 		std::string fTypeStr = varDecl->getTypeString();
 		if (varDecl->getTypeString() == "void"){ 
 			return Err::badVoid(ePos); 
@@ -78,6 +80,8 @@ bool DeclListNode::fieldNameAnalysis(
 		if (fieldMap->find(fName) != fieldMap->end()){
 			return Err::multiDecl(ePos);
 		}
+		fSym->place(Storage::FIELD, offset);
+		offset += fSym->getSize();
 		(*fieldMap)[fName] = fSym;
 	}
 	return true;
@@ -88,14 +92,16 @@ std::string VarDeclNode::getTypeString(){
 }
 
 bool VarDeclNode::nameAnalysis(SymbolTable * symTab){
-	std::string name = myDeclaredID->getString();
-	std::string ePos = getPosition();
+	Name name = myDeclaredID->getName();
+	SourcePos ePos = pos();
 
 	if (myType->isVoid()){ return Err::badVoid(ePos); }
 	if (symTab->collides(name)){ return Err::multiDecl(ePos); } 
 
 	VarSymbol * vSym = VarSymbol::produce(symTab, getTypeString());
 	if (vSym == nullptr){ return Err::undefType(ePos); }
+	symTab->place(vSym);
+	myDeclaredID->setSymbol(vSym);
 	return symTab->add(name, vSym);
 }
 
@@ -117,7 +123,7 @@ VarSymbol * FormalDeclNode::getSymbol(){
 
 std::list<VarSymbol *> * FormalsListNode::getSymbols(){
 	std::list<VarSymbol *> * res = new std::list<VarSymbol *>();
-	for (FormalDeclNode * decl : *myFormals){
+	for (FormalDeclNode * decl : myFormals){
 		res->push_back(decl->getSymbol());
 	}
 	return res;
@@ -136,48 +142,57 @@ bool FnDeclNode::nameAnalysis(SymbolTable * symTab){
 	// on the formals will put the symbols in the
 	// function body scope (which is what we want)
 	symTab->enterScope();
+	symTab->beginFrame();
 
+	FuncSymbol * fnSym = declare(symTab, outerScope);
+	bool ok = myBody->nameAnalysis(symTab) && fnSym != nullptr;
+	if (fnSym != nullptr){ fnSym->setLocalsSize(symTab->endFrame()); }
+	symTab->exitScope();
+	return ok;
+}
+
+/*
+* Name analysis of the function's signature, in the scope of its
+* body. Returns the symbol it has bound the function's name to in
+* outerScope, or null if the signature isn't valid.
+*/
+FuncSymbol * FnDeclNode::declare(SymbolTable * symTab,
+	ScopeTable * outerScope)
+{
 	bool unique = true;
-	std::string name = myId->getString();
+	Name name = myId->getName();
 	if (symTab->collides(name)){
-		Err::multiDecl(getPosition());
+		Err::multiDecl(pos());
 		unique = false;
 	}
 
 	bool argsValid = myFormals->nameAnalysis(symTab);
 	VarSymbol * returnSymbol = makeRetSymbol(symTab);
 
-	bool ok = false;
-	if (unique && argsValid){
-		VarSymbol * retSymbol = this->makeRetSymbol(symTab);
-		auto argsSymbols = myFormals->getSymbols();
-
-		FuncSymbol * entry = new FuncSymbol(
-			argsSymbols, retSymbol
-		);
-		outerScope->add(name, entry);
-		myId->setSymbol(entry);
-		ok = true;
-	}
+	if (!unique || !argsValid){ return nullptr; }
 
-	ok = myBody->nameAnalysis(symTab) && ok;
-	symTab->exitScope();
-	return ok;
+	VarSymbol * retSymbol = this->makeRetSymbol(symTab);
+	auto argsSymbols = myFormals->getSymbols();
+
+	FuncSymbol * entry = new FuncSymbol(
+		argsSymbols, retSymbol, symTab->getTypes()
+	);
+	outerScope->add(name, entry);
+	myId->setSymbol(entry);
+	return entry;
 }
 
 bool FormalsListNode::nameAnalysis(SymbolTable * symTab) {
 	bool valid = true;
-	if (myFormals != nullptr) {
-		for (FormalDeclNode * decl : *myFormals) {
-			valid = decl->nameAnalysis(symTab) && valid;
-		}
+	for (FormalDeclNode * decl : myFormals) {
+		valid = decl->nameAnalysis(symTab) && valid;
 	}
 	return valid;
 }
 
 bool FormalDeclNode::nameAnalysis(SymbolTable * symTab) {
-	std::string name = myDeclaredID->getString();
-	std::string ePos = myDeclaredID->getPosition();
+	Name name = myDeclaredID->getName();
+	SourcePos ePos = myDeclaredID->pos();
 
 	if (myType->isVoid()){ return Err::badVoid(ePos); }
 	if (symTab->collides(name)){ return Err::multiDecl(ePos); } 
@@ -198,25 +213,26 @@ bool FnBodyNode::nameAnalysis(SymbolTable * symTab) {
 }
 
 std::string StructDeclNode::getTypeString(){
-	return getName();
+	return myDeclaredID->getString();
 }
 
 bool StructDeclNode::nameAnalysis(SymbolTable * symTab) {
-	std::string typeStr = getTypeString();
+	Name typeName = getName();
 
 	FieldMap * fieldMap = myDeclList->fieldNameAnalysis(symTab);
 	if (!fieldMap){ return false; }
 
-	StructSymbol * mySym = new StructSymbol(fieldMap);
-	if (!symTab->add(typeStr, mySym)){
-		return Err::multiDecl(getPosition());
+	StructSymbol * mySym = new StructSymbol(typeName, fieldMap,
+		symTab->getTypes());
+	if (!symTab->add(typeName, mySym)){
+		return Err::multiDecl(pos());
 	}
 	return true;
 }
 
 bool IdNode::nameAnalysis(SymbolTable * symTab) {
-	std::string ePos = getPosition();
-	mySymbol = symTab->lookup(myStrVal);
+	SourcePos ePos = pos();
+	mySymbol = symTab->lookup(myName);
 	if(mySymbol == nullptr){
 		return Err::undeclaredID(ePos);
 	}
@@ -254,7 +270,7 @@ StructSymbol * IdNode::dotNameAnalysis(SymbolTable * symTab){
 
 	StructSymbol * fieldType = mySymbol->getCompositeType();
 	if (fieldType == nullptr){
-		Err::badDotLHS(getPosition()); 
+		Err::badDotLHS(pos()); 
 	}
 	return fieldType;
 }
@@ -263,11 +279,15 @@ StructSymbol * DotAccessNode::dotNameAnalysis(SymbolTable * symTab){
 	StructSymbol * baseStruct = myExp->dotNameAnalysis(symTab);
 	if (baseStruct == nullptr) { return nullptr; }
 
-	std::string fieldName = myId->getString();
+	Name fieldName = myId->getName();
 	VarSymbol * fieldSymbol = baseStruct->getField(fieldName);
+	if (fieldSymbol == nullptr){
+		Err::badDotRHS(myId->pos());
+		return nullptr;
+	}
 	StructSymbol * fieldType = fieldSymbol->getCompositeType();
 	if (fieldType == nullptr){
-		Err::badDotLHS(myId->getPosition()); 
+		Err::badDotLHS(myId->pos()); 
 		return nullptr;
 	}
 	myId->setSymbol(fieldSymbol);
@@ -278,8 +298,8 @@ bool DotAccessNode::nameAnalysis(SymbolTable * symTab) {
 	StructSymbol * baseSymbol = myExp->dotNameAnalysis(symTab);
 	if (baseSymbol == nullptr){ return false; }
 
-	std::string ePos = myId->getPosition();
-	std::string fieldName = myId->getString();
+	SourcePos ePos = myId->pos();
+	Name fieldName = myId->getName();
 
 	VarSymbol * fieldSymbol = baseSymbol->getField(fieldName);
 	if (fieldSymbol == nullptr) { return Err::badDotRHS(ePos); }
@@ -296,7 +316,7 @@ bool AssignNode::nameAnalysis(SymbolTable * symTab) {
 
 bool StmtListNode::nameAnalysis(SymbolTable * symTab) {
 	bool valid = true;
-	for(StmtNode * stmt : *myStmts){
+	for(StmtNode * stmt : myStmts){
 		valid = stmt->nameAnalysis(symTab) && valid;
 	}
 	return valid;
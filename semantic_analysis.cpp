@@ -0,0 +1,198 @@
+#include "err.hpp"
+#include "ast.hpp"
+#include "symbol_table.hpp"
+#include "lilc_types.hpp"
+
+/*
+* Name and type analysis in a single walk of the tree (lilcc
+* -ffused-sema). Each node resolves its names as nameAnalysis
+* would and then, with its children typed on the way back up,
+* applies the rule that expTypeAnalysis or stmtTypeAnalysis
+* would, so both kinds of diagnostic come out in the order the
+* two separate passes give them. Type errors only mean anything
+* once every name has resolved, so the caller holds them back
+* (see TypeErr::sink) until it knows that state.namesOk is set.
+*
+* Wherever type analysis would not look at a subtree, because
+* an enclosing check has already failed, the subtree only gets
+* its names resolved.
+*/
+
+namespace LILC{
+
+bool ProgramNode::semanticAnalysis(SemanticState& state){
+	state.symTab->enterScope();
+	bool typesOk = myDeclList->semanticAnalysis(state);
+	SymbolTableEntry * temp = state.symTab->lookup("main");
+	state.noteNames(temp != nullptr);
+	state.symTab->exitScope();
+	return typesOk;
+}
+
+bool DeclListNode::semanticAnalysis(SemanticState& state){
+	bool result = true;
+	for (DeclNode * decl : myDecls){
+		result = decl->semanticAnalysis(state) && result;
+	}
+	return result;
+}
+
+//As for typeAnalysis, only FnDeclNode has types to check
+bool DeclNode::semanticAnalysis(SemanticState& state){
+	state.noteNames(nameAnalysis(state.symTab));
+	return true;
+}
+
+bool FnDeclNode::semanticAnalysis(SemanticState& state){
+	ScopeTable * outerScope = state.symTab->currentScope();
+	state.symTab->enterScope();
+	state.symTab->beginFrame();
+
+	bool result = true;
+	FuncSymbol * fnSym = declare(state.symTab, outerScope);
+	if (fnSym == nullptr){
+		state.noteNames(false);
+		state.noteNames(myBody->nameAnalysis(state.symTab));
+	} else {
+		state.fnSym = fnSym;
+		result = myBody->semanticAnalysis(state);
+		state.fnSym = nullptr;
+		fnSym->setLocalsSize(state.symTab->endFrame());
+	}
+
+	state.symTab->exitScope();
+	return result;
+}
+
+bool FnBodyNode::semanticAnalysis(SemanticState& state){
+	state.noteNames(myDeclList->nameAnalysis(state.symTab));
+	return myStmtList->semanticAnalysis(state);
+}
+
+bool StmtListNode::semanticAnalysis(SemanticState& state){
+	bool result = true;
+	for (StmtNode * stmt : myStmts){
+		result = stmt->semanticAnalysis(state) && result;
+	}
+	return result;
+}
+
+bool AssignStmtNode::semanticAnalysis(SemanticState& state){
+	return !myAssign->semanticAnalysis(state)->isError();
+}
+
+bool PostIncStmtNode::semanticAnalysis(SemanticState& state){
+	return LilC_Types::checkIncDec(
+		myExp->semanticAnalysis(state), pos());
+}
+
+bool PostDecStmtNode::semanticAnalysis(SemanticState& state){
+	return LilC_Types::checkIncDec(
+		myExp->semanticAnalysis(state), pos());
+}
+
+bool ReadStmtNode::semanticAnalysis(SemanticState& state){
+	return LilC_Types::checkRead(
+		myExp->semanticAnalysis(state), myExp->pos());
+}
+
+bool WriteStmtNode::semanticAnalysis(SemanticState& state){
+	return LilC_Types::checkWrite(
+		myExp->semanticAnalysis(state), myExp->pos());
+}
+
+bool IfStmtNode::semanticAnalysis(SemanticState& state){
+	bool result = LilC_Types::checkCond(
+		myExp->semanticAnalysis(state), pos());
+	state.symTab->enterScope();
+	state.noteNames(myDecls->nameAnalysis(state.symTab));
+	result = myStmts->semanticAnalysis(state) && result;
+	state.symTab->exitScope();
+	return result;
+}
+
+bool IfElseStmtNode::semanticAnalysis(SemanticState& state){
+	bool result = LilC_Types::checkCond(
+		myExp->semanticAnalysis(state), pos());
+	state.symTab->enterScope();
+	state.noteNames(myDeclsT->nameAnalysis(state.symTab));
+	result = myStmtsT->semanticAnalysis(state) && result;
+	state.noteNames(myDeclsF->nameAnalysis(state.symTab));
+	result = myStmtsF->semanticAnalysis(state) && result;
+	state.symTab->exitScope();
+	return result;
+}
+
+bool WhileStmtNode::semanticAnalysis(SemanticState& state){
+	bool result = LilC_Types::checkCond(
+		myExp->semanticAnalysis(state), pos());
+	state.symTab->enterScope();
+	state.noteNames(myDecls->nameAnalysis(state.symTab));
+	result = myStmts->semanticAnalysis(state) && result;
+	state.symTab->exitScope();
+	return result;
+}
+
+bool CallStmtNode::semanticAnalysis(SemanticState& state){
+	return !myCallExp->semanticAnalysis(state)->isError();
+}
+
+bool ReturnStmtNode::semanticAnalysis(SemanticState& state){
+	const Type * retType = state.fnSym->getRetSymbol()->getType();
+	if (myExp == nullptr){
+		return LilC_Types::checkReturn(retType);
+	}
+	return LilC_Types::checkReturn(retType,
+		myExp->semanticAnalysis(state), myExp->pos());
+}
+
+const Type * ExpNode::computeSemanticType(SemanticState& state){
+	state.noteNames(nameAnalysis(state.symTab));
+	return computeType();
+}
+
+const Type * IdNode::computeSemanticType(SemanticState& state){
+	if (!state.noteNames(nameAnalysis(state.symTab))){
+		return Type::error();
+	}
+	return mySymbol->getType();
+}
+
+const Type * DotAccessNode::computeSemanticType(SemanticState& state){
+	if (!state.noteNames(nameAnalysis(state.symTab))){
+		return Type::error();
+	}
+	return myId->getSymbol()->getType();
+}
+
+const Type * AssignNode::computeSemanticType(SemanticState& state){
+	const Type * lhsType = myExpLHS->semanticAnalysis(state);
+	const Type * rhsType = myExpRHS->semanticAnalysis(state);
+	return LilC_Types::assignType(lhsType, rhsType,
+		myExpLHS->pos());
+}
+
+const Type * CallExpNode::computeSemanticType(SemanticState& state){
+	ASTList<ExpNode *> * args = myExpList->getExps();
+	size_t argsTyped = 0;
+	const Type * result = Type::error();
+	if (state.noteNames(myId->nameAnalysis(state.symTab))){
+		result = callTypeAnalysis(&state, argsTyped);
+	}
+	for (size_t k = argsTyped; k < args->size(); k++){
+		state.noteNames((*args)[k]->nameAnalysis(state.symTab));
+	}
+	return result;
+}
+
+const Type * UnaryExpNode::computeSemanticType(SemanticState& state){
+	return opType(myExp->semanticAnalysis(state));
+}
+
+const Type * BinaryExpNode::computeSemanticType(SemanticState& state){
+	const Type * type1 = myExp1->semanticAnalysis(state);
+	const Type * type2 = myExp2->semanticAnalysis(state);
+	return opType(type1, type2);
+}
+
+} // End namespace LILC
@@ -9,10 +9,6 @@ SymbolTableEntry::SymbolTableEntry(Kind kind) {
 	myKind = kind;
 }
 
-std::string VarSymbol::getTypeString(){
-	return this->typeString;
-}
-
 VarSymbol * VarSymbol::produce(
 	SymbolTable * symTab, 
 	std::string typeStr
@@ -23,12 +19,37 @@ VarSymbol * VarSymbol::produce(
 	} catch (int i){
 		return nullptr;
 	}
-	return new VarSymbol(typeStr, compositeType);
+	if (compositeType != nullptr){
+		return new VarSymbol(compositeType->getVarType(),
+			compositeType);
+	}
+	return new VarSymbol(Type::primitive(typeStr));
 }
 
-StructSymbol::StructSymbol( FieldMap * fields) 
+int VarSymbol::getSize(){
+	if (typeDefinition != nullptr){ return typeDefinition->getSize(); }
+	return 4;
+}
+
+StructSymbol::StructSymbol(Name name, FieldMap * fields,
+  TypeTable& types)
 : SymbolTableEntry(Kind::STRUCT){
 	this->fields = fields;
+
+	size = 0;
+	for (auto itr : *fields){
+		size += itr.second->getSize();
+	}
+
+	//The name's type is spelled by its fields, in the
+	// order the map happens to hold them
+	std::string fieldsSpelling = "{";
+	for (auto itr : *fields){
+		fieldsSpelling += itr.first.str() + ",";
+	}
+	fieldsSpelling += "}";
+	nameType = types.structName(this, fieldsSpelling);
+	varType = types.structVar(this, name.str());
 }
 
 StructSymbol * StructSymbol::getCompositeType(){
@@ -36,16 +57,6 @@ StructSymbol * StructSymbol::getCompositeType(){
 	return NULL;
 }
 
-std::string StructSymbol::getTypeString(){
-	std::string res = "{";
-	for (auto itr : *fields){
-		std::string key = itr.first;
-		res += key + ",";
-	}
-	res += "}";
-	return res;
-}
-
 StructSymbol * SymbolTable::lookupTypeDefn(std::string typeStr){
 	//If the type is primitive, return null
 	// (this isn't an error)
@@ -61,7 +72,7 @@ StructSymbol * SymbolTable::lookupTypeDefn(std::string typeStr){
 	return dynamic_cast<StructSymbol *>(entry);
 }
 
-VarSymbol * StructSymbol::getField(std::string fieldName){
+VarSymbol * StructSymbol::getField(Name fieldName){
 	FieldMap::iterator fItr = fields->find(fieldName);
 	if (fItr == fields->end()){ return nullptr; }
 	return fItr->second;
@@ -69,7 +80,8 @@ VarSymbol * StructSymbol::getField(std::string fieldName){
 
 FuncSymbol::FuncSymbol(
   std::list<VarSymbol *> * formalSymbols,
-  VarSymbol * retSymbol) 
+  VarSymbol * retSymbol,
+  TypeTable& types)
 : SymbolTableEntry(Kind::FUNC)
 {
 	if (formalSymbols == nullptr){
@@ -77,6 +89,18 @@ FuncSymbol::FuncSymbol(
 	}
 	this->formalSymbols = formalSymbols;
 	this->retSymbol = retSymbol;
+
+	//The caller pushes the arguments in order, so the last
+	// is just above the callee's $fp
+	this->paramsSize = 4 * static_cast<int>(formalSymbols->size());
+	int offset = paramsSize;
+	std::vector<const Type *> formalTypes;
+	for (VarSymbol * paramSym : *formalSymbols){
+		formalTypes.push_back(paramSym->getType());
+		paramSym->place(Storage::LOCAL, offset);
+		offset -= 4;
+	}
+	this->type = types.function(formalTypes, retSymbol->getType());
 }
 
 std::list<VarSymbol *> * FuncSymbol::getFormalSymbols(){
@@ -92,87 +116,114 @@ StructSymbol * FuncSymbol::getCompositeType(){
 	return NULL;
 }
 
-std::string FuncSymbol::getTypeString(){
-	std::string res = "";
-
-	bool first = true;
-	for (VarSymbol * paramSym : *formalSymbols){
-		if (first) { first = false; }
-		else { res += ","; }
-		res += paramSym->getTypeString();
-	}
-	return res + "->" + retSymbol->getTypeString();
-}
-
 
 Kind SymbolTableEntry::getKind() {
 	return myKind;
 }
 
 // ScopeTable
-ScopeTable::ScopeTable(){
-	map = new std::unordered_map<std::string, SymbolTableEntry *>();
+ScopeTable::ScopeTable(SymbolTable * tableIn, uint32_t depthIn){
+	table = tableIn;
+	depth = depthIn;
 }
 
-SymbolTableEntry * ScopeTable::findEntry(std::string name){
-	HashMap<std::string, SymbolTableEntry *>::iterator itr;
-	itr = map->find(name);
-	if (itr == map->end()){ return nullptr; }
-	return itr->second;
+SymbolTableEntry * ScopeTable::findEntry(Name name){
+	return table->findAt(name, depth);
 }
 
-Kind ScopeTable::getKind(std::string name) {
-	HashMap<std::string, SymbolTableEntry *>::iterator it = map->find(name);
-	return it->second->getKind(); 
+Kind ScopeTable::getKind(Name name) {
+	return findEntry(name)->getKind(); 
 }
 
-void ScopeTable::add(std::string name, SymbolTableEntry * sym) {
-	map->insert(std::make_pair(name, sym));
+void ScopeTable::add(Name name, SymbolTableEntry * sym) {
+	//As for a map insert, a name already bound here stays so
+	if (findEntry(name) != nullptr){ return; }
+	table->bind(name, sym, depth);
+	declared.push_back(name);
 }
 
 std::string ScopeTable::toString(){
 	std::string res = "---SCOPE---\n";
-	HashMap<std::string, SymbolTableEntry *>::iterator it;
-	for (it = map->begin() ; it != map->end() ; ++it){
-		res += it->first + ":" + 
-		it->second->toString() + "\n";
+	for (Name name : declared){
+		res += name.str() + ":" + 
+		findEntry(name)->toString() + "\n";
 	}
 	return res;
 }
 
-SymbolTable::SymbolTable(){
-	scopeTables = new std::list<ScopeTable *>();
+const uint32_t SymbolTable::NO_BINDING;
+const int SymbolTable::FIRST_LOCAL;
+
+SymbolTable::SymbolTable(NameTable& names) : nameTable(names){
+}
+
+SymbolTable::~SymbolTable(){
+	for (ScopeTable * scope : scopes){
+		delete scope;
+	}
 }
 
 std::string SymbolTable::toString(){
 	std::string res = "";
-	for (ScopeTable * scopeTab : *scopeTables){
-		res += scopeTab->toString();
+	for (size_t i = numScopes; i > 0; i--){
+		res += scopes[i - 1]->toString();
 	}
 	return res;
 }
 
-bool SymbolTable::collides(std::string name){
+bool SymbolTable::collides(Name name){
 	SymbolTableEntry * entry = currentScope()->findEntry(name);
 	return entry != nullptr;
 }
 
 
 ScopeTable * SymbolTable::enterScope() {
-	ScopeTable * res = new ScopeTable();
-	scopeTables->push_front(res);
-	return res;
+	if (numScopes == scopes.size()){
+		scopes.push_back(new ScopeTable(this,
+			static_cast<uint32_t>(numScopes)));
+	}
+	scopes[numScopes]->frameMark = nextLocal;
+	return scopes[numScopes++];
 }
 
 void SymbolTable::exitScope() {
-	scopeTables->pop_front();
+	ScopeTable * scope = currentScope();
+	nextLocal = scope->frameMark;
+	//Inner scopes are gone, so each of this scope's
+	// bindings is the innermost of its name
+	while (!scope->declared.empty()){
+		unbind(scope->declared.back());
+		scope->declared.pop_back();
+	}
+	numScopes--;
+}
+
+void SymbolTable::beginFrame(){
+	nextLocal = FIRST_LOCAL;
+	lowestLocal = FIRST_LOCAL;
+}
+
+void SymbolTable::place(VarSymbol * var){
+	if (numScopes <= 1){
+		var->place(Storage::GLOBAL, 0);
+		return;
+	}
+	//A struct's fields go up from its lowest word
+	int size = var->getSize();
+	var->place(Storage::LOCAL, nextLocal - size + 4);
+	nextLocal -= size;
+	if (nextLocal < lowestLocal){ lowestLocal = nextLocal; }
+}
+
+int SymbolTable::endFrame(){
+	return FIRST_LOCAL - lowestLocal;
 }
 
 ScopeTable * SymbolTable::currentScope(){
-	return scopeTables->front();
+	return scopes[numScopes - 1];
 }
 
-bool SymbolTable::add(std::string name, SymbolTableEntry * symbol) {
+bool SymbolTable::add(Name name, SymbolTableEntry * symbol) {
 	if (this->collides(name)){ return false; }
 
 	ScopeTable * cur = currentScope();
@@ -180,12 +231,68 @@ bool SymbolTable::add(std::string name, SymbolTableEntry * symbol) {
 	return true;
 }
 
-SymbolTableEntry * SymbolTable::lookup(std::string name) const {
-	for (ScopeTable * scope : *scopeTables){
-		SymbolTableEntry * res = scope->findEntry(name);
-		if (res != nullptr) { return res; }
+SymbolTableEntry * SymbolTable::lookup(Name name) const {
+	if (name.id() >= innermost.size()){ return nullptr; }
+	uint32_t b = innermost[name.id()];
+	if (b == NO_BINDING){ return nullptr; }
+	return bindings[b].symbol;
+}
+
+SymbolTableEntry * SymbolTable::findAt(Name name, uint32_t depth) const {
+	if (name.id() >= innermost.size()){ return nullptr; }
+	uint32_t b = innermost[name.id()];
+	while (b != NO_BINDING && bindings[b].depth > depth){
+		b = bindings[b].shadowed;
 	}
-	return nullptr;
+	if (b == NO_BINDING || bindings[b].depth != depth){
+		return nullptr;
+	}
+	return bindings[b].symbol;
+}
+
+/*
+* Usually depth is the current scope's and the binding goes on
+* the front of the chain, but a function's own name is bound in
+* the enclosing scope after its formals are, so it goes behind
+* any bindings from deeper scopes.
+*/
+void SymbolTable::bind(Name name, SymbolTableEntry * symbol,
+	uint32_t depth)
+{
+	if (name.id() >= innermost.size()){
+		innermost.resize(name.id() + 1, NO_BINDING);
+	}
+	uint32_t b;
+	if (freeBindings.empty()){
+		b = static_cast<uint32_t>(bindings.size());
+		bindings.push_back(Binding());
+	} else {
+		b = freeBindings.back();
+		freeBindings.pop_back();
+	}
+
+	uint32_t * link = &innermost[name.id()];
+	while (*link != NO_BINDING && bindings[*link].depth > depth){
+		link = &bindings[*link].shadowed;
+	}
+	bindings[b].symbol = symbol;
+	bindings[b].depth = depth;
+	bindings[b].shadowed = *link;
+	*link = b;
+}
+
+void SymbolTable::unbind(Name name){
+	uint32_t b = innermost[name.id()];
+	innermost[name.id()] = bindings[b].shadowed;
+	freeBindings.push_back(b);
+}
+
+/*
+* Convenience for names that don't come from an IdNode (type
+* strings, "main"). Interning an unseen name is harmless.
+*/
+SymbolTableEntry * SymbolTable::lookup(const std::string& name) const {
+	return lookup(nameTable.intern(name));
 }
 
 } // End namespace LILC
@@ -3,6 +3,10 @@
 #include <string>
 #include <unordered_map>
 #include <list>
+#include <vector>
+#include <cstdint>
+#include "lilc_names.hpp"
+#include "lilc_types.hpp"
 
 namespace LILC{
 	class VarSymbol;
@@ -15,7 +19,7 @@ using HashMap = std::unordered_map<K, V>;
 
 //Use an alias so that we can fix a set of particular 
 // templatization of HashMap and avoid providing the generics
-using FieldMap = std::unordered_map<std::string, LILC::VarSymbol *>;
+using FieldMap = std::unordered_map<LILC::Name, LILC::VarSymbol *>;
 
 using namespace std;
 
@@ -28,6 +32,8 @@ class StructSymbol;
 
 enum class Kind { VAR, FUNC, STRUCT };
 enum class DeclKind { VAR, FORMAL, FUNC, STRUCT };
+// Where name analysis put a variable (see SymbolTable::place)
+enum class Storage { GLOBAL, LOCAL, FIELD };
 		
 //A single entry for one name in the symbol table
 class SymbolTableEntry{
@@ -36,7 +42,10 @@ class SymbolTableEntry{
 		Kind getKind();
 		ScopeTable * getScopeTable() const;
 
-		virtual std::string getTypeString() = 0;
+		virtual const Type * getType() = 0;
+		const std::string& getTypeString() {
+			return getType()->toString();
+		}
 		virtual StructSymbol * getCompositeType() = 0;
 		virtual std::string toString() {
 			return "Symbol";
@@ -49,92 +58,178 @@ class SymbolTableEntry{
 class VarSymbol : public SymbolTableEntry{
 	public:
 		VarSymbol(
-			std::string typeStringIn, 
+			const Type * typeIn, 
 			StructSymbol * structIn = nullptr
 		  	) : SymbolTableEntry(Kind::VAR) {
-			this->typeString = typeStringIn;
+			this->type = typeIn;
 			typeDefinition = structIn;
 		}
 		static VarSymbol * produce(
 			SymbolTable * symTab, 
 			std::string typeStr);
 		
-		virtual std::string getTypeString() override;
+		const Type * getType() override { return type; }
 		StructSymbol * getCompositeType() override{
 			return typeDefinition;
 		}
 		std::string toString() override{
 			return "VAR:" + getTypeString();
 		}
+
+		// A global sits at its own label, a local or formal
+		// offset bytes from its frame's $fp, and a field offset
+		// bytes into whatever struct holds it
+		void place(Storage storageIn, int offsetIn){
+			storage = storageIn;
+			offset = offsetIn;
+		}
+		Storage getStorage() const { return storage; }
+		int getOffset() const { return offset; }
+		// A word, or as many as its struct's fields take
+		int getSize();
 	private:
-		std::string typeString;
+		const Type * type;
 		StructSymbol * typeDefinition;
+		Storage storage = Storage::GLOBAL;
+		int offset = 0;
 };
 
 class StructSymbol : public SymbolTableEntry{
 	public:
-		StructSymbol(FieldMap * fields);
-		VarSymbol * getField(std::string fieldName);
+		// The struct's types are made in types
+		StructSymbol(Name name, FieldMap * fields, TypeTable& types);
+		VarSymbol * getField(Name fieldName);
 		StructSymbol * getCompositeType() override;
-		std::string getTypeString() override;
+		// The type of the struct's name itself
+		const Type * getType() override { return nameType; }
+		// The type of variables declared with this struct
+		const Type * getVarType() { return varType; }
+		// The bytes a variable of this struct takes; the fields
+		// were given their offsets as they were declared
+		int getSize() const { return size; }
 		std::string toString() override {
 			return this->getTypeString();
 		}
 	private:
 		FieldMap * fields;
-		std::string typeName;
+		int size;
+		const Type * nameType;
+		const Type * varType;
 };
 
 class FuncSymbol : public SymbolTableEntry{
 	public:
 		FuncSymbol(
 		  std::list<VarSymbol *> * formalSymbols,
-		  VarSymbol * retSymbol
+		  VarSymbol * retSymbol,
+		  TypeTable& types
 		);
 		std::string toString() override {
 			return "FuncSymbol";
 		}
 		VarSymbol * getRetSymbol();
 		StructSymbol * getCompositeType() override;
-		std::string getTypeString() override;
+		const Type * getType() override { return type; }
 		std::list<VarSymbol *> * getFormalSymbols();
+		// The bytes of arguments the caller pushes, and of locals
+		// the frame holds below the saved registers
+		int getParamsSize() const { return paramsSize; }
+		int getLocalsSize() const { return localsSize; }
+		void setLocalsSize(int sizeIn){ localsSize = sizeIn; }
 	private:
 		std::list<VarSymbol *> * formalSymbols;
 		VarSymbol * retSymbol;
+		const Type * type;
+		int paramsSize;
+		int localsSize = 0;
 };
 
-//A single scope
+//A single scope. Its bindings live in the SymbolTable's
+// shadow chains; the scope itself only records which names
+// it bound, so that leaving it undoes just those.
 class ScopeTable{
 	public:
-		ScopeTable();
+		ScopeTable(SymbolTable * table, uint32_t depth);
+		virtual ~ScopeTable() { }
 
-		Kind getKind(std::string name);
-		SymbolTableEntry * findEntry(std::string name);
+		Kind getKind(Name name);
+		SymbolTableEntry * findEntry(Name name);
 		
-		void add(std::string name, SymbolTableEntry * entry);
-		void remove(std::string name);
+		void add(Name name, SymbolTableEntry * entry);
+		void remove(Name name);
 		virtual std::string toString();
 
 	private:
-		HashMap<std::string, SymbolTableEntry *>* map;
+		friend class SymbolTable;
+		SymbolTable * table;
+		uint32_t depth; // 0 for the outermost scope
+		std::vector<Name> declared; // the undo log
+		int frameMark = 0; // the frame's next free slot on entry
 };
 
+/*
+* All scopes share one table indexed by Name::id(). Each name
+* heads a chain of its bindings, innermost first, so a lookup
+* is a single probe however deep the nesting; exiting a scope
+* pops its own bindings off their chains and nothing more.
+*/
 class SymbolTable final {
 	public:
-		SymbolTable();
+		// Names looked up by string are interned in names
+		explicit SymbolTable(NameTable& names);
+		~SymbolTable();
 
 		ScopeTable * enterScope();
 		void exitScope();
-		bool add(std::string name, SymbolTableEntry * ent);
-		SymbolTableEntry * lookup(std::string name) const;
-		bool collides(std::string name); 
+		bool add(Name name, SymbolTableEntry * ent);
+		SymbolTableEntry * lookup(Name name) const;
+		SymbolTableEntry * lookup(const std::string& name) const;
+		bool collides(Name name); 
 		ScopeTable * currentScope();
 		StructSymbol * lookupTypeDefn(std::string typeStr);
+		// The struct and function types of this compilation
+		TypeTable& getTypes() { return typeTable; }
 		void show() const;
 		virtual std::string toString();
 
+		/*
+		* Laying out a function's frame as its body is analysed:
+		* beginFrame when the body's scope has been entered, place
+		* each variable as it is declared, and endFrame for the
+		* bytes of locals the frame needs. Locals go down from
+		* FIRST_LOCAL, below the saved $ra and $fp (see CodeGen);
+		* once a block's scope is exited its slots are reused.
+		* Outside any function, place makes the variable global.
+		*/
+		static const int FIRST_LOCAL = -8;
+		void beginFrame();
+		void place(VarSymbol * var);
+		int endFrame();
+
 	private:
-		std::list<ScopeTable *> * scopeTables;
+		friend class ScopeTable;
+		static const uint32_t NO_BINDING = UINT32_MAX;
+		struct Binding{
+			SymbolTableEntry * symbol;
+			uint32_t depth;
+			uint32_t shadowed; // the next binding out, if any
+		};
+
+		SymbolTableEntry * findAt(Name name, uint32_t depth) const;
+		void bind(Name name, SymbolTableEntry * symbol, uint32_t depth);
+		void unbind(Name name);
+
+		NameTable& nameTable;
+		TypeTable typeTable;
+		// scopes[0 .. numScopes) are live, innermost last;
+		// the rest are kept to be reused
+		std::vector<ScopeTable *> scopes;
+		size_t numScopes = 0;
+		std::vector<uint32_t> innermost; // by Name::id()
+		std::vector<Binding> bindings;
+		std::vector<uint32_t> freeBindings;
+		int nextLocal = FIRST_LOCAL; // the next free word
+		int lowestLocal = FIRST_LOCAL; // the deepest that's been used
 };
 
 
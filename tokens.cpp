@@ -0,0 +1,30 @@
+#include "tokens.hpp"
+#include "grammar.hh"
+
+/* typedef to make the returns for the tokens shorter */
+using TokenTag = LILC::LilC_Parser::token;
+
+namespace LILC{
+
+/*
+* These live here rather than in lilc.l since every TokenSource
+* (the flex scanner, the DFA scanner and the token stream reader)
+* builds tokens.
+*/
+IDToken::IDToken(size_t ll, size_t cc, Name value)
+: Token(ll,cc,TokenTag::ID){
+	this->_value = value;
+}
+
+IntLitToken::IntLitToken(size_t ll, size_t cc, int value)
+: Token(ll,cc,TokenTag::INTLITERAL){
+	this->_value = value;
+}
+
+StringLitToken::StringLitToken(size_t ll, size_t cc, TokenText value)
+: Token(ll,cc,TokenTag::STRINGLITERAL)
+{
+	this->_value = value;
+}
+
+} // End namespace LILC
@@ -2,13 +2,28 @@
 #define LILC_SEMANTIC_SYMBOL_H
 
 #include "err.hpp"
+#include "lilc_names.hpp"
 #include <iostream>
+#include <climits>
+#include <cstddef>
+#include <type_traits>
 
 namespace LILC{
 
+/*
+* The text of a string literal lexeme. When the
+* scanner is reading a mapped SourceFile this points straight
+* into the mapping; otherwise it points at a copy in the token
+* arena. Either way the bytes are not NUL-terminated.
+*/
+struct TokenText {
+	const char * data;
+	size_t size;
+	std::string str() const { return std::string(data, size); }
+};
+
 class Token {
 	public:
-		std::string name;
 		Token(size_t lineIn, size_t columnIn, int tag){ 
 			this->_tag = tag; 
 			this->line = lineIn;
@@ -32,28 +47,65 @@ class NullaryToken : public Token {
 
 class IntLitToken : public Token {
 	public:
-		IntLitToken(size_t line, size_t col, int value); //Defined in lilc_lexer.l
+		IntLitToken(size_t line, size_t col, int value); //Defined in tokens.cpp
 		int value() { return _value; }
+
+		/*
+		* Convert the run of decimal digits starting at p into
+		* value, in one pass and without allocating. Literals
+		* above INT_MAX saturate to INT_MAX and set overflow.
+		* Returns the first non-digit in [p, end), so scanners
+		* that haven't found the end of the lexeme yet can use
+		* it to do so.
+		*/
+		static const char * convert(const char * p, const char * end,
+			int& value, bool& overflow)
+		{
+			int val = 0;
+			overflow = false;
+			for (; p < end && *p >= '0' && *p <= '9'; p++){
+				int digit = *p - '0';
+				if (overflow){ continue; }
+				if (val > (INT_MAX - digit) / 10){
+					overflow = true;
+					val = INT_MAX;
+				} else {
+					val = val * 10 + digit;
+				}
+			}
+			value = val;
+			return p;
+		}
 	private:
 		int _value;
 };
 
 class IDToken : public Token {
 	public:
-		IDToken(size_t line, size_t col, std::string id); //Defined in lilc_lexer.l
-		std::string value() { return _value; }
+		IDToken(size_t line, size_t col, Name id); //Defined in tokens.cpp
+		const std::string& value() { return _value.str(); }
+		Name name() { return _value; }
 	private:
-		std::string _value;
+		Name _value;
 };
 
 class StringLitToken : public Token {
 	public:
-		StringLitToken(size_t line, size_t col, std::string value); //Defined in lilc_lexer.l
-		std::string value() { return _value; }
+		StringLitToken(size_t line, size_t col, TokenText value); //Defined in tokens.cpp
+		std::string value() { return _value.str(); }
+		TokenText text() { return _value; }
 	private:
-		std::string _value;
+		TokenText _value;
 };
 
+// Tokens are bump-allocated from the compiler's token arena and
+// released wholesale, so none of them may own resources.
+static_assert(std::is_trivially_destructible<IDToken>::value &&
+	std::is_trivially_destructible<IntLitToken>::value &&
+	std::is_trivially_destructible<StringLitToken>::value &&
+	std::is_trivially_destructible<NullaryToken>::value,
+	"Tokens must be trivially destructible");
+
 } //End namespace
 
 #endif
@@ -2,6 +2,7 @@
 #include "ast.hpp"
 #include "symbol_table.hpp"
 #include "lilc_types.hpp"
+#include "lilc_parallel.hpp"
 
 namespace LILC{
 
@@ -16,14 +17,29 @@ bool ProgramNode::typeAnalysis(){
 	return myDeclList->typeAnalysis();
 }
 
+bool ProgramNode::typeAnalysis(unsigned jobs){
+	return myDeclList->typeAnalysis(jobs);
+}
+
 bool DeclListNode::typeAnalysis(){
 	bool result = true;
-	for (DeclNode * node : *myDecls){
+	for (DeclNode * node : myDecls){
 		result = node->typeAnalysis() && result;
 	}
 	return result;
 }
 
+/*
+* Each function's body is checked against symbols that name
+* analysis has finished with, so the functions can be checked
+* on separate threads.
+*/
+bool DeclListNode::typeAnalysis(unsigned jobs){
+	return parallelChecks(myDecls.size(), jobs, [this](size_t i){
+		return myDecls[i]->typeAnalysis();
+	});
+}
+
 //This will be overridden by the FnDeclNode,
 // but all other declaration node types don't
 // need to do typeAnalysis
@@ -54,91 +70,45 @@ bool FnBodyNode::fnTypeAnalysis(FuncSymbol * fnSym){
 
 bool StmtListNode::stmtTypeAnalysis(FuncSymbol * fnSym){
 	bool result = true;
-	for (StmtNode * stmt : *myStmts){
+	for (StmtNode * stmt : myStmts){
 		result = stmt->stmtTypeAnalysis(fnSym) && result;
 	}
 	return result;
 }
 
 bool AssignStmtNode::stmtTypeAnalysis(FuncSymbol * fnSym){
-	return myAssign->expTypeAnalysis() != "ERROR";
+	return !myAssign->expTypeAnalysis()->isError();
 }
 
 bool PostIncStmtNode::stmtTypeAnalysis(FuncSymbol * fnSym){
-	std::string type = myExp->expTypeAnalysis();
-	if (type == "ERROR"){ return false; }
-	if (type != "int"){
-		return TypeErr::badMath(getPosition()) != "ERROR";
-	}
-	return true;
+	return LilC_Types::checkIncDec(
+		myExp->expTypeAnalysis(), pos());
 }
 
 bool PostDecStmtNode::stmtTypeAnalysis(FuncSymbol * fnSym){
-	std::string type = myExp->expTypeAnalysis();
-	if (type == "ERROR"){ return false; }
-	if (type != "int"){
-		return TypeErr::badMath(getPosition()) != "ERROR";
-	}
-	return true;
+	return LilC_Types::checkIncDec(
+		myExp->expTypeAnalysis(), pos());
 }
 
 bool ReadStmtNode::stmtTypeAnalysis(FuncSymbol * fnSym){
-	std::string type = myExp->expTypeAnalysis();
-	if (type == "ERROR"){ return false; }
-	if (LilC_Types::isFnSig(type)){
-		TypeErr::readFunction(myExp->getPosition());
-		return false;
-	}
-	if (LilC_Types::isStructName(type)){
-		TypeErr::readStructName(myExp->getPosition());
-		return false;
-	}
-	if (!LilC_Types::isPrimitive(type)){
-		TypeErr::readStructVar(myExp->getPosition());
-		return false;
-	}
-	return true;
+	return LilC_Types::checkRead(
+		myExp->expTypeAnalysis(), myExp->pos());
 }
 
 bool WriteStmtNode::stmtTypeAnalysis(FuncSymbol * fnSym){
-	auto type = myExp->expTypeAnalysis();
-	if (type == "ERROR"){ return false; }
-	if (LilC_Types::isFnSig(type)){
-		TypeErr::writeFunction(myExp->getPosition());
-		return false;
-	}
-	if (LilC_Types::isStructName(type)){
-		TypeErr::writeStructName(myExp->getPosition());
-		return false;
-	}
-	if (LilC_Types::isVoid(type)){
-		TypeErr::writeVoid(myExp->getPosition());
-		return false;
-	}
-	if (!LilC_Types::isPrimitive(type)){
-		TypeErr::writeStructVar(myExp->getPosition());
-		return false;
-	}
-	return true;
+	return LilC_Types::checkWrite(
+		myExp->expTypeAnalysis(), myExp->pos());
 }
 
 bool IfStmtNode::stmtTypeAnalysis(FuncSymbol * fnSym){
-	std::string expType = this->myExp->expTypeAnalysis();
-	bool result = true;
-	if (expType != "bool"){
-		TypeErr::badIfCond(getPosition());
-		result = false;
-	}
+	bool result = LilC_Types::checkCond(
+		this->myExp->expTypeAnalysis(), pos());
 	return myStmts->stmtTypeAnalysis(fnSym) && result;
 }
 
 bool IfElseStmtNode::stmtTypeAnalysis(FuncSymbol * fnSym){
-	std::string expType = this->myExp->expTypeAnalysis();
-	bool result = true;
-	if (expType != "bool"){
-		TypeErr::badIfCond(getPosition());
-		result = false;
-	}
+	bool result = LilC_Types::checkCond(
+		this->myExp->expTypeAnalysis(), pos());
 	result = myStmtsT->stmtTypeAnalysis(fnSym) && result;
 	result = myStmtsF->stmtTypeAnalysis(fnSym) && result;
 
@@ -146,127 +116,52 @@ bool IfElseStmtNode::stmtTypeAnalysis(FuncSymbol * fnSym){
 }
 
 bool WhileStmtNode::stmtTypeAnalysis(FuncSymbol * fnSym){
-	std::string expType = this->myExp->expTypeAnalysis();
-	bool result = true;
-	if (expType != "bool"){
-		TypeErr::badIfCond(getPosition());
-		result = false;
-	}
+	bool result = LilC_Types::checkCond(
+		this->myExp->expTypeAnalysis(), pos());
 	return myStmts->stmtTypeAnalysis(fnSym) && result;
 }
 
 bool CallStmtNode::stmtTypeAnalysis(FuncSymbol * fnSym){
-	return myCallExp->expTypeAnalysis() != "ERROR";
+	return !myCallExp->expTypeAnalysis()->isError();
 }
 
 bool ReturnStmtNode::stmtTypeAnalysis(FuncSymbol * fnSym){
 	VarSymbol * retSym = fnSym->getRetSymbol();
-	std::string retType = retSym->getTypeString();
-	if (retType == "ERROR"){ return false; }
-
+	const Type * retType = retSym->getType();
 	if (myExp == NULL){
-		if (retType == "void"){ return true; }
-		TypeErr::missingReturnValue("0,0"); 
-		return false;
+		return LilC_Types::checkReturn(retType);
 	}
-	std::string expType = myExp->expTypeAnalysis();
-	if (expType == "ERROR"){ return false; }
-
-	if (retType != expType){
-		if (retType == "void"){
-			TypeErr::returnFromVoid(myExp->getPosition());
-			return false;
-		}
-		TypeErr::badReturnValue(myExp->getPosition());
-		return false;
-	}
-	return retType == expType;
+	return LilC_Types::checkReturn(retType,
+		myExp->expTypeAnalysis(), myExp->pos());
 }
 
-std::string IdNode::expTypeAnalysis(){
+const Type * IdNode::computeType(){
 	SymbolTableEntry * mySym = getSymbol();
 	if (mySym == NULL){
 		throw InternalError("Id without a symbol");
 	}
-	return mySym->getTypeString();
+	return mySym->getType();
 }
 
-std::string StrLitNode::expTypeAnalysis(){
-	return "string";
+const Type * StrLitNode::computeType(){
+	return Type::stringType();
 }
 
-std::string IntLitNode::expTypeAnalysis(){
-	return "int";
+const Type * IntLitNode::computeType(){
+	return Type::intType();
 }
 
-std::string BinaryExpNode::expectedResType(){
-	switch (this->binOpKind()){
-		case BinOpKind::MATH: 
-			return "int";
-		case BinOpKind::LOG:
-			return "bool";
-		case BinOpKind::REL:
-			return "bool";
-		default:
-			throw InternalError(
-				"Unknown binary operation kind");
-	}
+const Type * BinaryExpNode::computeType(){
+	const Type * type1 = myExp1->expTypeAnalysis();
+	const Type * type2 = myExp2->expTypeAnalysis();
+	return opType(type1, type2);
 }
 
-bool BinaryExpNode::acceptsOperandType(std::string opIn){
-	switch (this->binOpKind()){
-		case BinOpKind::MATH: 
-			if (opIn == "int"){ return true; }
-			return false;
-		case BinOpKind::LOG:
-			if (opIn == "bool"){ return true; }
-			return false;
-		case BinOpKind::REL:
-			if (opIn == "int"){ return true; }
-			return false;
-		default:
-			throw InternalError(
-				"Unknown binary operation kind");
-	}
-}
-
-std::string BinaryExpNode::reportOpErr(std::string ePos){
-	switch (this->binOpKind()){
-		case BinOpKind::MATH: 
-			return TypeErr::badMath(ePos);
-		case BinOpKind::LOG:
-			return TypeErr::badLogical(ePos);
-		case BinOpKind::REL:
-			return TypeErr::badRelational(ePos);
-		default:
-			throw InternalError(
-				"Unknown binary operation kind");
-	}
-}
-
-std::string BinaryExpNode::expTypeAnalysis(){
-	std::string pos1 = myExp1->getPosition();
-	std::string pos2 = myExp2->getPosition();
-	std::string actualType1 = myExp1->expTypeAnalysis();
-	std::string actualType2 = myExp2->expTypeAnalysis();
-	if (actualType1 == "ERROR" || actualType2 == "ERROR"){
-		return "ERROR";
-	}
-
-	bool resOk = true;
-	if (!acceptsOperandType(myExp1->expTypeAnalysis())){
-		this->reportOpErr(pos1);
-		resOk = false;
-	}
-	if (!acceptsOperandType(myExp2->expTypeAnalysis())){
-		this->reportOpErr(pos2);
-		resOk = false;
-	}
-
-	if (!resOk){ return "ERROR"; }
-	else { return expectedResType(); }
-
-	return "ERROR";
+const Type * BinaryExpNode::opType(const Type * type1,
+	const Type * type2)
+{
+	return LilC_Types::binaryType(binOpKind(), type1, type2,
+		myExp1->pos(), myExp2->pos());
 }
 
 BinOpKind NotEqualsNode::binOpKind() {
@@ -277,107 +172,71 @@ BinOpKind EqualsNode::binOpKind() {
 	throw InternalError("Check the binOp kind of a ==");
 }
 
-static std::string eqTypeAnalysis(
-	std::string lhsType,
-	std::string rhsType,
-	std::string pos
-){
-	if (lhsType == "ERROR" || rhsType == "ERROR"){
-		return "ERROR";
-	}
-	if (lhsType != rhsType){
-		return TypeErr::typeMismatch(pos);
-	}
-	if (LilC_Types::isFnSig(lhsType)){
-		return TypeErr::funEq(pos);
-	}
-	if (LilC_Types::isStructName(lhsType)){
-		return TypeErr::structNameEq(pos);
-	}
-	if (LilC_Types::isVoid(lhsType)){
-		return TypeErr::voidEq(pos);
-	}
-	if (!LilC_Types::isPrimitive(lhsType)){
-		return TypeErr::structVarEq(pos);
-	}
-	return "bool";
+const Type * EqualsNode::opType(const Type * type1,
+	const Type * type2)
+{
+	return LilC_Types::equalityType(type1, type2, myExp1->pos());
 }
 
-std::string EqualsNode::expTypeAnalysis(){
-	return eqTypeAnalysis(
-		myExp1->expTypeAnalysis(),
-		myExp2->expTypeAnalysis(),
-		myExp1->getPosition()
-		);
+const Type * NotEqualsNode::opType(const Type * type1,
+	const Type * type2)
+{
+	return LilC_Types::equalityType(type1, type2, pos());
 }
 
-std::string NotEqualsNode::expTypeAnalysis(){
-	return eqTypeAnalysis(
-		myExp1->expTypeAnalysis(),
-		myExp2->expTypeAnalysis(),
-		getPosition()
-		);
+const Type * TrueNode::computeType(){
+	return Type::boolType();
 }
 
-std::string TrueNode::expTypeAnalysis(){
-	return "bool";
+const Type * FalseNode::computeType(){
+	return Type::boolType();
 }
 
-std::string FalseNode::expTypeAnalysis(){
-	return "bool";
+const Type * DotAccessNode::computeType(){
+	SymbolTableEntry * entry = myId->getSymbol();
+	return entry->getType();
 }
 
-std::string DotAccessNode::expTypeAnalysis(){
-	SymbolTableEntry * entry = myId->getSymbol();
-	return entry->getTypeString();
-}
-
-std::string AssignNode::expTypeAnalysis(){
-	std::string errPos = myExpLHS->getPosition();
-	std::string lhsType = myExpLHS->expTypeAnalysis();
-	std::string rhsType = myExpRHS->expTypeAnalysis();
-	//The spec isn't crystal clear whether a type that could
-	// NEVER be an assign operand should raise a report
-	// if the other operand is error. In keeping with the 
-	// spirit of the "(true + 3) == x" example, which 
-	// raises just 1 error regardless of the type of x, this 
-	// implementation doesn't raise an error on x even if it's 
-	// a function, etc.
-	if (lhsType == "ERROR" || rhsType == "ERROR"){
-		return "ERROR";
-	}
-	if (lhsType == rhsType){
-		if (LilC_Types::isFnSig(lhsType)){
-			return TypeErr::assignFunction(errPos);
-		}
-		if (LilC_Types::isStructName(lhsType)){
-			return TypeErr::assignStructName(errPos);
-		}
-		if (!LilC_Types::isPrimitive(lhsType)){
-			return TypeErr::assignStructVar(errPos);
-		}
-		return lhsType;
-	}
-	return TypeErr::typeMismatch(errPos);
+const Type * AssignNode::computeType(){
+	const Type * lhsType = myExpLHS->expTypeAnalysis();
+	const Type * rhsType = myExpRHS->expTypeAnalysis();
+	return LilC_Types::assignType(lhsType, rhsType,
+		myExpLHS->pos());
+}
+
+const Type * CallExpNode::computeType(){
+	size_t argsTyped;
+	return callTypeAnalysis(nullptr, argsTyped);
 }
 
-std::string CallExpNode::expTypeAnalysis(){
-	std::string errPos = myId->getPosition();
+/*
+* Shared with semanticAnalysis, which passes its state so that
+* each argument's names are resolved as it is typed. Either way,
+* argsTyped is how many arguments were looked at before the
+* call's type was known.
+*/
+const Type * CallExpNode::callTypeAnalysis(SemanticState * state,
+	size_t& argsTyped)
+{
+	argsTyped = 0;
+	SourcePos errPos = myId->pos();
 	SymbolTableEntry * rawSym = myId->getSymbol();
 	if (rawSym->getKind() != Kind::FUNC){
-		return TypeErr::callNonFunc(errPos);
+		TypeErr::callNonFunc(errPos);
+		return Type::error();
 	}
 	FuncSymbol * fnSym = dynamic_cast<FuncSymbol *>(rawSym);
 	VarSymbol * retVar = fnSym->getRetSymbol();
-	std::string retType = retVar->getTypeString();
+	const Type * retType = retVar->getType();
 
 	std::list<VarSymbol *> * formals = 
 		fnSym->getFormalSymbols();
-	std::list<ExpNode *> * args = myExpList->getExps();
+	ASTList<ExpNode *> * args = myExpList->getExps();
 	//Count args
 	size_t numArgs = args->size();
 	if (numArgs != formals->size()){
-		return TypeErr::badNumArgs(errPos);
+		TypeErr::badNumArgs(errPos);
+		return Type::error();
 	}
 	{ //Walk both formal and actual simultaneously
 		auto argItr = args->begin();
@@ -385,21 +244,24 @@ std::string CallExpNode::expTypeAnalysis(){
 		for (size_t argI = 0 ; argI < numArgs; argI++){
 			ExpNode * arg = *argItr;
 			VarSymbol * formal = *formalItr;
-			std::string argErrPos = arg->getPosition();
-
-			std::string actualType = 
-				arg->expTypeAnalysis();
-			std::string formalType = 
-				formal->getTypeString();
-			if (actualType == "ERROR"){
-				return "ERROR";
+			SourcePos argErrPos = arg->pos();
+
+			const Type * actualType = state == nullptr
+				? arg->expTypeAnalysis()
+				: arg->semanticAnalysis(*state);
+			argsTyped++;
+			const Type * formalType = 
+				formal->getType();
+			if (actualType->isError()){
+				return actualType;
 			}
-			if (formalType == "ERROR"){
-				return "ERROR";
+			if (formalType->isError()){
+				return formalType;
 			}
-			if (actualType != formalType){
-				TypeErr::argMismatch(argErrPos);
-				retType = "ERROR";
+			if (!LilC_Types::checkArg(actualType, formalType,
+				argErrPos))
+			{
+				retType = Type::error();
 			}
 			argItr++;
 			formalItr++;
@@ -410,18 +272,18 @@ std::string CallExpNode::expTypeAnalysis(){
 
 
 
-std::string NotNode::expTypeAnalysis(){
-	std::string expType = myExp->expTypeAnalysis();
-	if (expType == "ERROR"){ return expType; }
-	if (expType == "bool"){ return expType; }
-	return TypeErr::badLogical(myExp->getPosition());
+const Type * UnaryExpNode::computeType(){
+	return opType(myExp->expTypeAnalysis());
+}
+
+const Type * NotNode::opType(const Type * operand){
+	return LilC_Types::unaryType(BinOpKind::LOG,
+		operand, myExp->pos());
 }
 
-std::string UnaryMinusNode::expTypeAnalysis(){
-	std::string expType = myExp->expTypeAnalysis();
-	if (expType == "ERROR"){ return expType; }
-	if (expType == "int"){ return expType; }
-	return TypeErr::badMath(myExp->getPosition());
+const Type * UnaryMinusNode::opType(const Type * operand){
+	return LilC_Types::unaryType(BinOpKind::MATH,
+		operand, myExp->pos());
 }
 
 /*
@@ -433,7 +295,7 @@ std::string UnaryMinusNode::expTypeAnalysis(){
 std::string FormalsListNode::getTypeString(){
 	std::string res = "";
 	bool first = true;
-	for (FormalDeclNode * decl : *myFormals){
+	for (FormalDeclNode * decl : myFormals){
 		if (first){ first = false; }
 		else { res += ","; }
 		res += decl->getTypeString();
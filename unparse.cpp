@@ -8,9 +8,9 @@ void ProgramNode::unparse(std::ostream& out, int indent){
 }
 
 void DeclListNode::unparse(std::ostream& out, int indent){
-	for (std::list<DeclNode *>::iterator 
-		it=myDecls->begin();
-		it != myDecls->end(); ++it){
+	for (ASTList<DeclNode *>::iterator 
+		it=myDecls.begin();
+		it != myDecls.end(); ++it){
 	    DeclNode * elt = *it;
 	    elt->unparse(out, indent);
 	}
@@ -18,7 +18,7 @@ void DeclListNode::unparse(std::ostream& out, int indent){
 
 void FormalsListNode::unparse(std::ostream& out, int indent){
 	bool first = true;
-	for (FormalDeclNode * formal : *myFormals){
+	for (FormalDeclNode * formal : myFormals){
 		if (first){ first = false; }
 		else { out << ", "; }
 		formal->unparse(out, indent);
@@ -43,8 +43,8 @@ void ExpListNode::unparse(std::ostream& out, int indent){
 }
 
 void StmtListNode::unparse(std::ostream& out, int indent){
-	for (std::list<StmtNode *>::iterator it=myStmts->begin();
-		it != myStmts->end(); ++it){
+	for (ASTList<StmtNode *>::iterator it=myStmts.begin();
+		it != myStmts.end(); ++it){
 	    StmtNode * elt = *it;
 	    elt->unparse(out, indent);
 	}
@@ -174,7 +174,7 @@ void ReturnStmtNode::unparse(std::ostream& out, int indent){
 }
 
 void IdNode::unparse(std::ostream& out, int indent){
-	out << myStrVal;
+	out << myName.str();
 	if(mySymbol != nullptr) {
 		out << "(" << mySymbol->getTypeString() << ")";
 	} else {
@@ -207,7 +207,8 @@ void IntLitNode::unparse(std::ostream& out, int indent){
 
 void StrLitNode::unparse(std::ostream& out, int indent){
 	doIndent(out, indent);
-	out << myString;
+	out.write(myString.data,
+		static_cast<std::streamsize>(myString.size));
 }
 
 void TrueNode::unparse(std::ostream& out, int indent){